@@ -162,17 +162,34 @@ int main(int argc, char ** argv)
         const size_t ngen = s1.ngeneral * s2.ngeneral * s3.ngeneral * s4.ngeneral;
         const size_t nintegrals = ncart * ngen;
 
-        std::vector<double> integrals_file(nintegrals);
-        for(size_t i = 0; i < nintegrals; i++)
-            integrals_file[i] = read_hexdouble(fs);
-
-        // print what we read and the first/last integrals
-        std::cout << "\nQuartet " << p << " " << q << " " << r << " " << s << " has " << nintegrals << " integrals\n";
-        std::cout << "    " << integrals_file[0] << "\n";
-        if(nintegrals > 1)
+        // Quartets screened out with --schwarz only store an upper
+        // bound on the magnitude of all their integrals
+        fs >> std::ws;
+        if(fs.peek() == 's')
         {
-            std::cout << "    ....\n";
-            std::cout << "    " << integrals_file[nintegrals-1] << "\n";
+            std::string tmp;
+            fs >> tmp;
+            if(tmp != "screened")
+                throw std::runtime_error("Unknown entry in reference file: " + tmp);
+            const double bound = read_hexdouble(fs);
+
+            std::cout << "\nQuartet " << p << " " << q << " " << r << " " << s << " has " << nintegrals << " integrals\n";
+            std::cout << "    screened, all below " << bound << "\n";
+        }
+        else
+        {
+            std::vector<double> integrals_file(nintegrals);
+            for(size_t i = 0; i < nintegrals; i++)
+                integrals_file[i] = read_hexdouble(fs);
+
+            // print what we read and the first/last integrals
+            std::cout << "\nQuartet " << p << " " << q << " " << r << " " << s << " has " << nintegrals << " integrals\n";
+            std::cout << "    " << integrals_file[0] << "\n";
+            if(nintegrals > 1)
+            {
+                std::cout << "    ....\n";
+                std::cout << "    " << integrals_file[nintegrals-1] << "\n";
+            }
         }
     
         nintegrals_total += nintegrals;
@@ -0,0 +1,96 @@
+/*! \file
+ *
+ * \brief Double-double arithmetic with rigorous error bounds
+ */
+
+#include "mirp/dd.h"
+#include <float.h>
+
+
+/*! \brief Degree of the Taylor polynomial used for exp(r), |r| <= log(2)/2
+ *
+ * The truncation error is then below 2^-120
+ */
+#define MIRP_DD_EXP_DEGREE 26
+
+
+mirp_dd mirp_dd_exp(mirp_dd x)
+{
+    if(!mirp_dd_is_finite(x))
+        return mirp_dd_set(0.0, 0.0, INFINITY);
+
+    /* Overflows (or close enough that we don't care) */
+    if(x.hi + x.rad > 709.0)
+        return mirp_dd_set(0.0, 0.0, INFINITY);
+
+    /* Underflows completely. The result is bounded
+     * by exp of the upper bound of x */
+    if(x.hi + x.rad < -740.0)
+        return mirp_dd_set(0.0, 0.0, mirp_dd_up(exp(x.hi + x.rad + 1.0)));
+
+    /* x = k*log(2) + r */
+    const double k = nearbyint(x.hi / 0x1.62e42fefa39efp-1);
+    const mirp_dd r = mirp_dd_sub(x, mirp_dd_mul_d(mirp_dd_const_log2(), k));
+
+    /* Horner scheme for the Taylor polynomial
+     * p = 1 + r(1 + r/2(1 + r/3(...)))
+     */
+    mirp_dd p = mirp_dd_set_d(1.0);
+    for(int i = MIRP_DD_EXP_DEGREE; i > 0; i--)
+        p = mirp_dd_add(mirp_dd_set_d(1.0), mirp_dd_div_d(mirp_dd_mul(r, p), i));
+
+    /* Truncation error (Lagrange form). The error bound of r is already
+     * accounted for by evaluating the polynomial in ball arithmetic */
+    const double rmax = mirp_dd_abs_ubound(r);
+    double trunc = exp(rmax) * (1.0 + 0x1p-48);
+    for(int i = 1; i <= MIRP_DD_EXP_DEGREE+1; i++)
+        trunc *= rmax / i;
+    p.rad += mirp_dd_up(trunc);
+
+    return mirp_dd_mul_2exp(p, (int)k);
+}
+
+
+int mirp_dd_set_arb(mirp_dd * r, const arb_t x)
+{
+    if(!arb_is_exact(x))
+        return 0;
+
+    const double d = arf_get_d(arb_midref(x), ARF_RND_NEAR);
+
+    /* Is the value representable exactly? */
+    arf_t tmp;
+    arf_init(tmp);
+    arf_set_d(tmp, d);
+    const int exact = isfinite(d) && arf_equal(tmp, arb_midref(x));
+    arf_clear(tmp);
+
+    if(exact)
+        *r = mirp_dd_set_d(d);
+    return exact;
+}
+
+
+void mirp_dd_get_arb(arb_t r, mirp_dd a)
+{
+    if(!mirp_dd_is_finite(a))
+    {
+        arb_indeterminate(r);
+        return;
+    }
+
+    /* hi and lo do not overlap, so the sum is exact in
+     * slightly more than two doubles */
+    arb_t tmp;
+    arb_init(tmp);
+    arb_set_d(r, a.hi);
+    arb_set_d(tmp, a.lo);
+    arb_add(r, r, tmp, 2*DBL_MANT_DIG + 64);
+    arb_clear(tmp);
+
+    mag_t err;
+    mag_init(err);
+    mag_set_d(err, a.rad);
+    arb_add_error_mag(r, err);
+    mag_clear(err);
+}
@@ -0,0 +1,334 @@
+/*! \file
+ *
+ * \brief Double-double arithmetic with rigorous error bounds
+ *
+ * A \ref mirp_dd holds an unevaluated sum of two doubles (about 106 bits)
+ * together with a bound on the absolute error of that sum. Every operation
+ * adds a bound on its own rounding error to the propagated error, so that,
+ * like with arb, the exact result is always contained in the ball
+ * [hi + lo - rad, hi + lo + rad].
+ *
+ * This is much cheaper than arb at precisions around 100 bits, since nothing
+ * is allocated and everything maps to hardware floating point.
+ *
+ * The error-free transformations require IEEE double arithmetic with
+ * round-to-nearest and without excess precision. Do not compile
+ * with value-unsafe optimizations (such as -ffast-math).
+ */
+
+#pragma once
+
+#include <arb.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Bound on the relative rounding error of a single addition
+ *         or multiplication
+ *
+ * The double-double algorithms used here have relative errors of
+ * at most 7*2^-106. This is rounded up to 16*2^-106. Division and square
+ * roots are made of several such operations and use 4*MIRP_DD_EPS.
+ */
+#define MIRP_DD_EPS 1.9721522630525295e-31 /* 2^-102 */
+
+
+/*! \brief Bound on the absolute error due to underflow of a single operation
+ *
+ * When the low part (or an intermediate product) is subnormal, the relative
+ * bound no longer holds. A few units of the smallest subnormal cover this.
+ */
+#define MIRP_DD_TINY 3.1620201333839779e-322 /* 2^-1068 */
+
+
+/*! \brief Number of bits the double-double arithmetic carries
+ *
+ * This is used as the nominal working precision when the results are
+ * converted to arb.
+ */
+#define MIRP_DD_PREC 106
+
+
+/*! \brief Relative amount (2^-50) by which bounds computed in double
+ *         precision are widened
+ *
+ * This covers the rounding of the few operations used to compute a bound.
+ */
+#define MIRP_DD_WIDEN 8.8817841970012523e-16
+
+
+/*! \brief A double-double value with an error bound */
+typedef struct
+{
+    double hi;   //!< Leading part of the value
+    double lo;   //!< Trailing part of the value (|lo| <= ulp(hi)/2)
+    double rad;  //!< Bound on the absolute error of hi + lo
+} mirp_dd;
+
+
+/*! \brief Rounds a bound computed in double precision upwards
+ *
+ * Error bounds are computed with round-to-nearest in a few operations.
+ * Inflating them slightly accounts for the rounding of those operations.
+ */
+static inline double mirp_dd_up(double x)
+{
+    return x * (1.0 + MIRP_DD_WIDEN) + MIRP_DD_TINY;
+}
+
+
+/*! \brief Error-free sum of two doubles (s + e == a + b exactly) */
+static inline void mirp_dd_two_sum(double a, double b, double * s, double * e)
+{
+    *s = a + b;
+    const double bb = *s - a;
+    *e = (a - (*s - bb)) + (b - bb);
+}
+
+
+/*! \brief Error-free sum of two doubles with |a| >= |b| */
+static inline void mirp_dd_quick_two_sum(double a, double b, double * s, double * e)
+{
+    *s = a + b;
+    *e = b - (*s - a);
+}
+
+
+/*! \brief Error-free product of two doubles (p + e == a * b exactly) */
+static inline void mirp_dd_two_prod(double a, double b, double * p, double * e)
+{
+    *p = a * b;
+    *e = fma(a, b, -*p);
+}
+
+
+/*! \brief Creates an exact value from a double */
+static inline mirp_dd mirp_dd_set_d(double a)
+{
+    mirp_dd r = { a, 0.0, 0.0 };
+    return r;
+}
+
+
+/*! \brief Creates an exact value from an integer */
+static inline mirp_dd mirp_dd_set_si(long n)
+{
+    /* The remainder after rounding to double is small, so it is exact */
+    const double hi = (double)n;
+    mirp_dd r = { hi, (double)(n - (long)hi), 0.0 };
+    return r;
+}
+
+
+/*! \brief Creates a value from a double-double and an error bound */
+static inline mirp_dd mirp_dd_set(double hi, double lo, double rad)
+{
+    mirp_dd r = { hi, lo, rad };
+    return r;
+}
+
+
+/*! \brief Returns nonzero if the error bound is finite */
+static inline int mirp_dd_is_finite(mirp_dd a)
+{
+    return isfinite(a.hi) && isfinite(a.lo) && isfinite(a.rad);
+}
+
+
+/*! \brief Upper bound on the absolute value of a */
+static inline double mirp_dd_abs_ubound(mirp_dd a)
+{
+    return mirp_dd_up(fabs(a.hi) + a.rad);
+}
+
+
+/*! \brief Negation (exact) */
+static inline mirp_dd mirp_dd_neg(mirp_dd a)
+{
+    mirp_dd r = { -a.hi, -a.lo, a.rad };
+    return r;
+}
+
+
+/*! \brief Multiplication by 2^e (exact, unless the result underflows) */
+static inline mirp_dd mirp_dd_mul_2exp(mirp_dd a, int e)
+{
+    mirp_dd r = { ldexp(a.hi, e), ldexp(a.lo, e), ldexp(a.rad, e) };
+
+    if(e < 0)
+        r.rad = mirp_dd_up(r.rad);
+    return r;
+}
+
+
+/*! \brief Addition */
+static inline mirp_dd mirp_dd_add(mirp_dd a, mirp_dd b)
+{
+    double s1, s2, t1, t2;
+    mirp_dd_two_sum(a.hi, b.hi, &s1, &s2);
+    mirp_dd_two_sum(a.lo, b.lo, &t1, &t2);
+    s2 += t1;
+    mirp_dd_quick_two_sum(s1, s2, &s1, &s2);
+    s2 += t2;
+
+    mirp_dd r;
+    mirp_dd_quick_two_sum(s1, s2, &r.hi, &r.lo);
+    r.rad = mirp_dd_up(a.rad + b.rad + fabs(r.hi) * MIRP_DD_EPS);
+    return r;
+}
+
+
+/*! \brief Subtraction */
+static inline mirp_dd mirp_dd_sub(mirp_dd a, mirp_dd b)
+{
+    return mirp_dd_add(a, mirp_dd_neg(b));
+}
+
+
+/*! \brief Multiplication */
+static inline mirp_dd mirp_dd_mul(mirp_dd a, mirp_dd b)
+{
+    double p, e;
+    mirp_dd_two_prod(a.hi, b.hi, &p, &e);
+    e += a.hi * b.lo + a.lo * b.hi;
+
+    mirp_dd r;
+    mirp_dd_quick_two_sum(p, e, &r.hi, &r.lo);
+    r.rad = mirp_dd_up(fabs(a.hi) * b.rad + fabs(b.hi) * a.rad + a.rad * b.rad
+                       + fabs(r.hi) * MIRP_DD_EPS);
+    return r;
+}
+
+
+/*! \brief Multiplication by a double that is known exactly */
+static inline mirp_dd mirp_dd_mul_d(mirp_dd a, double b)
+{
+    return mirp_dd_mul(a, mirp_dd_set_d(b));
+}
+
+
+/*! \brief Division
+ *
+ * If the divisor may contain zero, the result has an infinite error bound
+ */
+static inline mirp_dd mirp_dd_div(mirp_dd a, mirp_dd b)
+{
+    /* Lower bound on |b| */
+    const double blow = (fabs(b.hi) * (1.0 - MIRP_DD_WIDEN) - b.rad) * (1.0 - MIRP_DD_WIDEN);
+
+    if(!(blow > 0.0))
+        return mirp_dd_set(0.0, 0.0, INFINITY);
+
+    /* Long division, with three partial quotients */
+    const double q1 = a.hi / b.hi;
+    mirp_dd r = mirp_dd_sub(a, mirp_dd_mul_d(mirp_dd_set(b.hi, b.lo, 0.0), q1));
+    const double q2 = r.hi / b.hi;
+    r = mirp_dd_sub(r, mirp_dd_mul_d(mirp_dd_set(b.hi, b.lo, 0.0), q2));
+    const double q3 = r.hi / b.hi;
+
+    double s, e;
+    mirp_dd_quick_two_sum(q1, q2, &s, &e);
+
+    mirp_dd q = mirp_dd_add(mirp_dd_set(s, e, 0.0), mirp_dd_set_d(q3));
+
+    /* |a/b - a'/b'| <= (|a - a'| + |a'/b'| |b - b'|) / |b| */
+    q.rad = mirp_dd_up((a.rad + fabs(q.hi) * (1.0 + MIRP_DD_WIDEN) * b.rad) / blow
+                       + fabs(q.hi) * 4.0 * MIRP_DD_EPS);
+    return q;
+}
+
+
+/*! \brief Division by a double that is known exactly */
+static inline mirp_dd mirp_dd_div_d(mirp_dd a, double b)
+{
+    return mirp_dd_div(a, mirp_dd_set_d(b));
+}
+
+
+/*! \brief Square root
+ *
+ * If the argument may be negative, the result has an infinite error bound
+ */
+static inline mirp_dd mirp_dd_sqrt(mirp_dd a)
+{
+    if(a.hi == 0.0 && a.lo == 0.0 && a.rad == 0.0)
+        return mirp_dd_set_d(0.0);
+
+    const double alow = a.hi * (1.0 - MIRP_DD_WIDEN) - a.rad;
+    if(!(alow > 0.0))
+        return mirp_dd_set(0.0, 0.0, INFINITY);
+
+    /* One Newton step from the double precision root */
+    const double s = sqrt(a.hi);
+    double p, e;
+    mirp_dd_two_prod(s, s, &p, &e);
+
+    const mirp_dd res = mirp_dd_sub(mirp_dd_set(a.hi, a.lo, 0.0), mirp_dd_set(p, e, 0.0));
+    const double corr = res.hi / (2.0 * s);
+
+    mirp_dd r;
+    mirp_dd_quick_two_sum(s, corr, &r.hi, &r.lo);
+
+    /* |sqrt(x) - sqrt(x')| = |x - x'| / (sqrt(x) + sqrt(x')) <= |x - x'| / sqrt(x') */
+    r.rad = mirp_dd_up(a.rad / (s * (1.0 - MIRP_DD_WIDEN)) + fabs(r.hi) * 4.0 * MIRP_DD_EPS);
+    return r;
+}
+
+
+/*! \brief Square */
+static inline mirp_dd mirp_dd_sqr(mirp_dd a)
+{
+    return mirp_dd_mul(a, a);
+}
+
+
+/*! \brief pi as a double-double, with the error of its representation */
+static inline mirp_dd mirp_dd_const_pi(void)
+{
+    /* 0x1.921fb54442d18p+1 + 0x1.1a62633145c07p-53, error below 2^-104 */
+    return mirp_dd_set(3.1415926535897931, 1.2246467991473532e-16, 4.9303806576313238e-32);
+}
+
+
+/*! \brief log(2) as a double-double, with the error of its representation */
+static inline mirp_dd mirp_dd_const_log2(void)
+{
+    /* 0x1.62e42fefa39efp-1 + 0x1.abc9e3b39803fp-56, error below 2^-108 */
+    return mirp_dd_set(0.69314718055994529, 2.3190468138462996e-17, 3.0814879110195774e-33);
+}
+
+
+/*! \brief Exponential function
+ *
+ * Computed as exp(x) = 2^k * exp(r) with r = x - k*log(2), and a
+ * Taylor series for exp(r), whose truncation error is added to the
+ * error bound.
+ */
+mirp_dd mirp_dd_exp(mirp_dd x);
+
+
+/*! \brief Converts an arb_t to a double-double
+ *
+ * This only succeeds if \p x is exact and its value is representable
+ * as a double (as is the case for all inputs of the exact functions).
+ *
+ * \param [out] r The converted value
+ * \param [in]  x The value to convert
+ * \return Nonzero if the conversion succeeded
+ */
+int mirp_dd_set_arb(mirp_dd * r, const arb_t x);
+
+
+/*! \brief Converts a double-double to an arb_t
+ *
+ * The error bound of \p a becomes (part of) the radius of \p r.
+ * A value with an infinite error bound becomes indeterminate.
+ */
+void mirp_dd_get_arb(arb_t r, mirp_dd a);
+
+
+#ifdef __cplusplus
+}
+#endif
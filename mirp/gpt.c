@@ -70,3 +70,52 @@ void mirp_gpt(const arb_t alpha1, const arb_t alpha2,
     arb_clear(tmp2);
     arb_clear(tmp3);
 }
+
+
+void mirp_gpt_double(double alpha1, double alpha2,
+                     const double * A, const double * B,
+                     double * gamma, double * P,
+                     double * PA, double * PB,
+                     double * AB2)
+{
+    *gamma = alpha1 + alpha2;
+
+    P[0] = (alpha1*A[0] + alpha2*B[0]) / (*gamma);
+    P[1] = (alpha1*A[1] + alpha2*B[1]) / (*gamma);
+    P[2] = (alpha1*A[2] + alpha2*B[2]) / (*gamma);
+
+    PA[0] = P[0] - A[0];
+    PA[1] = P[1] - A[1];
+    PA[2] = P[2] - A[2];
+
+    PB[0] = P[0] - B[0];
+    PB[1] = P[1] - B[1];
+    PB[2] = P[2] - B[2];
+
+    *AB2 = (A[0]-B[0])*(A[0]-B[0])
+         + (A[1]-B[1])*(A[1]-B[1])
+         + (A[2]-B[2])*(A[2]-B[2]);
+}
+
+
+void mirp_gpt_dd(mirp_dd alpha1, mirp_dd alpha2,
+                 const mirp_dd * A, const mirp_dd * B,
+                 mirp_dd * gamma, mirp_dd * P,
+                 mirp_dd * PA, mirp_dd * PB,
+                 mirp_dd * AB2)
+{
+    *gamma = mirp_dd_add(alpha1, alpha2);
+    *AB2 = mirp_dd_set_d(0.0);
+
+    for(int x = 0; x < 3; x++)
+    {
+        P[x] = mirp_dd_div(mirp_dd_add(mirp_dd_mul(alpha1, A[x]), mirp_dd_mul(alpha2, B[x])),
+                           *gamma);
+
+        PA[x] = mirp_dd_sub(P[x], A[x]);
+        PB[x] = mirp_dd_sub(P[x], B[x]);
+
+        const mirp_dd AB = mirp_dd_sub(A[x], B[x]);
+        *AB2 = mirp_dd_add(*AB2, mirp_dd_sqr(AB));
+    }
+}
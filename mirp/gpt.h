@@ -6,6 +6,7 @@
 #pragma once
 
 #include <arb.h>
+#include "mirp/dd.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +46,35 @@ void mirp_gpt(const arb_t alpha1, const arb_t alpha2,
               slong working_prec);
 
 
+/*! \brief Computes terms from the Gaussian Product Theorem using
+ *         double precision
+ *
+ * This is not certified in any way. It is used to obtain
+ * a candidate result that is later checked with interval arithmetic.
+ *
+ * \copydetails mirp_gpt
+ */
+void mirp_gpt_double(double alpha1, double alpha2,
+                     const double * A, const double * B,
+                     double * gamma, double * P,
+                     double * PA, double * PB,
+                     double * AB2);
+
+
+/*! \brief Computes terms from the Gaussian Product Theorem using
+ *         double-double arithmetic
+ *
+ * The outputs contain rigorous error bounds (see \ref mirp_dd)
+ *
+ * \copydetails mirp_gpt
+ */
+void mirp_gpt_dd(mirp_dd alpha1, mirp_dd alpha2,
+                 const mirp_dd * A, const mirp_dd * B,
+                 mirp_dd * gamma, mirp_dd * P,
+                 mirp_dd * PA, mirp_dd * PB,
+                 mirp_dd * AB2);
+
+
 #ifdef __cplusplus
 }
 #endif
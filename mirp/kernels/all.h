@@ -6,5 +6,15 @@
 #pragma once
 
 #include "mirp/kernels/boys.h"
+#include "mirp/kernels/boys_double.h"
+#include "mirp/kernels/boys_double_vec.h"
+#include "mirp/kernels/boys_dd.h"
+#include "mirp/kernels/boys_grid.h"
+#include "mirp/kernels/rys.h"
 #include "mirp/kernels/gtoeri.h"
+#include "mirp/kernels/gtoeri_dd.h"
+#include "mirp/kernels/gtoeri_bound.h"
+#include "mirp/kernels/gtoeri_hgp.h"
+#include "mirp/kernels/gtoeri_rys.h"
+#include "mirp/kernels/gtoeri_md.h"
 
@@ -5,28 +5,121 @@
 
 #include "mirp/pragma.h"
 #include "mirp/math.h"
+#include "mirp/precision.h"
 #include "mirp/kernels/boys.h"
+#include "mirp/kernels/boys_dd.h"
+#include <arb_hypgeom.h>
 #include <assert.h>
+#include <math.h>
+#include <stdlib.h>
 
-void mirp_boys(arb_ptr F, int m, const arb_t t, slong working_prec)
+/*! \brief Computes the part of the long-range approximation of F_m(t)
+ *         that does not depend on t
+ *
+ * This is sqrt(pi)/2 * (2m-1)!! / 2^m = Gamma(m+1/2)/2, so that the long-range
+ * approximation is this value divided by t^(m+1/2).
+ */
+static void mirp_boys_long_prefac(arb_t prefac, int m, slong working_prec)
 {
-    assert(m >= 0);
-    assert(!(arb_is_negative(t)));
-    assert(working_prec > 0);
+    arb_const_sqrt_pi(prefac, working_prec);
+    arb_mul_2exp_si(prefac, prefac, -1);
+
+    for(int i = 1; i <= m; i++)
+    {
+        arb_mul_si(prefac, prefac, 2*i-1, working_prec);
+        arb_mul_2exp_si(prefac, prefac, -1);
+    }
+}
+
+
+/*! \brief Start of upward recursion for the Boys function, relative to m + 3/2
+ *
+ * Upward recursion needs neither a series nor an error estimate. It should
+ * be used from the smallest start at which it loses at most 4 bits more than
+ * the series. 0.875 is an estimate of that point, which has not been
+ * measured with arb. It can be measured with mirp_boys_bench, which prints
+ * the smallest start that is accurate enough for each working precision.
+ */
+#define MIRP_BOYS_UPWARD_START 0.875
+
+
+/*! \brief Extra bits required by \ref mirp_boys_asymptotic_ok
+ *
+ * This covers choosing the engine from the midpoint of t
+ */
+#define MIRP_BOYS_ASYMPTOTIC_MARGIN 4
+
+
+/*! \brief Determines if the asymptotic form is accurate enough
+ *
+ * This is the case if the remainder of the asymptotic form
+ * (see \ref mirp_boys_core) is below 2^-working_prec of its value,
+ * with a margin of \ref MIRP_BOYS_ASYMPTOTIC_MARGIN bits. The remainder
+ * decreases as exp(-t), so for large t the asymptotic form needs neither
+ * a series nor the error function, and is cheaper than upward recursion.
+ *
+ * The logarithms are compared in double precision, which is
+ * fine since the engine only affects speed.
+ */
+static int mirp_boys_asymptotic_ok(int m, double t, slong working_prec)
+{
+    const double d = 2.0*t - MAX(2*m-1, 0);
+    if(!(d > 0.0))
+        return 0;
+
+    /* log of lr_prefac / t^(m+1/2), where lr_prefac = Gamma(m+1/2)/2
+     * and 0.57236... is log(sqrt(pi)) */
+    double log_val = 0.5723649429247001 - log(2.0) - (m+0.5)*log(t);
+    for(int i = 1; i <= m; i++)
+        log_val += log(i-0.5);
+
+    /* log of half the bound on the remainder */
+    const double log_rem = -t - log(d) - log(2.0);
 
+    return log_val - log_rem >= (working_prec + MIRP_BOYS_ASYMPTOTIC_MARGIN) * log(2.0);
+}
+
+
+mirp_boys_engine mirp_boys_engine_select(int m, const arb_t t, slong working_prec)
+{
+    /* The midpoint is good enough for choosing, since every
+     * engine gives correct results for any t */
+    const double t_d = arf_get_d(arb_midref(t), ARF_RND_NEAR);
+    const double t0 = m + 1.5;
+
+    /* The incomplete gamma function is never chosen here, since it
+     * is not known where it is faster than the series */
+    if(mirp_boys_asymptotic_ok(m, t_d, working_prec))
+        return MIRP_BOYS_ENGINE_ASYMPTOTIC;
+    if(t_d >= MIRP_BOYS_UPWARD_START * t0)
+        return MIRP_BOYS_ENGINE_UPWARD;
+    return MIRP_BOYS_ENGINE_SERIES;
+}
+
+
+/*! \brief Computes the Boys function, given the terms that
+ *         do not depend on t
+ *
+ * \param [in] lr_prefac The result of \ref mirp_boys_long_prefac for \p m
+ *                       (only used by the asymptotic and incomplete gamma engines)
+ * \param [in] engine    The engine to use for F_m (not \ref MIRP_BOYS_ENGINE_AUTO)
+ *
+ * See \ref mirp_boys_ws for the remaining parameters
+ */
+static void mirp_boys_core(arb_ptr F, int m, const arb_t t,
+                           const arb_t lr_prefac, mirp_boys_engine engine,
+                           mirp_workspace * ws, slong working_prec)
+{
     int i;
+    int do_short = (engine == MIRP_BOYS_ENGINE_SERIES);
 
-    arb_t t2, et, sum, term, lastterm, test;
-    arb_t tmp1, tmp2, tmp3;
-    arb_init(t2);
-    arb_init(et);
-    arb_init(sum);
-    arb_init(term);
-    arb_init(lastterm);
-    arb_init(test);
-    arb_init(tmp1);
-    arb_init(tmp2);
-    arb_init(tmp3);
+    arb_ptr tmp = mirp_workspace_vec_init(ws, 6);
+    arb_ptr t2 = tmp + 0;
+    arb_ptr et = tmp + 1;
+    arb_ptr sum = tmp + 2;
+    arb_ptr term = tmp + 3;
+    arb_ptr test = tmp + 4;
+    arb_ptr tmp1 = tmp + 5;
 
     /* t2 = 2*t */
     arb_mul_ui(t2, t, 2, working_prec);
@@ -37,78 +130,80 @@ void mirp_boys(arb_ptr F, int m, const arb_t t, slong working_prec)
     arb_neg(et, t);
     arb_exp(et, et, working_prec);
 
-    int do_short = 0;
-
-    /* The short-range formula converges much better for
-     * t < (m + 3/2)
-     * So skip the long range if that happens
-     * Note that this is a conservative bound, and could probably be increased
-     */
-    arb_set_si(test, 2*m+3);
-    arb_div_si(test, test, 2, working_prec);
-
-    if(arb_lt(t, test))
-        do_short = 1;
+    if(engine == MIRP_BOYS_ENGINE_UPWARD && !arb_is_positive(t))
+        engine = MIRP_BOYS_ENGINE_SERIES;
 
-    if(!do_short)
+    if(engine == MIRP_BOYS_ENGINE_UPWARD)
     {
-        /* Attempt the long-range approximation */
-        arb_const_pi(tmp1, working_prec);
-        arb_div(tmp1, tmp1, t, working_prec);
-        arb_sqrt(tmp1, tmp1, working_prec);
-        arb_div_si(tmp1, tmp1, 2, working_prec);
-
-        for(i = 1; i <= m; i++)
+        /* F_0 = sqrt(pi/t)/2 * erf(sqrt(t))
+         * Nothing is truncated, so no remainder has to be added */
+        arb_sqrt(tmp1, t, working_prec);
+        arb_hypgeom_erf(sum, tmp1, working_prec);
+        arb_const_sqrt_pi(term, working_prec);
+        arb_mul(sum, sum, term, working_prec);
+        arb_div(F, sum, tmp1, working_prec);
+        arb_mul_2exp_si(F, F, -1);
+
+        /* Upward recursion
+         * F_{i+1} = ((2i+1) F_i - exp(-t)) / (2t)
+         * This is stable if t is large compared to m */
+        for(i = 0; i < m; i++)
         {
-            arb_set_si(tmp2, 2*i-1);
-            arb_div(tmp2, tmp2, t2, working_prec);
-            arb_mul(tmp1, tmp1, tmp2, working_prec);
+            arb_mul_si(F + (i+1), F + i, 2*i+1, working_prec);
+            arb_sub(F + (i+1), F + (i+1), et, working_prec);
+            arb_div(F + (i+1), F + (i+1), t2, working_prec);
         }
 
-        arb_set(F + m, tmp1);
-
-        /* Determine the error associated with the long-range approximation */
-        arb_zero(sum);
-        arb_set_ui(term, 1);
-
-        i = 0;
-        do {
-            i++;
-            arb_abs(lastterm, term);
-            arb_mul_si(term, term, 2*m - 2*i + 1, working_prec);
-            arb_div(term, term, t2, working_prec);
-            arb_abs(test, term);
-
-            if(arf_cmpabs(arb_midref(test), arb_midref(lastterm)) > 0)
-            {
-                /* Has not converged. Force short-range */
-                do_short = 1;
-                break;
-            }
-
-            arb_set(test, sum);
-            arb_add(sum, sum, term, working_prec);
-        } while(!arb_contains(sum, test)); /* Is the old term contained
-                                              completely within the new term */
+        mirp_workspace_vec_clear(ws, tmp, 6);
+        return;
+    }
+    else if(engine == MIRP_BOYS_ENGINE_GAMMA)
+    {
+        /* F_m = gamma(m+1/2, t) / (2 t^(m+1/2))
+         *     = Gamma(m+1/2)/2 * gamma*(m+1/2, t)
+         * where gamma* is the regularized lower incomplete gamma function
+         * gamma(s, t) / (Gamma(s) t^s). Gamma(m+1/2)/2 is lr_prefac
+         */
+        arb_set_si(tmp1, 2*m+1);
+        arb_mul_2exp_si(tmp1, tmp1, -1);
+        arb_hypgeom_gamma_lower(sum, tmp1, t, 2, working_prec);
+        arb_mul(F+m, sum, lr_prefac, working_prec);
+    }
+    else if(!do_short)
+    {
+        /* Attempt the long-range approximation
+         * F_m = lr_prefac / t^(m+1/2) - Gamma(m+1/2, t) / (2 t^(m+1/2))
+         *
+         * The second term is bounded by exp(-t) / (2t - max(2m-1, 0))
+         * for 2t > max(2m-1, 0). The exact value lies between the first
+         * term minus this bound and the first term.
+         */
+        arb_sub_si(test, t2, MAX(2*m-1, 0), working_prec);
+
+        if(!arb_is_positive(test))
+            do_short = 1;
+        else
+        {
+            arb_rsqrt(tmp1, t, working_prec);
+            arb_mul(tmp1, tmp1, lr_prefac, working_prec);
 
-        /* Note about the above test: If the old term is contained within
-           the new term, all we have done is added error. Ie, we've
-           added such a small number that the midpoint hasn't changed (much),
-           but the error has increased */
+            /* Dividing one at a time avoids the (possibly huge) power of t */
+            for(i = 1; i <= m; i++)
+                arb_div(tmp1, tmp1, t, working_prec);
 
-        //printf("Done with long-range test in %d cycles\n", i);
+            /* sum = half of the bound on the second term */
+            arb_div(sum, et, test, working_prec);
+            arb_mul_2exp_si(sum, sum, -1);
 
-        if(!do_short)
-        {
-            arb_mul(sum, sum, et, working_prec);
-            arb_div(sum, sum, t2, working_prec);
+            arb_sub(F + m, tmp1, sum, working_prec);
+            arb_add_error(F + m, sum);
 
             /*
              * Determine if this error is satisfactory
              * If not, mark that we have to do the short-range version
              */
-            arb_sub(test, F+m, sum, working_prec);
-            if(!arb_contains(test, F+m))
+            arb_mul_2exp_si(test, tmp1, -working_prec);
+            if(!arb_lt(sum, test))
                 do_short = 1;
         }
     }
@@ -145,15 +240,117 @@ void mirp_boys(arb_ptr F, int m, const arb_t t, slong working_prec)
         arb_div_si(F+i, F+i, 2 * i + 1, working_prec);
     }
 
-    arb_clear(t2);
-    arb_clear(et);
-    arb_clear(sum);
-    arb_clear(term);
-    arb_clear(lastterm);
-    arb_clear(test);
-    arb_clear(tmp1);
-    arb_clear(tmp2);
-    arb_clear(tmp3);
+    mirp_workspace_vec_clear(ws, tmp, 6);
+}
+
+
+void mirp_boys_ws(arb_ptr F, int m, const arb_t t,
+                  mirp_workspace * ws, slong working_prec)
+{
+    mirp_boys_engine_ws(F, m, t, MIRP_BOYS_ENGINE_AUTO, ws, working_prec);
+}
+
+
+void mirp_boys_engine_ws(arb_ptr F, int m, const arb_t t, mirp_boys_engine engine,
+                         mirp_workspace * ws, slong working_prec)
+{
+    assert(m >= 0);
+    assert(!(arb_is_negative(t)));
+    assert(working_prec > 0);
+
+    if(engine == MIRP_BOYS_ENGINE_AUTO)
+        engine = mirp_boys_engine_select(m, t, working_prec);
+
+    arb_ptr lr_prefac = mirp_workspace_vec_init(ws, 1);
+    if(engine != MIRP_BOYS_ENGINE_SERIES)
+        mirp_boys_long_prefac(lr_prefac, m, working_prec);
+
+    mirp_boys_core(F, m, t, lr_prefac, engine, ws, working_prec);
+
+    mirp_workspace_vec_clear(ws, lr_prefac, 1);
+}
+
+
+void mirp_boys_batch(arb_ptr F, int m, arb_srcptr t, long n,
+                     int nthreads, slong working_prec)
+{
+    assert(m >= 0);
+    assert(n >= 0);
+    assert(nthreads > 0);
+    assert(working_prec > 0);
+
+    if(n == 0)
+        return;
+
+    /* Order the inputs by engine, so that all the ones using the
+     * short-range series come first, followed by the ones using the
+     * incomplete gamma function, upward recursion, and then the ones
+     * trying the long-range approximation */
+    long * order = malloc((size_t)n * sizeof(long));
+    mirp_boys_engine * engine = malloc((size_t)n * sizeof(mirp_boys_engine));
+    long norder = 0;
+    int need_prefac = 0;
+
+    for(long i = 0; i < n; i++)
+    {
+        assert(!(arb_is_negative(t + i)));
+        engine[i] = mirp_boys_engine_select(m, t + i, working_prec);
+        if(engine[i] != MIRP_BOYS_ENGINE_SERIES)
+            need_prefac = 1;
+    }
+
+    const mirp_boys_engine engine_order[4] = { MIRP_BOYS_ENGINE_SERIES,
+                                               MIRP_BOYS_ENGINE_GAMMA,
+                                               MIRP_BOYS_ENGINE_UPWARD,
+                                               MIRP_BOYS_ENGINE_ASYMPTOTIC };
+    for(int e = 0; e < 4; e++)
+    {
+        for(long i = 0; i < n; i++)
+        {
+            if(engine[i] == engine_order[e])
+                order[norder++] = i;
+        }
+    }
+
+    /* The long-range prefactor is the same for all t */
+    arb_t lr_prefac;
+    arb_init(lr_prefac);
+    if(need_prefac)
+        mirp_boys_long_prefac(lr_prefac, m, working_prec);
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads)
+    #endif
+    {
+        /* One workspace for each thread, reused for all the inputs
+         * and kept between calls */
+        mirp_workspace * ws = mirp_workspace_local_get(1, MIRP_BOYS_WORKSPACE_SIZE);
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 16)
+        #endif
+        for(long k = 0; k < n; k++)
+        {
+            const long i = order[k];
+            mirp_boys_core(F + i*(m+1), m, t + i, lr_prefac, engine[i],
+                           ws, working_prec);
+        }
+
+        mirp_workspace_local_release(ws);
+    }
+
+    arb_clear(lr_prefac);
+    free(engine);
+    free(order);
+}
+
+
+void mirp_boys(arb_ptr F, int m, const arb_t t, slong working_prec)
+{
+    /* The workspace of this thread is kept between calls */
+    mirp_workspace * ws = mirp_workspace_local_get(1, MIRP_BOYS_WORKSPACE_SIZE);
+    mirp_boys_ws(F, m, t, ws, working_prec);
+    mirp_workspace_local_release(ws);
 }
 
 
@@ -169,8 +366,95 @@ void mirp_boys_str(arb_ptr F, int m, const char * t, slong working_prec)
 }
 
 
+slong mirp_boys_target(arb_ptr F, int m, const char * t, long ndigits)
+{
+    const slong target_prec = mirp_prec_from_digits(ndigits);
+
+    /* There are no exponents, and no angular momentum to cause cancellation */
+    slong working_prec = mirp_prec_initial(0, 0.0, 0.0, 0.0, target_prec);
+
+    while(1)
+    {
+        mirp_boys_str(F, m, t, working_prec);
+
+        slong min_bits = target_prec;
+        int suff_acc = 1;
+        for(int i = 0; i <= m; i++)
+        {
+            if(!mirp_prec_target_reached(F + i, target_prec, &min_bits))
+                suff_acc = 0;
+        }
+
+        if(suff_acc || working_prec > MIRP_PREC_TARGET_MAX)
+            break;
+
+        working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
+    }
+
+    return working_prec;
+}
+
+
+/*! \brief Determine if the values of the Boys function have sufficient
+ *         accuracy for conversion to double precision
+ *
+ * We need at least \p target_prec bits OR the value is zero (has zero precision)
+ * and the error bounds is exactly zero when converted to double precision
+ *
+ * \param [inout] min_bits If a value is not sufficiently accurate, this is
+ *                         lowered to its relative accuracy (see \ref mirp_prec_next)
+ * \return Nonzero if all (\p m + 1) values are sufficiently accurate
+ */
+static int mirp_boys_accurate(arb_srcptr F, int m,
+                              slong target_prec, slong working_prec,
+                              slong * min_bits)
+{
+    int suff_acc = 1;
+
+    /* for comparisons */
+    arf_t ubound, lbound;
+    arf_init(ubound);
+    arf_init(lbound);
+
+    for(int i = 0; i <= m; i++)
+    {
+        slong bits = arb_rel_accuracy_bits(F + i);
+
+        if(bits > 0 && bits < target_prec)
+        {
+            suff_acc = 0;
+            *min_bits = MIN(*min_bits, bits);
+        }
+        else if(bits <= 0)
+        {
+            arb_get_ubound_arf(ubound, F + i, working_prec);
+            arb_get_lbound_arf(lbound, F + i, working_prec);
+
+            PRAGMA_WARNING_PUSH
+            PRAGMA_WARNING_IGNORE_FP_UNDERFLOW
+
+            if(arf_cmpabs_d(lbound, MIRP_DBL_TRUE_MIN) > 0 || 
+               arf_cmpabs_d(ubound, MIRP_DBL_TRUE_MIN) > 0)
+            {
+                suff_acc = 0; 
+                *min_bits = 0;
+            }
+
+            PRAGMA_WARNING_POP
+        }
+    }
+
+    arf_clear(lbound);
+    arf_clear(ubound);
+
+    return suff_acc;
+}
+
+
 void mirp_boys_exact(double *F, int m, double t)
 {
+    const double stats_start = mirp_exact_stats_start();
+
     /* The target precision is the number of bits in
      * double precision (53) + safety */
     const slong target_prec = 64;
@@ -186,55 +470,176 @@ void mirp_boys_exact(double *F, int m, double t)
 
     arb_ptr F_mp = _arb_vec_init(m+1);
 
-    slong working_prec = target_prec;
-    int suff_acc = 0;
+    /* The first attempt uses double-double arithmetic, which is
+     * much cheaper than arb and usually accurate enough. It is made at
+     * a fixed precision, and so is counted separately from the
+     * predictions (see mirp_prec_record_fixed) */
+    mirp_dd F_dd[m+1];
+    mirp_boys_dd(F_dd, m, mirp_dd_set_d(t));
 
-    /* for comparisons */
-    arf_t ubound, lbound;
-    arf_init(ubound);
-    arf_init(lbound);
+    for(int i = 0; i <= m; i++)
+        mirp_dd_get_arb(F_mp + i, F_dd[i]);
+
+    slong working_prec = MIRP_DD_PREC;
+    slong min_bits = target_prec;
+    int nrounds = 1;
+
+    /* Do we have sufficient accuracy? We need at least
+     * 53 bits + 11 bits safety */
+    int suff_acc = mirp_boys_accurate(F_mp, m, target_prec, working_prec, &min_bits);
+    mirp_prec_record_fixed(suff_acc);
+
+    /* There are no exponents, and no angular momentum to cause cancellation */
+    const slong initial_prec = mirp_prec_initial(0, 0.0, 0.0, 0.0, target_prec);
 
     while(!suff_acc)
     {
-        working_prec += target_prec;
-        suff_acc = 1;
+        const int initial = (working_prec < initial_prec);
+
+        if(initial)
+            working_prec = initial_prec;
+        else
+            working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
 
         mirp_boys(F_mp, m, t_mp, working_prec);
+        nrounds++;
 
-        suff_acc = 1;
-        for(int i = 0; i <= m; i++)
+        min_bits = target_prec;
+        suff_acc = mirp_boys_accurate(F_mp, m, target_prec, working_prec, &min_bits);
+        mirp_prec_record(initial, suff_acc);
+    }
+
+    /* convert back to double precision */
+    for(int i = 0; i <= m; i++)
+        F[i] = arf_get_d(arb_midref(F_mp + i), ARF_RND_NEAR);
+
+    const int am[4] = { m, 0, 0, 0 };
+    mirp_exact_stats_record(MIRP_EXACT_BOYS, am, working_prec, nrounds,
+                            (long)nrounds*(m+1), m+1, stats_start);
+
+    arb_clear(t_mp);
+    _arb_vec_clear(F_mp, m+1);
+}
+
+
+void mirp_boys_exact_batch(double * F, int m, const double * t, long n, int nthreads)
+{
+    assert(m >= 0);
+    assert(n >= 0);
+    assert(nthreads > 0);
+
+    if(n == 0)
+        return;
+
+    const double stats_start = mirp_exact_stats_start();
+
+    /* The target precision is the number of bits in
+     * double precision (53) + safety */
+    const slong target_prec = 64;
+    const long stride = m+1;
+
+    arb_ptr F_mp = _arb_vec_init(n*stride);
+
+    /* Inputs that are not yet accurate enough (and their
+     * values of t and results for the next attempt) */
+    long * todo = malloc((size_t)n * sizeof(long));
+    int * nrounds = malloc((size_t)n * sizeof(int));
+    slong * final_prec = malloc((size_t)n * sizeof(slong));
+    arb_ptr t_todo = _arb_vec_init(n);
+    arb_ptr F_todo = _arb_vec_init(n*stride);
+
+    /* The first attempt uses double-double arithmetic for all inputs */
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(nthreads)
+    #endif
+    for(long i = 0; i < n; i++)
+    {
+        mirp_dd F_dd[m+1];
+        mirp_boys_dd(F_dd, m, mirp_dd_set_d(t[i]));
+
+        for(int j = 0; j <= m; j++)
+            mirp_dd_get_arb(F_mp + i*stride + j, F_dd[j]);
+    }
+
+    long ntodo = n;
+    for(long i = 0; i < n; i++)
+    {
+        todo[i] = i;
+        nrounds[i] = 0;
+    }
+
+    /* The double-double attempt is made at a fixed precision, and so is
+     * counted separately from the predictions (see mirp_prec_record_fixed).
+     * There are no exponents, and no angular momentum to cause cancellation */
+    const slong initial_prec = mirp_prec_initial(0, 0.0, 0.0, 0.0, target_prec);
+    slong working_prec = MIRP_DD_PREC;
+    slong min_bits = 0;
+    int fixed = 1;
+    int initial = 0;
+
+    while(ntodo > 0)
+    {
+        if(!fixed)
         {
-            /* Do we have sufficient accuracy? We need at least
-             * 53 bits + 11 bits safety OR the value is zero (has zero precision)
-             * and the error bounds is exactly zero when converted to double precision */
-            slong bits = arb_rel_accuracy_bits(F_mp + i);
+            /* Compute all remaining inputs together */
+            initial = (working_prec < initial_prec);
 
-            if(bits > 0 && bits < target_prec)
-                suff_acc = 0;
-            else if(bits <= 0)
-            {
-                arb_get_ubound_arf(ubound, F_mp + i, working_prec);
-                arb_get_lbound_arf(lbound, F_mp + i, working_prec);
+            if(initial)
+                working_prec = initial_prec;
+            else
+                working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
 
-                PRAGMA_WARNING_PUSH
-                PRAGMA_WARNING_IGNORE_FP_UNDERFLOW
+            for(long k = 0; k < ntodo; k++)
+                arb_set_d(t_todo + k, t[todo[k]]);
 
-                if(arf_cmpabs_d(lbound, MIRP_DBL_TRUE_MIN) > 0 || 
-                   arf_cmpabs_d(ubound, MIRP_DBL_TRUE_MIN) > 0)
-                        suff_acc = 0; 
+            mirp_boys_batch(F_todo, m, t_todo, ntodo, nthreads, working_prec);
 
-                PRAGMA_WARNING_POP
-            }
+            for(long k = 0; k < ntodo; k++)
+                _arb_vec_set(F_mp + todo[k]*stride, F_todo + k*stride, stride);
+        }
+
+        /* Keep only the inputs that are not accurate enough */
+        long nleft = 0;
+        min_bits = target_prec;
+
+        for(long k = 0; k < ntodo; k++)
+        {
+            const long i = todo[k];
+            const int suff_acc = mirp_boys_accurate(F_mp + i*stride, m, target_prec,
+                                                    working_prec, &min_bits);
+            nrounds[i]++;
+
+            if(fixed)
+                mirp_prec_record_fixed(suff_acc);
+            else
+                mirp_prec_record(initial, suff_acc);
+
+            if(suff_acc)
+                final_prec[i] = working_prec;
+            else
+                todo[nleft++] = i;
         }
+
+        ntodo = nleft;
+        fixed = 0;
     }
 
     /* convert back to double precision */
-    for(int i = 0; i <= m; i++)
+    for(long i = 0; i < n*stride; i++)
         F[i] = arf_get_d(arb_midref(F_mp + i), ARF_RND_NEAR);
 
-    arf_clear(lbound);
-    arf_clear(ubound);
-    arb_clear(t_mp);
-    _arb_vec_clear(F_mp, m+1);
+    /* Each input is recorded as a call. The time of the whole
+     * batch is attributed to the last one */
+    const int am[4] = { m, 0, 0, 0 };
+    for(long i = 0; i < n; i++)
+        mirp_exact_stats_record(MIRP_EXACT_BOYS, am, final_prec[i], nrounds[i],
+                                (long)nrounds[i]*stride, stride,
+                                (i == n-1) ? stats_start : 0.0);
+
+    _arb_vec_clear(F_todo, n*stride);
+    _arb_vec_clear(t_todo, n);
+    free(final_prec);
+    free(nrounds);
+    free(todo);
+    _arb_vec_clear(F_mp, n*stride);
 }
-
@@ -6,11 +6,38 @@
 #pragma once
 
 #include <arb.h>
+#include "mirp/workspace.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*! \brief Number of temporaries needed by the Boys function
+ *
+ * A workspace of this size is sufficient for \ref mirp_boys_ws
+ * and \ref mirp_boys_engine_ws
+ */
+#define MIRP_BOYS_WORKSPACE_SIZE 7
+
+
+/*! \brief Methods of computing the highest order of the Boys function
+ *
+ * Except for \ref MIRP_BOYS_ENGINE_UPWARD, the lower orders are
+ * obtained by downward recursion.
+ */
+typedef enum
+{
+    MIRP_BOYS_ENGINE_AUTO = 0,    //!< Chosen by \ref mirp_boys_engine_select
+    MIRP_BOYS_ENGINE_SERIES,      //!< Short-range series
+    MIRP_BOYS_ENGINE_ASYMPTOTIC,  //!< Long-range approximation (falls back to the series
+                                  //!< if its error is not small enough)
+    MIRP_BOYS_ENGINE_GAMMA,       //!< Lower incomplete gamma function (from arb)
+    MIRP_BOYS_ENGINE_UPWARD       //!< F_0 from the error function, then upward recursion
+                                  //!< instead of downward (for t > 0 only, otherwise
+                                  //!< the series is used)
+} mirp_boys_engine;
+
+
 /*! \brief Computes the Boys function using interval arithmetic
  *
  * See \ref boys_function
@@ -27,6 +54,73 @@ extern "C" {
 void mirp_boys(arb_ptr F, int m, const arb_t t, slong working_prec);
 
 
+/*! \brief Computes the Boys function using interval arithmetic, with
+ *         temporaries taken from a workspace
+ *
+ * \copydetails mirp_boys
+ * \param [in] ws Workspace to take temporaries from (see \ref mirp_workspace)
+ */
+void mirp_boys_ws(arb_ptr F, int m, const arb_t t,
+                  mirp_workspace * ws, slong working_prec);
+
+
+/*! \brief Computes the Boys function using interval arithmetic, with
+ *         a given engine and temporaries taken from a workspace
+ *
+ * All engines give correct results (containing the exact values)
+ * for any \p m and \p t. They only differ in speed.
+ *
+ * \copydetails mirp_boys_ws
+ * \param [in] engine The method of computing F_m
+ */
+void mirp_boys_engine_ws(arb_ptr F, int m, const arb_t t, mirp_boys_engine engine,
+                         mirp_workspace * ws, slong working_prec);
+
+
+/*! \brief Chooses the engine for the Boys function
+ *
+ * The asymptotic form is chosen wherever its remainder is below the working
+ * precision. Otherwise, upward recursion is chosen for \p t from a fixed
+ * fraction of m + 3/2, and the series below that.
+ *
+ * The incomplete gamma function is never chosen. It only helps if arb
+ * evaluates it faster than the series, which has not been measured (this
+ * can be done with mirp_boys_bench). It can be requested with
+ * \ref mirp_boys_engine_ws.
+ *
+ * \param [in] m            The maximum order to calculate
+ * \param [in] t            The value at which to evaluate
+ * \param [in] working_prec The working precision (binary digits/bits)
+ * \return The engine to use (never \ref MIRP_BOYS_ENGINE_AUTO)
+ */
+mirp_boys_engine mirp_boys_engine_select(int m, const arb_t t, slong working_prec);
+
+
+/*! \brief Computes the Boys function using interval arithmetic
+ *         for many values of t
+ *
+ * The results for input \p i are stored starting at \p F + \p i * (\p m + 1).
+ *
+ * This is the same as calling \ref mirp_boys for each input, however the part
+ * of the long-range approximation that does not depend on t is computed only
+ * once, and all temporaries are shared. The inputs are processed grouped by
+ * engine (see \ref mirp_boys_engine_select).
+ * If OpenMP is enabled, the inputs are split among \p nthreads threads.
+ *
+ * \param [out] F  The computed values of the Boys function
+ *                 (of length \p n * (\p m + 1))
+ * \param [in]  m  The maximum order to calculate
+ * \param [in]  t  The values at which to evaluate (of length \p n)
+ * \param [in]  n  The number of values of t
+ * \param [in]  nthreads Number of threads to use (1 computes all
+ *                       inputs in the calling thread)
+ * \param [in] working_prec The working precision (binary digits/bits)
+ *                          to use in the calculation
+ */
+void mirp_boys_batch(arb_ptr F, int m, arb_srcptr t, long n,
+                     int nthreads, slong working_prec);
+
+
 /*! \brief Computes the Boys function using interval arithmetic
  *         from string inputs
  *
@@ -35,12 +129,31 @@ void mirp_boys(arb_ptr F, int m, const arb_t t, slong working_prec);
 void mirp_boys_str(arb_ptr F, int m, const char * t, slong working_prec);
 
 
+/*! \brief Computes the Boys function from string inputs to a
+ *         number of decimal digits
+ *
+ * The first attempt uses the precision from \ref mirp_prec_initial. The
+ * working precision is then raised until all values are accurate
+ * enough (see \ref mirp_prec_target_reached).
+ *
+ * \param [out] F       The computed values of the Boys function
+ * \param [in]  m       The maximum order to calculate
+ * \param [in]  t       The value at which to evaluate
+ * \param [in]  ndigits Number of decimal digits wanted in the results
+ * \return The working precision of the last attempt
+ */
+slong mirp_boys_target(arb_ptr F, int m, const char * t, long ndigits);
+
+
 /*! \brief Computes the Boys function to exact double precision using
  *         interval arithmetic
  *
  * This function takes double precision as input and returns double precision
  * as output. Internally, it uses interval arithmetic to ensure that no
- * precision is lost
+ * precision is lost. The first attempt uses double-double arithmetic
+ * (\ref mirp_boys_dd), which also has rigorous error bounds. If that is
+ * not accurate enough, arb is used starting at the precision from
+ * \ref mirp_prec_initial.
  *
  * \warning \p F must be large enough to hold (\p m + 1) values, since
  *             this is computing from zero to m.
@@ -52,6 +165,27 @@ void mirp_boys_str(arb_ptr F, int m, const char * t, slong working_prec);
 void mirp_boys_exact(double *F, int m, double t);
 
 
+/*! \brief Computes the Boys function to exact double precision
+ *         for many values of t
+ *
+ * The results for input \p i are stored starting at \p F + \p i * (\p m + 1).
+ *
+ * All inputs are first computed with double-double arithmetic. Only the ones
+ * that are not accurate enough are then computed again together
+ * (with \ref mirp_boys_batch) at increasing working precisions, starting
+ * at the precision from \ref mirp_prec_initial.
+ *
+ * \param [out] F The computed values of the Boys function
+ *                (of length \p n * (\p m + 1))
+ * \param [in]  m The maximum order to calculate
+ * \param [in]  t The values at which to evaluate (of length \p n)
+ * \param [in]  n The number of values of t
+ * \param [in]  nthreads Number of threads to use if OpenMP is enabled
+ *                       (see \ref mirp_boys_batch)
+ */
+void mirp_boys_exact_batch(double * F, int m, const double * t, long n, int nthreads);
+
+
 #ifdef __cplusplus
 }
 #endif
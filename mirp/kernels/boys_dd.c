@@ -0,0 +1,114 @@
+/*! \file
+ *
+ * \brief Calculation of the boys function in double-double arithmetic
+ */
+
+#include "mirp/math.h"
+#include "mirp/kernels/boys_dd.h"
+#include <assert.h>
+
+
+/*! \brief Maximum number of terms of the series before giving up
+ *
+ * The series is only used for moderate t, where it needs far fewer terms
+ */
+#define MIRP_BOYS_DD_MAXTERMS 4096
+
+
+/*! \brief Computes F_m(t) from its asymptotic form
+ *
+ * F_m(t) = (2m-1)!!/2^(m+1) * sqrt(pi/t^(2m+1)) - Gamma(m+1/2, t) / (2 t^(m+1/2))
+ *
+ * The second term is bounded by exp(-t) / (2(t - max(0, m-1/2))) for
+ * t > m-1/2, and is added to the error bound.
+ *
+ * \return Nonzero if the neglected term is small enough (relative to 2^-110)
+ */
+static int mirp_boys_dd_asymptotic(mirp_dd * Fm, int m, mirp_dd t)
+{
+    const double tlow = (t.hi - t.rad) * (1.0 - MIRP_DD_WIDEN);
+    const double shift = MAX(0.0, m - 0.5);
+
+    if(!(tlow > shift + 1.0))
+        return 0;
+
+    const double R = mirp_dd_up(exp(-tlow) * (1.0 + 0x1p-48) /
+                                (2.0 * (tlow - shift) * (1.0 - MIRP_DD_WIDEN)));
+
+    /* sqrt(pi/t)/2 * prod_{i=1}^{m} (2i-1)/(2t) */
+    const mirp_dd t2 = mirp_dd_mul_2exp(t, 1);
+    mirp_dd A = mirp_dd_mul_2exp(mirp_dd_sqrt(mirp_dd_div(mirp_dd_const_pi(), t)), -1);
+
+    for(int i = 1; i <= m; i++)
+        A = mirp_dd_div(mirp_dd_mul_d(A, 2*i-1), t2);
+
+    if(!mirp_dd_is_finite(A) || !(R <= fabs(A.hi) * 0x1p-110))
+        return 0;
+
+    /* The exact value lies in [A - R, A] */
+    *Fm = mirp_dd_sub(A, mirp_dd_set_d(0.5 * R));
+    Fm->rad = mirp_dd_up(Fm->rad + 0.5 * R);
+    return 1;
+}
+
+
+/*! \brief Computes F_m(t) from its series
+ *
+ * F_m(t) = exp(-t) * sum_k (2t)^k / ((2m+1)(2m+3)...(2m+2k+1))
+ *
+ * The ratio of successive terms decreases, so once it is below one the
+ * remaining terms are bounded by a geometric series, which is added
+ * to the error bound.
+ */
+static void mirp_boys_dd_series(mirp_dd * Fm, int m, mirp_dd t, mirp_dd et)
+{
+    const mirp_dd t2 = mirp_dd_mul_2exp(t, 1);
+    const double t2max = mirp_dd_abs_ubound(t2);
+
+    mirp_dd term = mirp_dd_div_d(mirp_dd_set_d(1.0), 2*m+1);
+    mirp_dd sum = term;
+
+    for(int k = 1; k <= MIRP_BOYS_DD_MAXTERMS; k++)
+    {
+        term = mirp_dd_div_d(mirp_dd_mul(term, t2), 2*m+2*k+1);
+        sum = mirp_dd_add(sum, term);
+
+        /* Bound on the ratio of all the following terms */
+        const double ratio = t2max / (2*m+2*k+3) * (1.0 + MIRP_DD_WIDEN);
+
+        if(ratio < 0.5)
+        {
+            const double remainder = mirp_dd_up(mirp_dd_abs_ubound(term) * ratio / (1.0 - ratio));
+
+            if(remainder <= fabs(sum.hi) * 0x1p-110)
+            {
+                sum.rad = mirp_dd_up(sum.rad + remainder);
+                *Fm = mirp_dd_mul(sum, et);
+                return;
+            }
+        }
+    }
+
+    /* Did not converge */
+    *Fm = mirp_dd_set(0.0, 0.0, INFINITY);
+}
+
+
+void mirp_boys_dd(mirp_dd * F, int m, mirp_dd t)
+{
+    assert(m >= 0);
+    assert(t.hi >= 0.0);
+
+    const mirp_dd t2 = mirp_dd_mul_2exp(t, 1);
+    const mirp_dd et = mirp_dd_exp(mirp_dd_neg(t));
+
+    if(!mirp_boys_dd_asymptotic(F + m, m, t))
+        mirp_boys_dd_series(F + m, m, t, et);
+
+    /* Now do downwards recursion */
+    for(int i = m - 1; i >= 0; i--)
+    {
+        /* F[i] = (t2 * F[i + 1] + et) / (2 * i + 1) */
+        F[i] = mirp_dd_div_d(mirp_dd_add(mirp_dd_mul(t2, F[i+1]), et), 2*i+1);
+    }
+}
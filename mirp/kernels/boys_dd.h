@@ -0,0 +1,36 @@
+/*! \file
+ *
+ * \brief Calculation of the boys function in double-double arithmetic
+ */
+
+#pragma once
+
+#include "mirp/dd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Computes the Boys function using double-double arithmetic
+ *
+ * Like \ref mirp_boys, the results contain rigorous error bounds
+ * (see \ref mirp_dd). This is much faster, but is limited to
+ * roughly 100 bits.
+ *
+ * For large \p t, F_m is obtained from its asymptotic form, with a bound
+ * on the neglected incomplete gamma function added to the error. Otherwise,
+ * the series is used. The lower orders are then obtained by
+ * downward recursion.
+ *
+ * \warning \p F must be large enough to hold (\p m + 1) values, since
+ *             this is computing from zero to m.
+ *
+ * \param [out] F The computed values of the Boys function
+ * \param [in]  m The maximum order to calculate
+ * \param [in]  t The value at which to evaluate
+ */
+void mirp_boys_dd(mirp_dd * F, int m, mirp_dd t);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,49 @@
+/*! \file
+ *
+ * \brief Calculation of the boys function in double precision
+ */
+
+#include "mirp/math.h"
+#include "mirp/kernels/boys_double.h"
+#include <math.h>
+#include <float.h>
+#include <assert.h>
+
+
+void mirp_boys_double(double * F, int m, double t)
+{
+    assert(m >= 0);
+    assert(t >= 0.0);
+
+    const double et = exp(-t);
+
+    /* Upward recursion is stable once t is large compared to m */
+    if(t > 1.5*m + 30.0)
+    {
+        F[0] = 0.5 * sqrt(MIRP_PI / t) * erf(sqrt(t));
+
+        for(int i = 0; i < m; i++)
+            F[i+1] = ((2*i+1)*F[i] - et) / (2.0*t);
+
+        return;
+    }
+
+    /* F_m(t) = exp(-t) * sum_k (2t)^k / ((2m+1)(2m+3)...(2m+2k+1))
+     * All terms are positive
+     */
+    const double t2 = 2.0*t;
+    double term = 1.0 / (2*m+1);
+    double sum = term;
+
+    for(int k = 1; term > sum * DBL_EPSILON; k++)
+    {
+        term *= t2 / (2*m + 2*k + 1);
+        sum += term;
+    }
+
+    F[m] = et * sum;
+
+    /* Downward recursion */
+    for(int i = m; i > 0; i--)
+        F[i-1] = (t2*F[i] + et) / (2*i-1);
+}
@@ -0,0 +1,32 @@
+/*! \file
+ *
+ * \brief Calculation of the boys function in double precision
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Computes the Boys function using double precision
+ *
+ * This is not certified in any way, and is meant to produce
+ * a candidate result that is later checked with interval arithmetic.
+ *
+ * For small \p t, F_m is obtained from its series and the lower orders
+ * from downward recursion. For large \p t, F_0 is obtained from erf and
+ * the higher orders from upward recursion.
+ *
+ * \warning \p F must be large enough to hold (\p m + 1) values, since
+ *             this is computing from zero to m.
+ *
+ * \param [out] F The computed values of the Boys function
+ * \param [in]  m The maximum order to calculate
+ * \param [in]  t The value at which to evaluate
+ */
+void mirp_boys_double(double * F, int m, double t);
+
+#ifdef __cplusplus
+}
+#endif
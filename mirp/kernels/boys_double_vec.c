@@ -0,0 +1,328 @@
+/*! \file
+ *
+ * \brief Vectorized calculation of the boys function in double precision
+ */
+
+#include "mirp/kernels/boys_double_vec.h"
+#include "mirp/kernels/boys_double.h"
+#include "mirp/kernels/boys.h"
+#include "mirp/dd.h"
+#include <math.h>
+#include <stdlib.h>
+#include <assert.h>
+
+
+/*! \brief Number of grid points */
+#define MIRP_BOYS_DOUBLE_VEC_NPOINTS (MIRP_BOYS_DOUBLE_VEC_MAX_T*MIRP_BOYS_DOUBLE_VEC_NPERUNIT + 1)
+
+/*! \brief Number of values of F_j stored for each grid point */
+#define MIRP_BOYS_DOUBLE_VEC_NCOEF (MIRP_BOYS_DOUBLE_VEC_MAX_M + MIRP_BOYS_DOUBLE_VEC_ORDER)
+
+/*! \brief Number of inputs computed together
+ *
+ * The inner loops all have this (fixed) length, and
+ * the intermediates of a block stay in the cache
+ */
+#define MIRP_BOYS_DOUBLE_VEC_BLOCK 64
+
+/*! \brief Working precision (binary digits/bits) the table is computed with */
+#define MIRP_BOYS_DOUBLE_VEC_PREC 128
+
+/*! \brief sqrt(pi)/2 as a double-double value */
+#define MIRP_BOYS_DOUBLE_VEC_SQRTPI2_HI 0x1.c5bf891b4ef6bp-1
+#define MIRP_BOYS_DOUBLE_VEC_SQRTPI2_LO -0x1.618f13eb7ca89p-55
+
+
+/* Compile the kernel for several instruction sets, with the
+ * best one for the CPU chosen at runtime (via ifunc) */
+#if defined(__GNUC__) && !defined(__clang__) && !defined(__INTEL_COMPILER) && \
+    defined(__x86_64__) && defined(__linux__)
+    #define MIRP_BOYS_DOUBLE_VEC_CLONES \
+        __attribute__((target_clones("arch=skylake-avx512", "arch=haswell", "default")))
+#else
+    #define MIRP_BOYS_DOUBLE_VEC_CLONES
+#endif
+
+
+/*! \brief F_j at the grid points (NPOINTS * NCOEF values, NULL if not built) */
+static double * mirp_boys_double_vec_F = NULL;
+
+/*! \brief exp(-t) at the grid points (NPOINTS values) */
+static double * mirp_boys_double_vec_exp = NULL;
+
+/*! \brief 1/k for k = 0..ORDER-1 (the first element is not used) */
+static double mirp_boys_double_vec_inv_k[MIRP_BOYS_DOUBLE_VEC_ORDER];
+
+/*! \brief Nonzero if the table has been built
+ *
+ * This is checked on every call, so it is read atomically
+ * rather than in a critical section
+ */
+static int mirp_boys_double_vec_ready = 0;
+
+
+/*! \brief Computes all values of the table */
+static void mirp_boys_double_vec_build(void)
+{
+    const slong prec = MIRP_BOYS_DOUBLE_VEC_PREC;
+
+    mirp_boys_double_vec_F = malloc(MIRP_BOYS_DOUBLE_VEC_NPOINTS * MIRP_BOYS_DOUBLE_VEC_NCOEF * sizeof(double));
+    mirp_boys_double_vec_exp = malloc(MIRP_BOYS_DOUBLE_VEC_NPOINTS * sizeof(double));
+
+    arb_t t0, tmp;
+    arb_init(t0);
+    arb_init(tmp);
+    arb_ptr F = _arb_vec_init(MIRP_BOYS_DOUBLE_VEC_NCOEF);
+
+    for(int i = 0; i < MIRP_BOYS_DOUBLE_VEC_NPOINTS; i++)
+    {
+        /* Grid points are exact */
+        arb_set_d(t0, (double)i / MIRP_BOYS_DOUBLE_VEC_NPERUNIT);
+
+        mirp_boys(F, MIRP_BOYS_DOUBLE_VEC_NCOEF-1, t0, prec);
+        for(int j = 0; j < MIRP_BOYS_DOUBLE_VEC_NCOEF; j++)
+            mirp_boys_double_vec_F[i*MIRP_BOYS_DOUBLE_VEC_NCOEF + j] = arf_get_d(arb_midref(F + j), ARF_RND_NEAR);
+
+        arb_neg(tmp, t0);
+        arb_exp(tmp, tmp, prec);
+        mirp_boys_double_vec_exp[i] = arf_get_d(arb_midref(tmp), ARF_RND_NEAR);
+    }
+
+    mirp_boys_double_vec_inv_k[0] = 0.0;
+    for(int k = 1; k < MIRP_BOYS_DOUBLE_VEC_ORDER; k++)
+        mirp_boys_double_vec_inv_k[k] = 1.0 / k;
+
+    arb_clear(t0);
+    arb_clear(tmp);
+    _arb_vec_clear(F, MIRP_BOYS_DOUBLE_VEC_NCOEF);
+}
+
+
+/*! \brief Builds the table if it has not been built yet */
+static void mirp_boys_double_vec_init(void)
+{
+    int ready;
+
+    #ifdef _OPENMP
+    #pragma omp atomic read
+    #endif
+    ready = mirp_boys_double_vec_ready;
+
+    if(ready)
+    {
+        /* Make sure the contents of the table are visible */
+        #ifdef _OPENMP
+        #pragma omp flush
+        #endif
+        return;
+    }
+
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_boys_double_vec)
+    #endif
+    if(mirp_boys_double_vec_F == NULL)
+    {
+        mirp_boys_double_vec_build();
+
+        #ifdef _OPENMP
+        #pragma omp atomic write
+        #endif
+        mirp_boys_double_vec_ready = 1;
+    }
+}
+
+
+/*! \brief Computes the Boys function for one block of inputs
+ *
+ * All loops over the inputs have a fixed length and no branches.
+ * The results are stored in \p Fb, with F_j of input l at
+ * \p Fb[j * BLOCK + l].
+ *
+ * \param [out] Fb Results for the block
+ * \param [in]  m  The maximum order to calculate (at most MAX_M)
+ * \param [in]  tb The values at which to evaluate (BLOCK values)
+ */
+MIRP_BOYS_DOUBLE_VEC_CLONES
+static void mirp_boys_double_vec_block(double * restrict Fb, int m, const double * restrict tb)
+{
+    enum { BLOCK = MIRP_BOYS_DOUBLE_VEC_BLOCK,
+           ORDER = MIRP_BOYS_DOUBLE_VEC_ORDER,
+           NCOEF = MIRP_BOYS_DOUBLE_VEC_NCOEF,
+           NPERUNIT = MIRP_BOYS_DOUBLE_VEC_NPERUNIT };
+
+    const double * restrict table = mirp_boys_double_vec_F;
+    const double * restrict table_exp = mirp_boys_double_vec_exp;
+
+    int idx[BLOCK], large[BLOCK];
+    double tc[BLOCK], h[BLOCK], Fm[BLOCK], eh[BLOCK], et[BLOCK];
+    int nlarge = 0;
+
+    /* Nearest grid point. Inputs beyond the table are computed at t = 0
+     * (their results are replaced below), as are negative inputs, so
+     * that the index is always within the table */
+    for(int l = 0; l < BLOCK; l++)
+    {
+        large[l] = !(tb[l] < MIRP_BOYS_DOUBLE_VEC_MAX_T);
+        tc[l] = (large[l] || !(tb[l] >= 0.0)) ? 0.0 : tb[l];
+
+        idx[l] = (int)(tc[l] * NPERUNIT + 0.5);
+        h[l] = tc[l] - (double)idx[l] / NPERUNIT;
+        nlarge += large[l];
+    }
+
+    /* F_m(t0 + h) = sum_k F_{m+k}(t0) (-h)^k / k!
+     * exp(-h)     = sum_k (-h)^k / k!
+     *
+     * Both are evaluated with Horner's scheme, with the common
+     * factors -h/k computed once */
+    for(int l = 0; l < BLOCK; l++)
+    {
+        Fm[l] = table[idx[l]*NCOEF + m + ORDER - 1];
+        eh[l] = 1.0;
+    }
+
+    for(int k = ORDER-1; k > 0; k--)
+    {
+        const double inv_k = mirp_boys_double_vec_inv_k[k];
+
+        for(int l = 0; l < BLOCK; l++)
+        {
+            const double hk = -h[l] * inv_k;
+            Fm[l] = table[idx[l]*NCOEF + m + k - 1] + Fm[l] * hk;
+            eh[l] = 1.0 + eh[l] * hk;
+        }
+    }
+
+    for(int l = 0; l < BLOCK; l++)
+    {
+        et[l] = table_exp[idx[l]] * eh[l];
+        Fb[m*BLOCK + l] = Fm[l];
+    }
+
+    /* Downward recursion
+     * F_{j} = (2t F_{j+1} + exp(-t)) / (2j+1) */
+    for(int j = m-1; j >= 0; j--)
+    {
+        const double d = 2*j+1;
+        for(int l = 0; l < BLOCK; l++)
+            Fb[j*BLOCK + l] = (2.0 * tc[l] * Fb[(j+1)*BLOCK + l] + et[l]) / d;
+    }
+
+    if(nlarge == 0)
+        return;
+
+    /* Large t: F_0 = sqrt(pi)/2 * t^(-1/2), and upward recursion
+     * F_{j+1} = (j + 1/2)/t F_j (exp(-t) is negligible).
+     *
+     * Rounding the same 1/t in every step would add up to about m/2 ulp,
+     * so 1/t, t^(-1/2) and F_j are kept as double-double values. */
+    double u_hi[BLOCK], u_lo[BLOCK], F_hi[BLOCK], F_lo[BLOCK];
+
+    for(int l = 0; l < BLOCK; l++)
+    {
+        const double t = large[l] ? tb[l] : 1.0;
+        double p, e, q, d;
+
+        /* 1/t, corrected by the exact residual 1 - t/t */
+        u_hi[l] = 1.0 / t;
+        mirp_dd_two_prod(t, u_hi[l], &p, &e);
+        u_lo[l] = u_hi[l] * ((1.0 - p) - e);
+
+        /* t^(-1/2), with one Newton step for the residual 1 - t r^2 */
+        const double r_hi = 1.0 / sqrt(t);
+        mirp_dd_two_prod(r_hi, r_hi, &p, &e);
+        mirp_dd_two_prod(t, p, &q, &d);
+        const double r_lo = 0.5 * r_hi * (((1.0 - q) - d) - t * e);
+
+        mirp_dd_two_prod(MIRP_BOYS_DOUBLE_VEC_SQRTPI2_HI, r_hi, &p, &e);
+        e += MIRP_BOYS_DOUBLE_VEC_SQRTPI2_HI * r_lo + MIRP_BOYS_DOUBLE_VEC_SQRTPI2_LO * r_hi;
+        mirp_dd_quick_two_sum(p, e, F_hi + l, F_lo + l);
+    }
+
+    for(int j = 0; j <= m; j++)
+    {
+        const double c = j + 0.5;
+
+        for(int l = 0; l < BLOCK; l++)
+        {
+            double w_hi, w_lo, p, e;
+
+            Fb[j*BLOCK + l] = large[l] ? F_hi[l] : Fb[j*BLOCK + l];
+
+            /* (j + 1/2)/t */
+            mirp_dd_two_prod(u_hi[l], c, &p, &e);
+            e += u_lo[l] * c;
+            mirp_dd_quick_two_sum(p, e, &w_hi, &w_lo);
+
+            mirp_dd_two_prod(F_hi[l], w_hi, &p, &e);
+            e += F_hi[l] * w_lo + F_lo[l] * w_hi;
+            mirp_dd_quick_two_sum(p, e, F_hi + l, F_lo + l);
+        }
+    }
+}
+
+
+void mirp_boys_double_vec(double * F, int m, const double * t, long n)
+{
+    assert(m >= 0);
+    assert(n >= 0);
+
+    if(m > MIRP_BOYS_DOUBLE_VEC_MAX_M)
+    {
+        double * Fi = malloc((m+1) * sizeof(double));
+
+        for(long i = 0; i < n; i++)
+        {
+            mirp_boys_double(Fi, m, t[i]);
+            for(int j = 0; j <= m; j++)
+                F[j*n + i] = Fi[j];
+        }
+
+        free(Fi);
+        return;
+    }
+
+    mirp_boys_double_vec_init();
+
+    enum { BLOCK = MIRP_BOYS_DOUBLE_VEC_BLOCK };
+    double Fb[(MIRP_BOYS_DOUBLE_VEC_MAX_M+1) * BLOCK];
+    double tb[BLOCK];
+
+    for(long start = 0; start < n; start += BLOCK)
+    {
+        const int len = (n - start < BLOCK) ? (int)(n - start) : BLOCK;
+
+        /* The last block is padded with zeros */
+        for(int l = 0; l < BLOCK; l++)
+        {
+            tb[l] = (l < len) ? t[start + l] : 0.0;
+            assert(tb[l] >= 0.0);
+        }
+
+        mirp_boys_double_vec_block(Fb, m, tb);
+
+        /* Negative t (if assertions are disabled) gives NaN */
+        for(int j = 0; j <= m; j++)
+        for(int l = 0; l < len; l++)
+            F[j*n + start + l] = (tb[l] < 0.0) ? NAN : Fb[j*BLOCK + l];
+    }
+}
+
+
+void mirp_boys_double_vec_clear(void)
+{
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_boys_double_vec)
+    #endif
+    {
+        free(mirp_boys_double_vec_F);
+        free(mirp_boys_double_vec_exp);
+        mirp_boys_double_vec_F = NULL;
+        mirp_boys_double_vec_exp = NULL;
+
+        #ifdef _OPENMP
+        #pragma omp atomic write
+        #endif
+        mirp_boys_double_vec_ready = 0;
+    }
+}
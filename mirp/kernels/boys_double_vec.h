@@ -0,0 +1,89 @@
+/*! \file
+ *
+ * \brief Vectorized calculation of the boys function in double precision
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Largest order that is evaluated from the table
+ *
+ * Larger orders are computed with \ref mirp_boys_double
+ */
+#define MIRP_BOYS_DOUBLE_VEC_MAX_M 32
+
+/*! \brief Number of grid points per unit of t
+ *
+ * This is a power of two, so that the grid points and the
+ * distance to them are exact in double precision
+ */
+#define MIRP_BOYS_DOUBLE_VEC_NPERUNIT 8
+
+/*! \brief Largest t that is evaluated from the table
+ *
+ * From here on, exp(-t) is negligible in double precision for all
+ * orders up to \ref MIRP_BOYS_DOUBLE_VEC_MAX_M (the relative error
+ * of the large-t approximation is below 2^-60)
+ */
+#define MIRP_BOYS_DOUBLE_VEC_MAX_T 112
+
+/*! \brief Number of terms of the Taylor expansions around the grid points
+ *
+ * With a distance of at most 1/16 to the nearest grid point, the
+ * remainder is below 2^-61 relative to the result
+ */
+#define MIRP_BOYS_DOUBLE_VEC_ORDER 10
+
+
+/*! \brief Computes the Boys function for many values of t using double precision
+ *
+ * This is not certified in any way. It is meant as a fast kernel (for
+ * example, to compare other fast kernels against), and is checked against
+ * the reference data by `mirp_verify_test --float simd`.
+ *
+ * The results are stored as a structure of arrays: F_j for input \p i is
+ * stored at \p F[j * \p n + \p i].
+ *
+ * For t below \ref MIRP_BOYS_DOUBLE_VEC_MAX_T, F_m is obtained from a Taylor
+ * expansion around the nearest point of a table (the derivative of F_j
+ * is -F_{j+1}), and the lower orders from downward recursion. For larger t,
+ * the large-t approximation is exact in double precision, and is used with
+ * upward recursion. The table is computed with interval arithmetic the first
+ * time it is needed. There are no branches that depend on t in the inner
+ * loops, so they can be vectorized by the compiler. With GCC on x86-64, the
+ * kernel is compiled for AVX-512, AVX2 and generic CPUs, and the version to
+ * use is chosen at runtime.
+ *
+ * Orders larger than \ref MIRP_BOYS_DOUBLE_VEC_MAX_M are computed with
+ * \ref mirp_boys_double, one input at a time.
+ *
+ * This function is safe to call from multiple OpenMP threads.
+ *
+ * \warning \p F must be large enough to hold (\p m + 1) * \p n values, since
+ *             this is computing from zero to m.
+ *
+ * \param [out] F The computed values of the Boys function
+ * \param [in]  m The maximum order to calculate
+ * \param [in]  t The values at which to evaluate (all nonnegative. This is
+ *                checked with an assertion, and negative values give NaN
+ *                if assertions are disabled)
+ * \param [in]  n Number of values of t
+ */
+void mirp_boys_double_vec(double * F, int m, const double * t, long n);
+
+
+/*! \brief Free the table of \ref mirp_boys_double_vec
+ *
+ * It will be rebuilt if it is needed again.
+ *
+ * \warning This must not be called while other threads may
+ *          be using the table.
+ */
+void mirp_boys_double_vec_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
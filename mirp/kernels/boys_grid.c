@@ -0,0 +1,295 @@
+/*! \file
+ *
+ * \brief Calculation of the boys function from a certified table
+ */
+
+#include "mirp/kernels/boys_grid.h"
+#include "mirp/kernels/boys.h"
+#include "mirp/precision.h"
+#include "mirp/dd.h"
+#include <float.h>
+#include <stdlib.h>
+
+
+/*! \brief Number of grid points */
+#define MIRP_BOYS_GRID_NPOINTS (MIRP_BOYS_GRID_MAX_T*MIRP_BOYS_GRID_NPERUNIT + 1)
+
+/*! \brief Number of values of F_j stored for each grid point
+ *
+ * The expansion of F_m needs F_m through F_{m+ORDER} (the last
+ * one only for the bound on the remainder)
+ */
+#define MIRP_BOYS_GRID_NCOEF (MIRP_BOYS_GRID_MAX_M + MIRP_BOYS_GRID_ORDER + 1)
+
+/*! \brief Upper bound on exp(h) for the largest distance to a
+ *         grid point (|h| <= 1/16)
+ */
+#define MIRP_BOYS_GRID_EXP_HMAX 1.0645
+
+
+/*! \brief F_j at the grid points (NPOINTS * NCOEF values, NULL if not built) */
+static mirp_dd * mirp_boys_grid_F = NULL;
+
+/*! \brief exp(-t) at the grid points (NPOINTS values) */
+static mirp_dd * mirp_boys_grid_exp = NULL;
+
+/*! \brief 1/k for k = 0..ORDER (the first element is not used)
+ *
+ * Division is much more expensive than multiplication
+ * in double-double arithmetic
+ */
+static mirp_dd mirp_boys_grid_inv_k[MIRP_BOYS_GRID_ORDER+1];
+
+/*! \brief 1/(2j+1) for j = 0..MAX_M-1 (for the downward recursion) */
+static mirp_dd mirp_boys_grid_inv_odd[MIRP_BOYS_GRID_MAX_M];
+
+/*! \brief Nonzero if the table has been built
+ *
+ * This is checked on every call, so it is read atomically
+ * rather than in a critical section
+ */
+static int mirp_boys_grid_ready = 0;
+
+
+/*! \brief Converts an arb value to a double-double value
+ *
+ * The midpoint is split into hi and lo. Whatever does not fit
+ * is added to the error bound, together with the radius.
+ */
+static mirp_dd mirp_boys_grid_dd_set_arb(const arb_t x)
+{
+    if(!arb_is_finite(x))
+        return mirp_dd_set(0.0, 0.0, INFINITY);
+
+    arf_t rem, tmp;
+    arf_init(rem);
+    arf_init(tmp);
+
+    const double hi = arf_get_d(arb_midref(x), ARF_RND_NEAR);
+    arf_set_d(rem, hi);
+    arf_sub(rem, arb_midref(x), rem, ARF_PREC_EXACT, ARF_RND_DOWN);
+
+    const double lo = arf_get_d(rem, ARF_RND_NEAR);
+    arf_set_d(tmp, lo);
+    arf_sub(rem, rem, tmp, ARF_PREC_EXACT, ARF_RND_DOWN);
+
+    mag_t err;
+    mag_init(err);
+    arf_get_mag(err, rem);
+    mag_add(err, err, arb_radref(x));
+    const double rad = mirp_dd_up(mag_get_d(err));
+    mag_clear(err);
+
+    arf_clear(rem);
+    arf_clear(tmp);
+
+    /* hi is the nearest double, so |lo| <= ulp(hi)/2 */
+    return mirp_dd_set(hi, lo, rad);
+}
+
+
+/*! \brief Computes all values of the table */
+static void mirp_boys_grid_build(void)
+{
+    const slong prec = MIRP_BOYS_GRID_PREC;
+
+    mirp_boys_grid_F = malloc(MIRP_BOYS_GRID_NPOINTS * MIRP_BOYS_GRID_NCOEF * sizeof(mirp_dd));
+    mirp_boys_grid_exp = malloc(MIRP_BOYS_GRID_NPOINTS * sizeof(mirp_dd));
+
+    arb_t t0, tmp;
+    arb_init(t0);
+    arb_init(tmp);
+    arb_ptr F = _arb_vec_init(MIRP_BOYS_GRID_NCOEF);
+
+    for(int i = 0; i < MIRP_BOYS_GRID_NPOINTS; i++)
+    {
+        /* Grid points are exact */
+        arb_set_d(t0, (double)i / MIRP_BOYS_GRID_NPERUNIT);
+
+        mirp_boys(F, MIRP_BOYS_GRID_NCOEF-1, t0, prec);
+        for(int j = 0; j < MIRP_BOYS_GRID_NCOEF; j++)
+            mirp_boys_grid_F[i*MIRP_BOYS_GRID_NCOEF + j] = mirp_boys_grid_dd_set_arb(F + j);
+
+        arb_neg(tmp, t0);
+        arb_exp(tmp, tmp, prec);
+        mirp_boys_grid_exp[i] = mirp_boys_grid_dd_set_arb(tmp);
+    }
+
+    for(int k = 1; k <= MIRP_BOYS_GRID_ORDER; k++)
+    {
+        arb_set_ui(tmp, (ulong)k);
+        arb_inv(tmp, tmp, prec);
+        mirp_boys_grid_inv_k[k] = mirp_boys_grid_dd_set_arb(tmp);
+    }
+
+    for(int j = 0; j < MIRP_BOYS_GRID_MAX_M; j++)
+    {
+        arb_set_ui(tmp, (ulong)(2*j+1));
+        arb_inv(tmp, tmp, prec);
+        mirp_boys_grid_inv_odd[j] = mirp_boys_grid_dd_set_arb(tmp);
+    }
+
+    arb_clear(t0);
+    arb_clear(tmp);
+    _arb_vec_clear(F, MIRP_BOYS_GRID_NCOEF);
+}
+
+
+/*! \brief Builds the table if it has not been built yet */
+static void mirp_boys_grid_init(void)
+{
+    int ready;
+
+    #ifdef _OPENMP
+    #pragma omp atomic read
+    #endif
+    ready = mirp_boys_grid_ready;
+
+    if(ready)
+    {
+        /* Make sure the contents of the table are visible */
+        #ifdef _OPENMP
+        #pragma omp flush
+        #endif
+        return;
+    }
+
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_boys_grid)
+    #endif
+    if(mirp_boys_grid_F == NULL)
+    {
+        mirp_boys_grid_build();
+
+        #ifdef _OPENMP
+        #pragma omp atomic write
+        #endif
+        mirp_boys_grid_ready = 1;
+    }
+}
+
+
+/*! \brief Obtains the correctly-rounded double of a double-double value
+ *
+ * hi is the double nearest to hi + lo. This is the correctly-rounded
+ * result for everything in the ball if the ball does not reach any of
+ * the midpoints between hi and its neighbors.
+ *
+ * \return Nonzero if the result is guaranteed to be correctly rounded
+ */
+static int mirp_boys_grid_round(double * d, mirp_dd x)
+{
+    if(!mirp_dd_is_finite(x) || !(fabs(x.hi) >= DBL_MIN))
+        return 0;
+
+    /* Distance to the neighbors. These are exact */
+    const double up = nextafter(x.hi, INFINITY) - x.hi;
+    const double down = x.hi - nextafter(x.hi, -INFINITY);
+
+    /* The remaining distances to the midpoints are rounded,
+     * so they are reduced slightly */
+    const double rad = mirp_dd_up(x.rad);
+
+    if(!(rad < (0.5*up - x.lo) * (1.0 - MIRP_DD_WIDEN)))
+        return 0;
+    if(!(rad < (0.5*down + x.lo) * (1.0 - MIRP_DD_WIDEN)))
+        return 0;
+
+    *d = x.hi;
+    return 1;
+}
+
+
+int mirp_boys_grid(double * F, int m, double t)
+{
+    if(m < 0 || m > MIRP_BOYS_GRID_MAX_M || !(t >= 0.0 && t <= MIRP_BOYS_GRID_MAX_T))
+        return 0;
+
+    mirp_boys_grid_init();
+
+    /* Nearest grid point. Since t and t0 are within a factor of two
+     * of each other (or t0 is zero), h = t - t0 is exact */
+    const int i = (int)nearbyint(t * MIRP_BOYS_GRID_NPERUNIT);
+    const double t0 = (double)i / MIRP_BOYS_GRID_NPERUNIT;
+    const double h = t - t0;
+
+    const mirp_dd * c = mirp_boys_grid_F + i*MIRP_BOYS_GRID_NCOEF;
+
+    /* F_m(t0 + h) = sum_k F_{m+k}(t0) (-h)^k / k!
+     * exp(-h)     = sum_k (-h)^k / k!
+     *
+     * Both are evaluated with Horner's scheme, with the common
+     * factors -h/k computed once */
+    mirp_dd Fm = c[m + MIRP_BOYS_GRID_ORDER - 1];
+    mirp_dd eh = mirp_dd_set_d(1.0);
+
+    for(int k = MIRP_BOYS_GRID_ORDER-1; k > 0; k--)
+    {
+        const mirp_dd hk = mirp_dd_mul_d(mirp_boys_grid_inv_k[k], -h);
+        Fm = mirp_dd_add(c[m+k-1], mirp_dd_mul(Fm, hk));
+        eh = mirp_dd_add(mirp_dd_set_d(1.0), mirp_dd_mul(eh, hk));
+    }
+
+    /* Remainders (Lagrange form). The derivatives are bounded by
+     * F_{m+ORDER}(t0 - |h|) <= exp(|h|) F_{m+ORDER}(t0) and by exp(|h|) */
+    double rem = MIRP_BOYS_GRID_EXP_HMAX;
+    for(int k = 1; k <= MIRP_BOYS_GRID_ORDER; k++)
+        rem *= fabs(h) / k;
+
+    Fm.rad = mirp_dd_up(Fm.rad + mirp_dd_up(rem * mirp_dd_abs_ubound(c[m + MIRP_BOYS_GRID_ORDER])));
+    eh.rad = mirp_dd_up(eh.rad + mirp_dd_up(rem));
+
+    const mirp_dd et = mirp_dd_mul(mirp_boys_grid_exp[i], eh);
+
+    if(!mirp_boys_grid_round(F + m, Fm))
+        return 0;
+
+    /* Downward recursion
+     * F_{j} = (2t F_{j+1} + exp(-t)) / (2j+1) */
+    const mirp_dd t2 = mirp_dd_set_d(2.0 * t);
+
+    for(int j = m-1; j >= 0; j--)
+    {
+        Fm = mirp_dd_mul(mirp_dd_add(mirp_dd_mul(t2, Fm), et), mirp_boys_grid_inv_odd[j]);
+
+        if(!mirp_boys_grid_round(F + j, Fm))
+            return 0;
+    }
+
+    return 1;
+}
+
+
+void mirp_boys_grid_exact(double * F, int m, double t)
+{
+    const double stats_start = mirp_exact_stats_start();
+
+    if(mirp_boys_grid(F, m, t))
+    {
+        /* Nothing had to be computed with interval arithmetic */
+        const int am[4] = { m, 0, 0, 0 };
+        mirp_exact_stats_record(MIRP_EXACT_BOYS, am, 0, 0, 0, m+1, stats_start);
+        return;
+    }
+
+    mirp_boys_exact(F, m, t);
+}
+
+
+void mirp_boys_grid_clear(void)
+{
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_boys_grid)
+    #endif
+    {
+        free(mirp_boys_grid_F);
+        free(mirp_boys_grid_exp);
+        mirp_boys_grid_F = NULL;
+        mirp_boys_grid_exp = NULL;
+
+        #ifdef _OPENMP
+        #pragma omp atomic write
+        #endif
+        mirp_boys_grid_ready = 0;
+    }
+}
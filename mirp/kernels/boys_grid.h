@@ -0,0 +1,85 @@
+/*! \file
+ *
+ * \brief Calculation of the boys function from a certified table
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Largest order that can be evaluated from the table */
+#define MIRP_BOYS_GRID_MAX_M 32
+
+/*! \brief Number of grid points per unit of t
+ *
+ * This is a power of two, so that all grid points and the distance
+ * of any t to its nearest grid point are exact in double precision
+ */
+#define MIRP_BOYS_GRID_NPERUNIT 8
+
+/*! \brief Largest t that can be evaluated from the table */
+#define MIRP_BOYS_GRID_MAX_T 64
+
+/*! \brief Number of terms of the Taylor expansions around the grid points
+ *
+ * With a distance of at most 1/16 to the nearest grid point, the
+ * remainder is below 2^-76 relative to the result
+ */
+#define MIRP_BOYS_GRID_ORDER 12
+
+/*! \brief Working precision (binary digits/bits) the table is computed with */
+#define MIRP_BOYS_GRID_PREC 192
+
+
+/*! \brief Computes the Boys function from a precomputed table
+ *
+ * The table holds F_j at every grid point (for all j needed), computed
+ * with interval arithmetic and stored as double-double values with
+ * error bounds (see \ref mirp_dd). It is built the first time it is needed.
+ *
+ * F_m is obtained from a Taylor expansion around the nearest grid point
+ * (the derivative of F_j is -F_{j+1}), with a rigorous bound on the remainder.
+ * The lower orders are then obtained by downward recursion. All values are
+ * only returned if the error bounds guarantee that they are the correctly
+ * rounded results.
+ *
+ * This function is safe to call from multiple OpenMP threads.
+ *
+ * \warning \p F must be large enough to hold (\p m + 1) values, since
+ *             this is computing from zero to m.
+ *
+ * \param [out] F The computed values of the Boys function
+ * \param [in]  m The maximum order to calculate
+ * \param [in]  t The value at which to evaluate
+ * \return Nonzero if all values were computed and are correctly rounded.
+ *         Zero if \p m or \p t are outside of the table, or if the results
+ *         cannot be guaranteed (the contents of \p F are unspecified then).
+ */
+int mirp_boys_grid(double * F, int m, double t);
+
+
+/*! \brief Computes the Boys function to exact double precision,
+ *         using the precomputed table where possible
+ *
+ * This tries \ref mirp_boys_grid first, and falls back to
+ * \ref mirp_boys_exact if that does not give guaranteed results.
+ *
+ * \copydetails mirp_boys_exact
+ */
+void mirp_boys_grid_exact(double * F, int m, double t);
+
+
+/*! \brief Free the table
+ *
+ * It will be rebuilt if it is needed again.
+ *
+ * \warning This must not be called while other threads may
+ *          be using the table.
+ */
+void mirp_boys_grid_clear(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,171 +17,133 @@
 #include "mirp/kernels/boys.h"
 #include "mirp/kernels/gtoeri.h"
 #include "mirp/math.h"
+#include "mirp/math_table.h"
 #include "mirp/gpt.h"
+#include "mirp/shell.h"
 #include "mirp/pragma.h"
+#include "mirp/workspace.h"
 #include <assert.h>
 
-static void mirp_farr(arb_ptr f,
-                      int lmn1, int lmn2,
-                      arb_t xyz1, arb_t xyz2,
-                      slong working_prec)
+
+/*! \brief Terms of a primitive quartet that do not depend on the
+ *         cartesian components
+ *
+ * All the arrays of powers are of length L+1, where L is the total
+ * angular momentum of the quartet. They all point into a single
+ * block of storage taken from the workspace.
+ */
+typedef struct
 {
-    int i, j, k;
+    int L;                          //!< Total angular momentum of the quartet
+    const mirp_math_table * table;  //!< Factorials and binomial coefficients
+    mirp_workspace * ws;            //!< Workspace the storage was taken from
+    arb_ptr storage;                //!< Storage for all the terms below
 
-    arb_t tmp1, tmp2;
-    arb_init(tmp1);
-    arb_init(tmp2);
+    arb_ptr gammap;       //!< alpha1 + alpha2
+    arb_ptr gammaq;       //!< alpha3 + alpha4
+    arb_ptr gammapq;      //!< gammap * gammaq / (gammap + gammaq)
+    arb_ptr pfac;         //!< Overall prefactor of the integral
+    arb_ptr F;            //!< Boys function F_0 through F_L
 
-    _arb_vec_zero(f, lmn1 + lmn2 + 1);
+    arb_ptr PA_pow[3];  //!< Powers of PA (each direction)
+    arb_ptr PB_pow[3];  //!< Powers of PB (each direction)
+    arb_ptr QC_pow[3];  //!< Powers of QC (each direction)
+    arb_ptr QD_pow[3];  //!< Powers of QD (each direction)
+    arb_ptr PQ_k[3];    //!< PQ^k / k! (each direction)
 
-    for (k = 0; k <= lmn1 + lmn2; k++)
-    {
-        for (i = 0; i <= MIN(k,lmn1); i++)
-        {
-            j = k - i;
-            if (j > lmn2)
-                continue;
+    arb_ptr gammap_inv;   //!< gammap^(-k)
+    arb_ptr gammaq_inv;   //!< gammaq^(-k)
+    arb_ptr gammapq_pow;  //!< gammapq^k
+    arb_ptr gammapq_inv;  //!< gammapq^(-k)
+} mirp_gtoeri_quartet;
 
-            mirp_binomial(tmp1, lmn1, i);
-            mirp_binomial(tmp2, lmn2, j);
-            arb_mul(tmp1, tmp1, tmp2, working_prec);
 
-            if (lmn1 - i > 0)
-            {
-                mirp_pow_si(tmp2, xyz1, lmn1-i, working_prec);
-                arb_mul(tmp1, tmp1, tmp2, working_prec);
-            }
-            if (lmn2 - j > 0)
-            {
-                mirp_pow_si(tmp2, xyz2, lmn2-j, working_prec);
-                arb_mul(tmp1, tmp1, tmp2, working_prec);
-            }
-            arb_add(f + k, f + k, tmp1, working_prec);
-        }
-    }
+/*! \brief Size of the storage of a quartet with total angular momentum L */
+#define MIRP_GTOERI_QUARTET_SIZE(L) (4 + 20*((L)+1))
 
-    arb_clear(tmp1);
-    arb_clear(tmp2);
-}
+/*! \brief Number of scalar temporaries used by mirp_gtoeri_sum */
+#define MIRP_GTOERI_SUM_NTMP 10
 
 
-static void mirp_G(arb_t G, arb_t fp, arb_t fq,
-                   int np, int nq, int w1, int w2,
-                   arb_t gammap, arb_t gammaq, arb_t gammapq,
-                   slong working_prec)
+/*! \brief Obtains the storage for a quartet
+ *
+ * The quartet must be freed with \ref mirp_gtoeri_quartet_clear
+ */
+static void mirp_gtoeri_quartet_alloc(mirp_gtoeri_quartet * q, int L,
+                                      mirp_workspace * ws, slong working_prec)
 {
-    arb_t tmp1, tmp2;
-    arb_init(tmp1);
-    arb_init(tmp2);
-
-    arb_set_si(G, NEG1_POW(np));
-    arb_mul(G, G, fp, working_prec);
-    arb_mul(G, G, fq, working_prec);
-
-    mirp_factorial(tmp1, np);
-    arb_mul(G, G, tmp1, working_prec);
-    mirp_factorial(tmp1, nq);
-    arb_mul(G, G, tmp1, working_prec);
-
-    arb_set_si(tmp1, w1 - np);
-    arb_pow(tmp1, gammap, tmp1, working_prec);
-    arb_mul(G, G, tmp1, working_prec);
-
-    arb_set_si(tmp1, w2 - nq);
-    arb_pow(tmp1, gammaq, tmp1, working_prec);
-    arb_mul(G, G, tmp1, working_prec);
-
-    mirp_factorial(tmp1, np + nq - 2 * (w1 + w2));
-    arb_mul(G, G, tmp1, working_prec);
-
-    mirp_pow_si(tmp1, gammapq, np + nq - 2 * (w1 + w2), working_prec);
-    arb_mul(G, G, tmp1, working_prec);
-
-    mirp_factorial(tmp1, w1);
-    mirp_factorial(tmp2, w2);
-    arb_mul(tmp1, tmp1, tmp2, working_prec);
-    mirp_factorial(tmp2, np - 2 * w1);
-    arb_mul(tmp1, tmp1, tmp2, working_prec);
-    mirp_factorial(tmp2, nq - 2 * w2);
-    arb_mul(tmp1, tmp1, tmp2, working_prec);
-    arb_div(G, G, tmp1, working_prec);
-
-    arb_clear(tmp1);
-    arb_clear(tmp2);
-}
+    q->L = L;
+    q->table = mirp_math_table_get(L, working_prec);
+    q->ws = ws;
+    q->storage = mirp_workspace_vec_init(ws, MIRP_GTOERI_QUARTET_SIZE(L));
+
+    arb_ptr next = q->storage;
+    q->gammap = next++;
+    q->gammaq = next++;
+    q->gammapq = next++;
+    q->pfac = next++;
+    q->F = next;
+    next += L+1;
+
+    for(int x = 0; x < 3; x++)
+    {
+        q->PA_pow[x] = next;
+        q->PB_pow[x] = next + (L+1);
+        q->QC_pow[x] = next + 2*(L+1);
+        q->QD_pow[x] = next + 3*(L+1);
+        q->PQ_k[x] = next + 4*(L+1);
+        next += 5*(L+1);
+    }
 
-void mirp_gtoeri_single(arb_t integral,
-                        const int * lmn1, arb_srcptr A, const arb_t alpha1,
-                        const int * lmn2, arb_srcptr B, const arb_t alpha2,
-                        const int * lmn3, arb_srcptr C, const arb_t alpha3,
-                        const int * lmn4, arb_srcptr D, const arb_t alpha4,
-                        slong working_prec)
-{
-    assert(lmn1[0] >= 0); assert(lmn1[1] >= 0); assert(lmn1[2] >= 0);
-    assert(lmn2[0] >= 0); assert(lmn2[1] >= 0); assert(lmn2[2] >= 0);
-    assert(lmn3[0] >= 0); assert(lmn3[1] >= 0); assert(lmn3[2] >= 0);
-    assert(lmn4[0] >= 0); assert(lmn4[1] >= 0); assert(lmn4[2] >= 0);
+    q->gammap_inv = next;
+    q->gammaq_inv = next + (L+1);
+    q->gammapq_pow = next + 2*(L+1);
+    q->gammapq_inv = next + 3*(L+1);
+}
 
-    const int L_l = lmn1[0]+lmn2[0]+lmn3[0]+lmn4[0];
-    const int L_m = lmn1[1]+lmn2[1]+lmn3[1]+lmn4[1];
-    const int L_n = lmn1[2]+lmn2[2]+lmn3[2]+lmn4[2];
-    const int L = L_l + L_m + L_n;
 
-    arb_ptr F = _arb_vec_init(L+1);
-    arb_ptr flp = _arb_vec_init(lmn1[0]+lmn2[0]+1);
-    arb_ptr fmp = _arb_vec_init(lmn1[1]+lmn2[1]+1);
-    arb_ptr fnp = _arb_vec_init(lmn1[2]+lmn2[2]+1);
-    arb_ptr flq = _arb_vec_init(lmn3[0]+lmn4[0]+1);
-    arb_ptr fmq = _arb_vec_init(lmn3[1]+lmn4[1]+1);
-    arb_ptr fnq = _arb_vec_init(lmn3[2]+lmn4[2]+1);
+/*! \brief Computes all the lmn-independent terms of a primitive quartet
+ *         from the terms of the two primitive pairs
+ *
+ * This is the combined exponent gammapq, the Boys function up to order L,
+ * the various powers used in the sums, and the overall prefactor.
+ *
+ * The prefactor is
+ *
+ * 2 * pi**2.5 * K1 * K2 / (gammap * gammaq * sqrt(gammap + gammaq))
+ *
+ * with K1 = exp(-alpha1 * alpha2 * AB2 / gammap) (and similar for K2).
+ *
+ * The storage of the quartet must already be obtained
+ * with \ref mirp_gtoeri_quartet_alloc
+ */
+static void mirp_gtoeri_quartet_compute(mirp_gtoeri_quartet * q,
+                                        const arb_t gammap, arb_srcptr P,
+                                        arb_srcptr PA, arb_srcptr PB, const arb_t K1,
+                                        const arb_t gammaq, arb_srcptr Q,
+                                        arb_srcptr QC, arb_srcptr QD, const arb_t K2,
+                                        slong working_prec)
+{
+    const int L = q->L;
 
-    /* Zero the integral (we will be summing into it) */
-    arb_zero(integral);
+    arb_set(q->gammap, gammap);
+    arb_set(q->gammaq, gammaq);
 
     /* Temporary variables used in constructing expressions */
-    arb_t tmp1, tmp2, tmp3;
-    arb_t tmp4x, tmp4y, tmp4xy, tmp4z;
-    arb_init(tmp1);
-    arb_init(tmp2);
-    arb_init(tmp3);
-    arb_init(tmp4x);
-    arb_init(tmp4y);
-    arb_init(tmp4xy);
-    arb_init(tmp4z);
-
-
-    /*************************************************
-     * Calculate all the various terms from the GPT
-     *************************************************/
-    arb_ptr P  = _arb_vec_init(3);
-    arb_ptr PA = _arb_vec_init(3);
-    arb_ptr PB = _arb_vec_init(3);
-    arb_ptr Q  = _arb_vec_init(3);
-    arb_ptr QC = _arb_vec_init(3);
-    arb_ptr QD = _arb_vec_init(3);
-    arb_ptr PQ = _arb_vec_init(3);
-
-    arb_t gammap, gammaq, gammapq, AB2, CD2, PQ2;
-    arb_init(gammap);
-    arb_init(gammaq);
-    arb_init(gammapq);
-    arb_init(AB2);
-    arb_init(CD2);
-    arb_init(PQ2);
-
-    /* Gaussian Product Theorem */
-    mirp_gpt(alpha1, alpha2, A, B, gammap, P, PA, PB, AB2, working_prec);
-    mirp_gpt(alpha3, alpha4, C, D, gammaq, Q, QC, QD, CD2, working_prec);
-
+    arb_ptr tmp = mirp_workspace_vec_init(q->ws, 6);
+    arb_ptr tmp1 = tmp + 0;
+    arb_ptr tmp2 = tmp + 1;
+    arb_ptr PQ2 = tmp + 2;
+    arb_ptr PQ = tmp + 3;
 
     /*
      * gammapq = gammap * gammaq / (gammap + gammaq);
      * PQ[0] = P[0] - Q[0]
      * etc
      */
-    arb_mul(tmp1,    gammap, gammaq, working_prec);
-    arb_add(tmp2,    gammap, gammaq, working_prec);
-    arb_div(gammapq, tmp1,   tmp2,   working_prec);
+    arb_mul(tmp1,       q->gammap, q->gammaq, working_prec);
+    arb_add(tmp2,       q->gammap, q->gammaq, working_prec);
+    arb_div(q->gammapq, tmp1,      tmp2,      working_prec);
 
     arb_sub(PQ+0, P+0, Q+0, working_prec);
     arb_sub(PQ+1, P+1, Q+1, working_prec);
@@ -195,188 +157,642 @@ void mirp_gtoeri_single(arb_t integral,
     arb_addmul(PQ2, PQ+2, PQ+2, working_prec);
 
 
-    mirp_farr(flp, lmn1[0], lmn2[0], PA+0, PB+0, working_prec);
-    mirp_farr(fmp, lmn1[1], lmn2[1], PA+1, PB+1, working_prec);
-    mirp_farr(fnp, lmn1[2], lmn2[2], PA+2, PB+2, working_prec);
-    mirp_farr(flq, lmn3[0], lmn4[0], QC+0, QD+0, working_prec);
-    mirp_farr(fmq, lmn3[1], lmn4[1], QC+1, QD+1, working_prec);
-    mirp_farr(fnq, lmn3[2], lmn4[2], QC+2, QD+2, working_prec);
+    /*
+     *  Calculate the Boys function
+     */
+    arb_mul(tmp1, PQ2, q->gammapq, working_prec);
+    mirp_boys_ws(q->F, L, tmp1, q->ws, working_prec);
 
 
     /*
-     *  Calculate the Boys function
+     * Powers used in the f-arrays and the sums
+     */
+    for(int x = 0; x < 3; x++)
+    {
+        mirp_pow_vec(q->PA_pow[x], PA+x, L, working_prec);
+        mirp_pow_vec(q->PB_pow[x], PB+x, L, working_prec);
+        mirp_pow_vec(q->QC_pow[x], QC+x, L, working_prec);
+        mirp_pow_vec(q->QD_pow[x], QD+x, L, working_prec);
+
+        /* PQ_k[x][k] = PQ[x]^k / k! */
+        mirp_pow_vec(q->PQ_k[x], PQ+x, L, working_prec);
+        for(int k = 2; k <= L; k++)
+            arb_mul(q->PQ_k[x]+k, q->PQ_k[x]+k, q->table->inv_fac+k, working_prec);
+    }
+
+    arb_inv(tmp1, q->gammap, working_prec);
+    mirp_pow_vec(q->gammap_inv, tmp1, L, working_prec);
+    arb_inv(tmp1, q->gammaq, working_prec);
+    mirp_pow_vec(q->gammaq_inv, tmp1, L, working_prec);
+    mirp_pow_vec(q->gammapq_pow, q->gammapq, L, working_prec);
+    arb_inv(tmp1, q->gammapq, working_prec);
+    mirp_pow_vec(q->gammapq_inv, tmp1, L, working_prec);
+
+
+    /* Calculate the prefactor
+     *
+     * start with pfac = 2 * pi**2.5
+     */
+    arb_const_pi(q->pfac, working_prec);
+    arb_pow_ui(q->pfac, q->pfac, 5, working_prec);
+    arb_sqrt(q->pfac, q->pfac, working_prec);
+    arb_mul_ui(q->pfac, q->pfac, 2, working_prec);
+
+    /* Now multiply by K1 and K2 */
+    arb_mul(q->pfac, q->pfac, K1, working_prec);
+    arb_mul(q->pfac, q->pfac, K2, working_prec);
+
+    /*
+     * divide by (gammap * gammaq * sqrt(gammap + gammaq))
+     */
+    arb_add(tmp2, q->gammap, q->gammaq, working_prec);
+    arb_sqrt(tmp2, tmp2, working_prec);
+    arb_mul(tmp2, tmp2, q->gammap, working_prec);
+    arb_mul(tmp2, tmp2, q->gammaq, working_prec);
+    arb_div(q->pfac, q->pfac, tmp2, working_prec);
+
+
+    /* cleanup */
+    mirp_workspace_vec_clear(q->ws, tmp, 6);
+}
+
+
+/*! \brief Computes all the lmn-independent terms of a primitive quartet
+ *         from the terms of the two primitive pairs
+ *
+ * See \ref mirp_gtoeri_quartet_compute
+ *
+ * The quartet must be freed with \ref mirp_gtoeri_quartet_clear
+ */
+static void mirp_gtoeri_quartet_init_pairs(mirp_gtoeri_quartet * q, int L,
+                                           const arb_t gammap, arb_srcptr P,
+                                           arb_srcptr PA, arb_srcptr PB, const arb_t K1,
+                                           const arb_t gammaq, arb_srcptr Q,
+                                           arb_srcptr QC, arb_srcptr QD, const arb_t K2,
+                                           mirp_workspace * ws, slong working_prec)
+{
+    mirp_gtoeri_quartet_alloc(q, L, ws, working_prec);
+    mirp_gtoeri_quartet_compute(q,
+                                gammap, P, PA, PB, K1,
+                                gammaq, Q, QC, QD, K2,
+                                working_prec);
+}
+
+
+/*! \brief Computes all the lmn-independent terms of a primitive quartet
+ *
+ * This is the Gaussian Product Theorem for both pairs, followed by
+ * \ref mirp_gtoeri_quartet_compute
+ *
+ * The quartet must be freed with \ref mirp_gtoeri_quartet_clear
+ */
+static void mirp_gtoeri_quartet_init(mirp_gtoeri_quartet * q, int L,
+                                     arb_srcptr A, const arb_t alpha1,
+                                     arb_srcptr B, const arb_t alpha2,
+                                     arb_srcptr C, const arb_t alpha3,
+                                     arb_srcptr D, const arb_t alpha4,
+                                     mirp_workspace * ws, slong working_prec)
+{
+    mirp_gtoeri_quartet_alloc(q, L, ws, working_prec);
+
+    arb_ptr tmp = mirp_workspace_vec_init(ws, 24);
+    arb_ptr P  = tmp + 0;
+    arb_ptr PA = tmp + 3;
+    arb_ptr PB = tmp + 6;
+    arb_ptr Q  = tmp + 9;
+    arb_ptr QC = tmp + 12;
+    arb_ptr QD = tmp + 15;
+    arb_ptr gammap = tmp + 18;
+    arb_ptr gammaq = tmp + 19;
+    arb_ptr AB2 = tmp + 20;
+    arb_ptr CD2 = tmp + 21;
+    arb_ptr K1 = tmp + 22;
+    arb_ptr K2 = tmp + 23;
+
+    /* Gaussian Product Theorem */
+    mirp_gpt(alpha1, alpha2, A, B, gammap, P, PA, PB, AB2, working_prec);
+    mirp_gpt(alpha3, alpha4, C, D, gammaq, Q, QC, QD, CD2, working_prec);
+
+    /*
+     * K1 = exp(-alpha1 * alpha2 * AB2 / gammap);
+     * K2 = exp(-alpha3 * alpha4 * CD2 / gammaq);
+     */
+    arb_mul(K1, alpha1, alpha2, working_prec);
+    arb_mul(K1, K1, AB2, working_prec);
+    arb_div(K1, K1, gammap, working_prec);
+    arb_mul_si(K1, K1, -1, working_prec);
+    arb_exp(K1, K1, working_prec);
+
+    arb_mul(K2, alpha3, alpha4, working_prec);
+    arb_mul(K2, K2, CD2, working_prec);
+    arb_div(K2, K2, gammaq, working_prec);
+    arb_mul_si(K2, K2, -1, working_prec);
+    arb_exp(K2, K2, working_prec);
+
+    mirp_gtoeri_quartet_compute(q,
+                                gammap, P, PA, PB, K1,
+                                gammaq, Q, QC, QD, K2,
+                                working_prec);
+
+    /* cleanup */
+    mirp_workspace_vec_clear(ws, tmp, 24);
+}
+
+
+/*! \brief Frees memory associated with a quartet */
+static void mirp_gtoeri_quartet_clear(mirp_gtoeri_quartet * q)
+{
+    mirp_workspace_vec_clear(q->ws, q->storage, MIRP_GTOERI_QUARTET_SIZE(q->L));
+}
+
+
+/*! \brief Computes an f-array for one direction of a pair
+ *
+ * \p xyz1_pow and \p xyz2_pow hold the powers of PA and PB
+ * (or QC and QD) in that direction.
+ */
+static void mirp_farr(arb_ptr f,
+                      int lmn1, int lmn2,
+                      arb_srcptr xyz1_pow, arb_srcptr xyz2_pow,
+                      const mirp_math_table * table,
+                      mirp_workspace * ws, slong working_prec)
+{
+    int i, j, k;
+
+    arb_ptr tmp1 = mirp_workspace_vec_init(ws, 1);
+
+    _arb_vec_zero(f, lmn1 + lmn2 + 1);
+
+    for (k = 0; k <= lmn1 + lmn2; k++)
+    {
+        for (i = 0; i <= MIN(k,lmn1); i++)
+        {
+            j = k - i;
+            if (j > lmn2)
+                continue;
+
+            arb_mul(tmp1, MIRP_MATH_TABLE_BINOMIAL(table, lmn1, i),
+                          MIRP_MATH_TABLE_BINOMIAL(table, lmn2, j), working_prec);
+            arb_mul(tmp1, tmp1, xyz1_pow + (lmn1-i), working_prec);
+            arb_mul(tmp1, tmp1, xyz2_pow + (lmn2-j), working_prec);
+            arb_add(f + k, f + k, tmp1, working_prec);
+        }
+    }
+
+    mirp_workspace_vec_clear(ws, tmp1, 1);
+}
+
+
+static void mirp_G(arb_t G, const arb_t fp, const arb_t fq,
+                   int np, int nq, int w1, int w2,
+                   const mirp_gtoeri_quartet * q,
+                   slong working_prec)
+{
+    const mirp_math_table * table = q->table;
+    const int k = np + nq - 2 * (w1 + w2);
+
+    /* (-1)^np * fp * fq * np! * nq! * k!
+     *   * gammap^(w1-np) * gammaq^(w2-nq) * gammapq^k
+     *   / (w1! * w2! * (np-2*w1)! * (nq-2*w2)!)
+     *
+     * with k = np + nq - 2*(w1+w2)
      */
-    arb_mul(tmp1, PQ2, gammapq, working_prec);
-    mirp_boys(F, L, tmp1, working_prec);
+    arb_mul(G, fp, fq, working_prec);
+    if(NEG1_POW(np) < 0)
+        arb_neg(G, G);
+
+    arb_mul(G, G, table->fac + np, working_prec);
+    arb_mul(G, G, table->fac + nq, working_prec);
+    arb_mul(G, G, table->fac + k, working_prec);
+
+    arb_mul(G, G, q->gammap_inv + (np - w1), working_prec);
+    arb_mul(G, G, q->gammaq_inv + (nq - w2), working_prec);
+    arb_mul(G, G, q->gammapq_pow + k, working_prec);
+
+    arb_mul(G, G, table->inv_fac + w1, working_prec);
+    arb_mul(G, G, table->inv_fac + w2, working_prec);
+    arb_mul(G, G, table->inv_fac + (np - 2 * w1), working_prec);
+    arb_mul(G, G, table->inv_fac + (nq - 2 * w2), working_prec);
+}
 
 
+/*! \brief Computes the sum over the G terms for a single cartesian integral
+ *
+ * Everything except the lmn-dependent sum itself (GPT terms, Boys function,
+ * f-arrays) is computed beforehand, so that it can be shared between
+ * many cartesian components of a primitive quartet.
+ *
+ * For each product Gx*Gy*Gz, the terms of the innermost (tx,ty,tz) loops
+ * are collected and summed with a single arb_dot. This rounds once
+ * per block rather than once per term, giving tighter balls.
+ *
+ * The result does not include the prefactor
+ * (see \ref mirp_gtoeri_quartet_compute).
+ */
+static void mirp_gtoeri_sum(arb_t integral,
+                            int lp_max, int mp_max, int np_max,
+                            int lq_max, int mq_max, int nq_max,
+                            arb_srcptr flp, arb_srcptr fmp, arb_srcptr fnp,
+                            arb_srcptr flq, arb_srcptr fmq, arb_srcptr fnq,
+                            const mirp_gtoeri_quartet * q,
+                            mirp_workspace * ws, slong working_prec)
+{
+    const mirp_math_table * table = q->table;
+
+    /* Zero the integral (we will be summing into it) */
+    arb_zero(integral);
+
+    /* Largest block of (tx,ty,tz) terms */
+    const long nblock = ((lp_max + lq_max)/2 + 1)
+                      * ((mp_max + mq_max)/2 + 1)
+                      * ((np_max + nq_max)/2 + 1);
+
+    /* Temporary variables used in constructing expressions */
+    const long ntmp = MIRP_GTOERI_SUM_NTMP + 2*nblock;
+    arb_ptr tmp = mirp_workspace_vec_init(ws, ntmp);
+    arb_ptr tmp1 = tmp + 0;
+    arb_ptr tmp4x = tmp + 1;
+    arb_ptr tmp4y = tmp + 2;
+    arb_ptr tmp4xy = tmp + 3;
+    arb_ptr tmp4z = tmp + 4;
+
     /*
      * G values used within the loops
      */
-    arb_t Gx, Gy, Gz, Gxy, Gxyz;
-    arb_init(Gx);
-    arb_init(Gy);
-    arb_init(Gz);
-    arb_init(Gxy);
-    arb_init(Gxyz);
-
-    for(int lp = 0; lp <= lmn1[0] + lmn2[0]; lp++)
-    for(int lq = 0; lq <= lmn3[0] + lmn4[0]; lq++)
+    arb_ptr Gx = tmp + 5;
+    arb_ptr Gy = tmp + 6;
+    arb_ptr Gz = tmp + 7;
+    arb_ptr Gxy = tmp + 8;
+    arb_ptr Gxyz = tmp + 9;
+
+    /*
+     * Coefficients and Boys function values of the terms of a block
+     */
+    arb_ptr coef = tmp + MIRP_GTOERI_SUM_NTMP;
+    arb_ptr Fblock = coef + nblock;
+
+    for(int lp = 0; lp <= lp_max; lp++)
+    for(int lq = 0; lq <= lq_max; lq++)
     for(int u1 = 0; u1 <= (lp/2); u1++)
     for(int u2 = 0; u2 <= (lq/2); u2++)
     {
-        mirp_G(Gx, flp + lp, flq + lq, lp, lq, u1, u2, gammap, gammaq, gammapq, working_prec);
+        mirp_G(Gx, flp + lp, flq + lq, lp, lq, u1, u2, q, working_prec);
 
-        for(int mp = 0; mp <= lmn1[1] + lmn2[1]; mp++)
-        for(int mq = 0; mq <= lmn3[1] + lmn4[1]; mq++)
+        for(int mp = 0; mp <= mp_max; mp++)
+        for(int mq = 0; mq <= mq_max; mq++)
         for(int v1 = 0; v1 <= (mp/2); v1++)
         for(int v2 = 0; v2 <= (mq/2); v2++)
         {
-            mirp_G(Gy, fmp + mp, fmq + mq, mp, mq, v1, v2, gammap, gammaq, gammapq, working_prec);
+            mirp_G(Gy, fmp + mp, fmq + mq, mp, mq, v1, v2, q, working_prec);
 
             /* Gxy = Gx * Gy */
             arb_mul(Gxy, Gx, Gy, working_prec);
 
-            for(int np = 0; np <= lmn1[2] + lmn2[2]; np++)
-            for(int nq = 0; nq <= lmn3[2] + lmn4[2]; nq++)
+            for(int np = 0; np <= np_max; np++)
+            for(int nq = 0; nq <= nq_max; nq++)
             for(int w1 = 0; w1 <= (np/2); w1++)
             for(int w2 = 0; w2 <= (nq/2); w2++)
             {
-                mirp_G(Gz, fnp + np, fnq + nq, np, nq, w1, w2, gammap, gammaq, gammapq, working_prec);
+                mirp_G(Gz, fnp + np, fnq + nq, np, nq, w1, w2, q, working_prec);
 
-                /* Gxyz = Gx * Gy * Gz */
+                /* Gxyz = Gx * Gy * Gz / 4^(u1+u2+v1+v2+w1+w2)
+                 * (dividing by 4^n is exact)
+                 */
                 arb_mul(Gxyz, Gxy, Gz, working_prec);
+                arb_mul_2exp_si(Gxyz, Gxyz, -2*(u1 + u2 + v1 + v2 + w1 + w2));
+
+                /* Collect the terms of this block */
+                long n = 0;
 
                 for(int tx = 0; tx <= ((lp + lq - 2 * (u1 + u2)) / 2); tx++)
                 {
+                    /* tmp4x = PQ[0]^xfac / (xfac! * tx!) */
                     const int xfac = lp + lq - 2*(u1 + u2 + tx);
-                    mirp_pow_si(tmp4x, PQ+0, xfac, working_prec);
-                    mirp_factorial(tmp3, xfac);
-                    arb_div(tmp4x, tmp4x, tmp3, working_prec);
-
+                    arb_mul(tmp4x, q->PQ_k[0] + xfac, table->inv_fac + tx, working_prec);
 
                     for(int ty = 0; ty <= ((mp + mq - 2 * (v1 + v2)) / 2); ty++)
                     {
                         const int yfac = mp + mq - 2*(v1 + v2 + ty);
-                        mirp_pow_si(tmp4y, PQ+1, yfac, working_prec);
-                        mirp_factorial(tmp3, yfac);
-                        arb_div(tmp4y, tmp4y, tmp3, working_prec);
+                        arb_mul(tmp4y, q->PQ_k[1] + yfac, table->inv_fac + ty, working_prec);
                         arb_mul(tmp4xy, tmp4x, tmp4y, working_prec);
 
                         for(int tz = 0; tz <= ((np + nq - 2 * (w1 + w2)) / 2); tz++)
                         {
                             const int zfac = np + nq - 2*(w1 + w2 + tz);
-                            mirp_pow_si(tmp4z, PQ+2, zfac, working_prec);
-                            mirp_factorial(tmp3, zfac);
-                            arb_div(tmp4z, tmp4z, tmp3, working_prec);
+                            arb_mul(tmp4z, q->PQ_k[2] + zfac, table->inv_fac + tz, working_prec);
 
                             const int zeta = lp + lq + mp + mq + np + nq - 2*(u1 + u2 + v1 + v2 + w1 + w2) - tx - ty - tz;
 
-                            arb_mul_si(tmp1, Gxyz, NEG1_POW(tx+ty+tz), working_prec);
+                            arb_mul(coef + n, tmp4xy, tmp4z, working_prec);
+                            arb_mul(coef + n, coef + n, q->gammapq_inv + (tx + ty + tz), working_prec);
 
-                            arb_mul(tmp1, tmp1, F + zeta, working_prec);
-                            arb_mul(tmp1, tmp1, tmp4xy, working_prec);
-                            arb_mul(tmp1, tmp1, tmp4z, working_prec);
+                            /* Divide by 4^(tx+ty+tz), which is exact */
+                            arb_mul_2exp_si(coef + n, coef + n, -2*(tx + ty + tz));
 
-                            arb_set_ui(tmp2, 4);
-                            mirp_pow_si(tmp2, tmp2, u1 + u2 + tx + v1 + v2 + ty + w1 + w2 + tz, working_prec);
+                            if(NEG1_POW(tx+ty+tz) < 0)
+                                arb_neg(coef + n, coef + n);
 
-                            mirp_pow_si(tmp3, gammapq, tx + ty + tz, working_prec);
-                            arb_mul(tmp2, tmp2, tmp3, working_prec);
-
-                            mirp_factorial(tmp3, tx);
-                            arb_mul(tmp2, tmp2, tmp3, working_prec);
-
-                            mirp_factorial(tmp3, ty);
-                            arb_mul(tmp2, tmp2, tmp3, working_prec);
-
-                            mirp_factorial(tmp3, tz);
-                            arb_mul(tmp2, tmp2, tmp3, working_prec);
-
-                            arb_div(tmp1, tmp1, tmp2, working_prec);
-
-                            arb_add(integral, integral, tmp1, working_prec);
+                            arb_set(Fblock + n, q->F + zeta);
+                            n++;
                         }
                     }
                 }
+
+                /* integral += Gxyz * sum(coef * F) */
+                arb_dot(tmp1, NULL, 0, coef, 1, Fblock, 1, n, working_prec);
+                arb_addmul(integral, Gxyz, tmp1, working_prec);
             }
         }
     }
 
+    mirp_workspace_vec_clear(ws, tmp, ntmp);
+}
+
 
-    /* Calculate the prefactor
+void mirp_gtoeri_single_ws(arb_t integral,
+                           const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                           const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                           const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                           const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                           mirp_workspace * ws, slong working_prec)
+{
+    assert(lmn1[0] >= 0); assert(lmn1[1] >= 0); assert(lmn1[2] >= 0);
+    assert(lmn2[0] >= 0); assert(lmn2[1] >= 0); assert(lmn2[2] >= 0);
+    assert(lmn3[0] >= 0); assert(lmn3[1] >= 0); assert(lmn3[2] >= 0);
+    assert(lmn4[0] >= 0); assert(lmn4[1] >= 0); assert(lmn4[2] >= 0);
+
+    const int L_l = lmn1[0]+lmn2[0]+lmn3[0]+lmn4[0];
+    const int L_m = lmn1[1]+lmn2[1]+lmn3[1]+lmn4[1];
+    const int L_n = lmn1[2]+lmn2[2]+lmn3[2]+lmn4[2];
+    const int L = L_l + L_m + L_n;
+
+    mirp_gtoeri_quartet q;
+    mirp_gtoeri_quartet_init(&q, L,
+                             A, alpha1, B, alpha2, C, alpha3, D, alpha4,
+                             ws, working_prec);
+
+    /* All six f-arrays in one block */
+    const long nf = L + 6;
+    arb_ptr f = mirp_workspace_vec_init(ws, nf);
+    arb_ptr flp = f;
+    arb_ptr fmp = flp + (lmn1[0]+lmn2[0]+1);
+    arb_ptr fnp = fmp + (lmn1[1]+lmn2[1]+1);
+    arb_ptr flq = fnp + (lmn1[2]+lmn2[2]+1);
+    arb_ptr fmq = flq + (lmn3[0]+lmn4[0]+1);
+    arb_ptr fnq = fmq + (lmn3[1]+lmn4[1]+1);
+
+    mirp_farr(flp, lmn1[0], lmn2[0], q.PA_pow[0], q.PB_pow[0], q.table, ws, working_prec);
+    mirp_farr(fmp, lmn1[1], lmn2[1], q.PA_pow[1], q.PB_pow[1], q.table, ws, working_prec);
+    mirp_farr(fnp, lmn1[2], lmn2[2], q.PA_pow[2], q.PB_pow[2], q.table, ws, working_prec);
+    mirp_farr(flq, lmn3[0], lmn4[0], q.QC_pow[0], q.QD_pow[0], q.table, ws, working_prec);
+    mirp_farr(fmq, lmn3[1], lmn4[1], q.QC_pow[1], q.QD_pow[1], q.table, ws, working_prec);
+    mirp_farr(fnq, lmn3[2], lmn4[2], q.QC_pow[2], q.QD_pow[2], q.table, ws, working_prec);
+
+    mirp_gtoeri_sum(integral,
+                    lmn1[0]+lmn2[0], lmn1[1]+lmn2[1], lmn1[2]+lmn2[2],
+                    lmn3[0]+lmn4[0], lmn3[1]+lmn4[1], lmn3[2]+lmn4[2],
+                    flp, fmp, fnp, flq, fmq, fnq,
+                    &q, ws, working_prec);
+
+    /* apply the prefactor */
+    arb_mul(integral, integral, q.pfac, working_prec);
+
+
+    /* cleanup */
+    mirp_workspace_vec_clear(ws, f, nf);
+    mirp_gtoeri_quartet_clear(&q);
+}
+
+
+void mirp_gtoeri_single(arb_t integral,
+                        const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                        const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                        const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                        const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                        slong working_prec)
+{
+    const int max_am = MAX(MAX(lmn1[0]+lmn1[1]+lmn1[2], lmn2[0]+lmn2[1]+lmn2[2]),
+                           MAX(lmn3[0]+lmn3[1]+lmn3[2], lmn4[0]+lmn4[1]+lmn4[2]));
+
+    /* The workspace of this thread is kept between calls */
+    mirp_workspace * ws = mirp_workspace_local_get(1, MIRP_WORKSPACE_SIZE4(max_am));
+
+    mirp_gtoeri_single_ws(integral,
+                          lmn1, A, alpha1,
+                          lmn2, B, alpha2,
+                          lmn3, C, alpha3,
+                          lmn4, D, alpha4,
+                          ws, working_prec);
+
+    mirp_workspace_local_release(ws);
+}
+
+
+/*! \brief Computes the cartesian integrals of a primitive quartet
+ *         whose lmn-independent terms are already computed
+ *
+ * Only the components with indices in \p idx are computed (all of them
+ * if \p idx is NULL).
+ *
+ * \p ws holds one workspace for each thread (see \ref mirp_workspace_nthreads),
+ * or is NULL. The calling thread uses the first one.
+ */
+static void mirp_gtoeri_prim_quartet(arb_ptr integrals, const long * idx, long nidx,
+                                     int am1, int am2, int am3, int am4,
+                                     const mirp_gtoeri_quartet * q,
+                                     mirp_workspace * ws, slong working_prec)
+{
+    const long ncart1 = MIRP_NCART(am1);
+    const long ncart2 = MIRP_NCART(am2);
+    const long ncart3 = MIRP_NCART(am3);
+    const long ncart4 = MIRP_NCART(am4);
+    const long ncomp = (idx == NULL) ? ncart1*ncart2*ncart3*ncart4 : nidx;
+
+    int lmn1[ncart1][3];
+    int lmn2[ncart2][3];
+    int lmn3[ncart3][3];
+    int lmn4[ncart4][3];
+
+    mirp_gaussian_fill_lmn(am1, (int*)lmn1);
+    mirp_gaussian_fill_lmn(am2, (int*)lmn2);
+    mirp_gaussian_fill_lmn(am3, (int*)lmn3);
+    mirp_gaussian_fill_lmn(am4, (int*)lmn4);
+
+    /* The f-arrays only depend on a single component of lmn for each
+     * center of a pair. So build them for all combinations
+     * that can occur in this quartet.
      *
-     * start with pfac = 2 * pi**2.5
+     * fp[x][i][j] is for lmn1[x] = i and lmn2[x] = j (and similar for fq).
+     * They all point into a single block
      */
-    arb_const_pi(tmp1, working_prec);
-    arb_pow_ui(tmp1, tmp1, 5, working_prec);
-    arb_sqrt(tmp1, tmp1, working_prec);
-    arb_mul_ui(tmp1, tmp1, 2, working_prec);
+    arb_ptr fp[3][am1+1][am2+1];
+    arb_ptr fq[3][am3+1][am4+1];
 
-    /*
-     * Now multiply by K1 and K2
-     * K1 = exp(-alpha1 * alpha2 * AB2 / gammap);
-     * K2 = exp(-alpha3 * alpha4 * CD2 / gammaq);
-     */
-    arb_mul(tmp2, alpha1, alpha2, working_prec);
-    arb_mul(tmp2, tmp2, AB2, working_prec);
-    arb_div(tmp2, tmp2, gammap, working_prec);
-    arb_mul_si(tmp2, tmp2, -1, working_prec);
-    arb_exp(tmp2, tmp2, working_prec);
-    arb_mul(tmp1, tmp1, tmp2, working_prec);
-
-    arb_mul(tmp2, alpha3, alpha4, working_prec);
-    arb_mul(tmp2, tmp2, CD2, working_prec);
-    arb_div(tmp2, tmp2, gammaq, working_prec);
-    arb_mul_si(tmp2, tmp2, -1, working_prec);
-    arb_exp(tmp2, tmp2, working_prec);
-    arb_mul(tmp1, tmp1, tmp2, working_prec);
+    long nf = 0;
+    for(int i = 0; i <= am1; i++)
+    for(int j = 0; j <= am2; j++)
+        nf += 3*(i+j+1);
+    for(int i = 0; i <= am3; i++)
+    for(int j = 0; j <= am4; j++)
+        nf += 3*(i+j+1);
 
-    /*
-     * divide by (gammap * gammaq * sqrt(gammap + gammaq))
-     */
-    arb_add(tmp2, gammap, gammaq, working_prec);
-    arb_sqrt(tmp2, tmp2, working_prec);
-    arb_mul(tmp2, tmp2, gammap, working_prec);
-    arb_mul(tmp2, tmp2, gammaq, working_prec);
-    arb_div(tmp1, tmp1, tmp2, working_prec);
+    arb_ptr f = mirp_workspace_vec_init(ws, nf);
+    arb_ptr next = f;
 
-    /* apply the prefactor */
-    arb_mul(integral, integral, tmp1, working_prec);
+    for(int x = 0; x < 3; x++)
+    {
+        for(int i = 0; i <= am1; i++)
+        for(int j = 0; j <= am2; j++)
+        {
+            fp[x][i][j] = next;
+            next += i+j+1;
+            mirp_farr(fp[x][i][j], i, j, q->PA_pow[x], q->PB_pow[x], q->table, ws, working_prec);
+        }
+
+        for(int i = 0; i <= am3; i++)
+        for(int j = 0; j <= am4; j++)
+        {
+            fq[x][i][j] = next;
+            next += i+j+1;
+            mirp_farr(fq[x][i][j], i, j, q->QC_pow[x], q->QD_pow[x], q->table, ws, working_prec);
+        }
+    }
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        /* Each thread takes the temporaries for the sums from its own workspace */
+        mirp_workspace * ws_sum = mirp_workspace_thread(ws);
+
+        #ifdef _OPENMP
+        #pragma omp for
+        #endif
+        for(long n = 0; n < ncomp; n++)
+        {
+            /* Which cartesian components this integral is for */
+            const long cart = (idx == NULL) ? n : idx[n];
+            const long i = cart / (ncart4*ncart3*ncart2);
+            const long j = (cart / (ncart4*ncart3)) % ncart2;
+            const long k = (cart / ncart4) % ncart3;
+            const long l = cart % ncart4;
+
+            const int * l1 = lmn1[i];
+            const int * l2 = lmn2[j];
+            const int * l3 = lmn3[k];
+            const int * l4 = lmn4[l];
+
+            mirp_gtoeri_sum(integrals + cart,
+                            l1[0]+l2[0], l1[1]+l2[1], l1[2]+l2[2],
+                            l3[0]+l4[0], l3[1]+l4[1], l3[2]+l4[2],
+                            fp[0][l1[0]][l2[0]], fp[1][l1[1]][l2[1]], fp[2][l1[2]][l2[2]],
+                            fq[0][l3[0]][l4[0]], fq[1][l3[1]][l4[1]], fq[2][l3[2]][l4[2]],
+                            q, ws_sum, working_prec);
+
+            arb_mul(integrals + cart, integrals + cart, q->pfac, working_prec);
+        }
+    }
 
 
     /* cleanup */
-    _arb_vec_clear(F,   L+1);
-    _arb_vec_clear(flp, lmn1[0]+lmn2[0]+1);
-    _arb_vec_clear(fmp, lmn1[1]+lmn2[1]+1);
-    _arb_vec_clear(fnp, lmn1[2]+lmn2[2]+1);
-    _arb_vec_clear(flq, lmn3[0]+lmn4[0]+1);
-    _arb_vec_clear(fmq, lmn3[1]+lmn4[1]+1);
-    _arb_vec_clear(fnq, lmn3[2]+lmn4[2]+1);
-    _arb_vec_clear(P,  3);
-    _arb_vec_clear(PA, 3);
-    _arb_vec_clear(PB, 3);
-    _arb_vec_clear(Q,  3);
-    _arb_vec_clear(QC, 3);
-    _arb_vec_clear(QD, 3);
-    _arb_vec_clear(PQ, 3);
-    arb_clear(tmp1);
-    arb_clear(tmp2);
-    arb_clear(tmp3);
-    arb_clear(tmp4x);
-    arb_clear(tmp4y);
-    arb_clear(tmp4xy);
-    arb_clear(tmp4z);
-    arb_clear(gammap);
-    arb_clear(gammaq);
-    arb_clear(gammapq);
-    arb_clear(AB2);
-    arb_clear(CD2);
-    arb_clear(PQ2);
-    arb_clear(Gx);
-    arb_clear(Gy);
-    arb_clear(Gz);
-    arb_clear(Gxy);
-    arb_clear(Gxyz);
+    mirp_workspace_vec_clear(ws, f, nf);
+}
+
+
+void mirp_gtoeri_prim_ws(arb_ptr integrals,
+                         int am1, arb_srcptr A, const arb_t alpha1,
+                         int am2, arb_srcptr B, const arb_t alpha2,
+                         int am3, arb_srcptr C, const arb_t alpha3,
+                         int am4, arb_srcptr D, const arb_t alpha4,
+                         mirp_workspace * ws, slong working_prec)
+{
+    assert(am1 >= 0);
+    assert(am2 >= 0);
+    assert(am3 >= 0);
+    assert(am4 >= 0);
+
+    const int L = am1 + am2 + am3 + am4;
+
+    /* Everything that doesn't depend on lmn is computed once */
+    mirp_gtoeri_quartet q;
+    mirp_gtoeri_quartet_init(&q, L,
+                             A, alpha1, B, alpha2, C, alpha3, D, alpha4,
+                             ws, working_prec);
+
+    mirp_gtoeri_prim_quartet(integrals, NULL, 0, am1, am2, am3, am4, &q, ws, working_prec);
+
+    mirp_gtoeri_quartet_clear(&q);
+}
+
+
+void mirp_gtoeri_prim(arb_ptr integrals,
+                      int am1, arb_srcptr A, const arb_t alpha1,
+                      int am2, arb_srcptr B, const arb_t alpha2,
+                      int am3, arb_srcptr C, const arb_t alpha3,
+                      int am4, arb_srcptr D, const arb_t alpha4,
+                      slong working_prec)
+{
+    const int max_am = MAX(MAX(am1, am2), MAX(am3, am4));
+    const int nthreads = mirp_workspace_nthreads();
+
+    /* One workspace for each thread, shared by all the components
+     * and kept between calls */
+    mirp_workspace * ws = mirp_workspace_local_get(nthreads, MIRP_WORKSPACE_SIZE4(max_am));
+
+    mirp_gtoeri_prim_ws(integrals,
+                        am1, A, alpha1,
+                        am2, B, alpha2,
+                        am3, C, alpha3,
+                        am4, D, alpha4,
+                        ws, working_prec);
+
+    mirp_workspace_local_release(ws);
+}
+
+
+void mirp_gtoeri_prim_idx(arb_ptr integrals, const long * idx, long nidx,
+                          int am1, arb_srcptr A, const arb_t alpha1,
+                          int am2, arb_srcptr B, const arb_t alpha2,
+                          int am3, arb_srcptr C, const arb_t alpha3,
+                          int am4, arb_srcptr D, const arb_t alpha4,
+                          mirp_workspace * ws, slong working_prec)
+{
+    assert(am1 >= 0);
+    assert(am2 >= 0);
+    assert(am3 >= 0);
+    assert(am4 >= 0);
+
+    const int L = am1 + am2 + am3 + am4;
+
+    mirp_gtoeri_quartet q;
+    mirp_gtoeri_quartet_init(&q, L,
+                             A, alpha1, B, alpha2, C, alpha3, D, alpha4,
+                             ws, working_prec);
+
+    mirp_gtoeri_prim_quartet(integrals, idx, nidx, am1, am2, am3, am4, &q, ws, working_prec);
+
+    mirp_gtoeri_quartet_clear(&q);
 }
 
+
+void mirp_gtoeri_shellpair_prim(arb_ptr integrals, const long * idx, long nidx,
+                                const mirp_shellpair * bra, int ij,
+                                const mirp_shellpair * ket, int kl,
+                                mirp_workspace * ws, slong working_prec)
+{
+    const int L = bra->am1 + bra->am2 + ket->am1 + ket->am2;
+
+    /* The GPT terms come directly from the pairs */
+    mirp_gtoeri_quartet q;
+    mirp_gtoeri_quartet_init_pairs(&q, L,
+                                   bra->gamma + ij, bra->P + 3*ij,
+                                   bra->PA + 3*ij, bra->PB + 3*ij, bra->K + ij,
+                                   ket->gamma + kl, ket->P + 3*kl,
+                                   ket->PA + 3*kl, ket->PB + 3*kl, ket->K + kl,
+                                   ws, working_prec);
+
+    mirp_gtoeri_prim_quartet(integrals, idx, nidx, bra->am1, bra->am2, ket->am1, ket->am2,
+                             &q, ws, working_prec);
+
+    mirp_gtoeri_quartet_clear(&q);
+}
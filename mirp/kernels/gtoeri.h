@@ -7,6 +7,8 @@
 
 #include <arb.h>
 #include "mirp/kernels/integral4_wrappers.h"
+#include "mirp/kernels/gtoeri_dd.h"
+#include "mirp/kernels/gtoeri_bound.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +33,126 @@ void mirp_gtoeri_single(arb_t integral,
                         slong working_prec);
 
 
+/*! \brief Computes a single cartesian GTO electron repulsion integral
+ *         with temporaries taken from a workspace (interval arithmetic)
+ *
+ * \copydetails mirp_gtoeri_single
+ * \param [in]  ws
+ *              Workspace to take temporaries from (see \ref mirp_workspace).
+ *              A workspace of size \ref MIRP_WORKSPACE_SIZE4 is sufficient.
+ */
+void mirp_gtoeri_single_ws(arb_t integral,
+                           const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                           const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                           const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                           const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                           mirp_workspace * ws, slong working_prec);
+
+
+/*! \brief Computes all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet (interval arithmetic)
+ *
+ * The terms that do not depend on the cartesian component (Gaussian Product
+ * Theorem, Boys function, f-arrays, and the prefactor) are computed only
+ * once for the entire quartet.
+ *
+ * The \p integrals buffer must be able to hold
+ * ncart(am1) * ncart(am2) * ncart(am3) * ncart(am4) elements.
+ *
+ * \param [out] integrals
+ *              Resulting integrals
+ * \param [in]  am1,am2,am3,am4
+ *              Angular momentum of the four centers
+ * \param [in]  A,B,C,D
+ *              XYZ coordinates of the four centers (each of length 3)
+ * \param [in]  alpha1,alpha2,alpha3,alpha4
+ *              Exponents of the gaussian on the four centers
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+void mirp_gtoeri_prim(arb_ptr integrals,
+                      int am1, arb_srcptr A, const arb_t alpha1,
+                      int am2, arb_srcptr B, const arb_t alpha2,
+                      int am3, arb_srcptr C, const arb_t alpha3,
+                      int am4, arb_srcptr D, const arb_t alpha4,
+                      slong working_prec);
+
+
+/*! \brief Computes all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet with temporaries taken from
+ *         workspaces (interval arithmetic)
+ *
+ * If OpenMP is enabled, the cartesian components are split among the
+ * threads, and each thread takes its temporaries from its own workspace.
+ *
+ * \copydetails mirp_gtoeri_prim
+ * \param [in]  ws
+ *              One workspace for each thread, as given by \ref mirp_workspace_nthreads
+ *              (may be NULL). Workspaces of size \ref MIRP_WORKSPACE_SIZE4 are sufficient.
+ */
+void mirp_gtoeri_prim_ws(arb_ptr integrals,
+                         int am1, arb_srcptr A, const arb_t alpha1,
+                         int am2, arb_srcptr B, const arb_t alpha2,
+                         int am3, arb_srcptr C, const arb_t alpha3,
+                         int am4, arb_srcptr D, const arb_t alpha4,
+                         mirp_workspace * ws, slong working_prec);
+
+
+/*! \brief Computes some of the cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet (interval arithmetic)
+ *
+ * Only the components with indices in \p idx (positions in the output of
+ * \ref mirp_gtoeri_prim) are computed. The other elements of \p integrals
+ * are not touched. If \p idx is NULL, all components are computed.
+ *
+ * \copydetails mirp_gtoeri_prim_ws
+ * \param [in]  idx
+ *              Indices of the components to compute (may be NULL)
+ * \param [in]  nidx
+ *              Number of indices in \p idx
+ */
+void mirp_gtoeri_prim_idx(arb_ptr integrals, const long * idx, long nidx,
+                          int am1, arb_srcptr A, const arb_t alpha1,
+                          int am2, arb_srcptr B, const arb_t alpha2,
+                          int am3, arb_srcptr C, const arb_t alpha3,
+                          int am4, arb_srcptr D, const arb_t alpha4,
+                          mirp_workspace * ws, slong working_prec);
+
+
+/*! \brief Computes all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet from precomputed shell pairs
+ *         (interval arithmetic)
+ *
+ * This is the same as \ref mirp_gtoeri_prim, however the Gaussian Product
+ * Theorem terms of the two primitive pairs are taken from \p bra and \p ket.
+ *
+ * Only the components with indices in \p idx are computed
+ * (see \ref mirp_gtoeri_prim_idx).
+ *
+ * \param [out] integrals
+ *              Resulting integrals
+ * \param [in]  idx
+ *              Indices of the components to compute (may be NULL for all)
+ * \param [in]  nidx
+ *              Number of indices in \p idx
+ * \param [in]  bra,ket
+ *              The two pairs of shells making up the quartet
+ * \param [in]  ij,kl
+ *              Index of the primitive pair within \p bra and \p ket
+ *              (see \ref mirp_shellpair)
+ * \param [in]  ws
+ *              One workspace for each thread (see \ref mirp_gtoeri_prim_ws)
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+void mirp_gtoeri_shellpair_prim(arb_ptr integrals, const long * idx, long nidx,
+                                const mirp_shellpair * bra, int ij,
+                                const mirp_shellpair * ket, int kl,
+                                mirp_workspace * ws, slong working_prec);
+
+
 /*******************
  * Wrappings
  *******************/
@@ -43,6 +165,14 @@ void mirp_gtoeri_single(arb_t integral,
 MIRP_WRAP_SINGLE4_STR(gtoeri)
 
 
+/*! \brief Compute a single GTO electron repulsion integral for a primitive quartet
+ *         (string inputs, target digits)
+ *
+ * \copydetails mirp_integral4_single_target
+ */
+MIRP_WRAP_SINGLE4_TARGET(gtoeri)
+
+
 /*! \brief Compute a single GTO electron repulsion integral for a primitive quartet
  *         (exact double precision)
  *
@@ -71,7 +201,7 @@ MIRP_WRAP_SINGLE4_EXACT(gtoeri)
  *              The working precision (binary digits/bits) to use
  *              in the calculation
  */
-MIRP_WRAP_SHELL4(gtoeri)
+MIRP_WRAP_SHELL4_IDX(gtoeri)
 
 
 /*! \brief Compute GTO electron repulsion integrals for a contracted
@@ -82,6 +212,14 @@ MIRP_WRAP_SHELL4(gtoeri)
 MIRP_WRAP_SHELL4_STR(gtoeri)
 
 
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet (string inputs, target digits)
+ *
+ * \copydetails mirp_integral4_target
+ */
+MIRP_WRAP_SHELL4_TARGET(gtoeri)
+
+
 /*! \brief Compute GTO electron repulsion integrals for a contracted
  *         shell quartet (exact double precision)
  *
@@ -103,7 +241,32 @@ MIRP_WRAP_SHELL4_STR(gtoeri)
  *              for each shell (of lengths \p nprim1 * \p ngen1, \p nprim2 * \p ngen2,
  *              \p nprim3 * \p ngen3, \p nprim4 * \p ngen4 respectively)
  */
-MIRP_WRAP_SHELL4_EXACT(gtoeri)
+MIRP_WRAP_SHELL4_EXACT_FAST(gtoeri)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet from precomputed shell pairs (interval arithmetic)
+ *
+ * \param [out] integrals
+ *              Output for the computed integral
+ * \param [in]  bra,ket
+ *              The two pairs of shells making up the quartet
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+MIRP_WRAP_SHELLPAIR4(gtoeri)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet from precomputed shell pairs (exact double precision)
+ *
+ * \param [out] integrals
+ *              Output for the computed integral
+ * \param [in]  bra,ket
+ *              The two pairs of shells making up the quartet
+ */
+MIRP_WRAP_SHELLPAIR4_EXACT(gtoeri)
 
 
 
@@ -0,0 +1,112 @@
+/*! \file
+ *
+ * \brief A-priori bound on the magnitude of electron repulsion integrals
+ *        of gaussian orbitals
+ */
+
+#include "mirp/kernels/gtoeri_bound.h"
+#include "mirp/math.h"
+#include <math.h>
+#include <float.h>
+
+
+/*! \brief Part of the exponent used to bound the polynomial factor
+ *
+ * A smaller value keeps more of the decay of the gaussians, at the
+ * cost of a larger bound on the polynomial factor.
+ */
+#define MIRP_GTOERI_BOUND_EPS 0.0625
+
+/*! \brief e (base of the natural logarithm) */
+#define MIRP_E 2.71828182845904524
+
+/*! \brief log2(e) */
+#define MIRP_LOG2_E 1.44269504088896341
+
+
+/*! \brief Lower bound on the distance between two points in one direction
+ *
+ * The difference may be computed from two rounded values, so it
+ * is lowered by a few ulp of the larger one.
+ */
+static double mirp_dist_lbound(double a, double b)
+{
+    const double d = fabs(a - b) - 4.0 * DBL_EPSILON * (fabs(a) + fabs(b));
+    return MAX(d, 0.0);
+}
+
+
+double mirp_gtoeri_bound(int am1, const double * A, double alpha1,
+                         int am2, const double * B, double alpha2,
+                         int am3, const double * C, double alpha3,
+                         int am4, const double * D, double alpha4)
+{
+    const int am[4] = { am1, am2, am3, am4 };
+    const double alpha[4] = { alpha1, alpha2, alpha3, alpha4 };
+
+    /* The bound is a sum of log2 terms. Their magnitude
+     * determines how much the rounding errors can add up to */
+    double bound = 0.0;
+    double mag = 0.0;
+
+    /* Exponents left for the s-type integral */
+    double a[4];
+
+    for(int i = 0; i < 4; i++)
+    {
+        if(!(alpha[i] > 0.0) || !isfinite(alpha[i]))
+            return INFINITY;
+
+        if(am[i] == 0)
+            a[i] = alpha[i];
+        else
+        {
+            a[i] = (1.0 - MIRP_GTOERI_BOUND_EPS) * alpha[i];
+
+            /* (L / (2 e eps alpha))^(L/2) */
+            const double t = 0.5 * am[i] * log2(am[i] / (2.0 * MIRP_E * MIRP_GTOERI_BOUND_EPS * alpha[i]));
+            bound += t;
+            mag += fabs(t);
+        }
+    }
+
+    const double p = a[0] + a[1];
+    const double q = a[2] + a[3];
+
+    double AB2 = 0.0, CD2 = 0.0, PQ2 = 0.0;
+    for(int i = 0; i < 3; i++)
+    {
+        const double AB = mirp_dist_lbound(A[i], B[i]);
+        const double CD = mirp_dist_lbound(C[i], D[i]);
+        const double P = (a[0] * A[i] + a[1] * B[i]) / p;
+        const double Q = (a[2] * C[i] + a[3] * D[i]) / q;
+        const double PQ = mirp_dist_lbound(P, Q);
+
+        AB2 += AB * AB;
+        CD2 += CD * CD;
+        PQ2 += PQ * PQ;
+    }
+
+    /* 2 pi^(5/2) / (p q sqrt(p+q)) */
+    const double pre = 1.0 + 2.5 * log2(MIRP_PI) - log2(p) - log2(q) - 0.5 * log2(p + q);
+    bound += pre;
+    mag += fabs(pre);
+
+    /* The K factors of the two pairs */
+    const double KAB = -(a[0] * a[1] / p) * AB2 * MIRP_LOG2_E;
+    const double KCD = -(a[2] * a[3] / q) * CD2 * MIRP_LOG2_E;
+    bound += KAB + KCD;
+    mag += fabs(KAB) + fabs(KCD);
+
+    /* F0(T) <= min(1, sqrt(pi / (4T))) */
+    const double T = p * q / (p + q) * PQ2;
+    if(T > MIRP_PI / 4.0)
+    {
+        const double F0 = 0.5 * log2(MIRP_PI / (4.0 * T));
+        bound += F0;
+        mag += fabs(F0);
+    }
+
+    /* Each term has a relative error of a few ulp */
+    return bound + 64.0 * DBL_EPSILON * mag;
+}
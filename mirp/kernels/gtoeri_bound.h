@@ -0,0 +1,45 @@
+/*! \file
+ *
+ * \brief A-priori bound on the magnitude of electron repulsion integrals
+ *        of gaussian orbitals
+ *
+ * This bound does not depend on how the integrals are computed, so it is
+ * shared by all ERI kernels. It is used by the exact functions to return
+ * integrals that underflow in double precision without computing them.
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Bounds all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet
+ *
+ * A small part of each exponent is used to bound the polynomial factor,
+ * since \f$r^L e^{-\epsilon \alpha r^2} \le (L / (2 e \epsilon \alpha))^{L/2}\f$.
+ * The remaining (positive) integrand is that of an s-type integral,
+ * whose value is bounded using \f$F_0(T) \le \min(1, \sqrt{\pi/(4T)})\f$.
+ *
+ * The bound is computed in double precision, and is increased to account
+ * for its own rounding errors.
+ *
+ * \param [in]  am1,am2,am3,am4
+ *              Angular momentum of the four centers
+ * \param [in]  A,B,C,D
+ *              XYZ coordinates of the four centers (each of length 3)
+ * \param [in]  alpha1,alpha2,alpha3,alpha4
+ *              Exponents of the gaussian on the four centers
+ * \return log2 of an upper bound on the absolute value of all
+ *         (unnormalized) integrals of the quartet. This is infinite if
+ *         no bound can be given.
+ */
+double mirp_gtoeri_bound(int am1, const double * A, double alpha1,
+                         int am2, const double * B, double alpha2,
+                         int am3, const double * C, double alpha3,
+                         int am4, const double * D, double alpha4);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,350 @@
+/*! \file
+ *
+ * \brief Kernel for electron repulsion integrals of gaussian orbitals
+ *        in double-double arithmetic
+ *
+ * This follows the same method as the interval arithmetic kernel
+ * (see gtoeri.c), with all arithmetic done on \ref mirp_dd values.
+ * All temporaries live on the stack, so nothing is allocated.
+ */
+
+#include "mirp/math.h"
+#include "mirp/gpt.h"
+#include "mirp/dd.h"
+#include "mirp/kernels/boys_dd.h"
+#include "mirp/kernels/gtoeri.h"
+#include "mirp/kernels/gtoeri_dd.h"
+#include <assert.h>
+
+
+/*! \brief Computes all integer powers b^0 through b^n */
+static void mirp_pow_vec_dd(mirp_dd * output, mirp_dd b, int n)
+{
+    output[0] = mirp_dd_set_d(1.0);
+    for(int i = 1; i <= n; i++)
+        output[i] = mirp_dd_mul(output[i-1], b);
+}
+
+
+/*! \brief Binomial coefficient (exact for the small arguments used here) */
+static long mirp_binomial_si(int n, int k)
+{
+    long r = 1;
+    for(int i = 0; i < k; i++)
+        r = (r * (n - i)) / (i + 1);
+    return r;
+}
+
+
+/*! \brief Computes an f-array for one direction of a pair
+ *
+ * \p xyz1_pow and \p xyz2_pow hold the powers of PA and PB
+ * (or QC and QD) in that direction.
+ */
+static void mirp_farr_dd(mirp_dd * f, int lmn1, int lmn2,
+                         const mirp_dd * xyz1_pow, const mirp_dd * xyz2_pow)
+{
+    for(int k = 0; k <= lmn1 + lmn2; k++)
+    {
+        f[k] = mirp_dd_set_d(0.0);
+
+        for(int i = 0; i <= MIN(k,lmn1); i++)
+        {
+            const int j = k - i;
+            if(j > lmn2)
+                continue;
+
+            const long binom = mirp_binomial_si(lmn1, i) * mirp_binomial_si(lmn2, j);
+            mirp_dd tmp = mirp_dd_mul(xyz1_pow[lmn1-i], xyz2_pow[lmn2-j]);
+            tmp = mirp_dd_mul(tmp, mirp_dd_set_si(binom));
+            f[k] = mirp_dd_add(f[k], tmp);
+        }
+    }
+}
+
+
+/*! \brief Terms of a primitive quartet that do not depend on the
+ *         cartesian components
+ *
+ * The arrays are all of length L+1, and are owned by the caller.
+ */
+typedef struct
+{
+    const mirp_dd * fac;          //!< n!
+    const mirp_dd * inv_fac;      //!< 1/n!
+    const mirp_dd * F;            //!< Boys function F_0 through F_L
+    const mirp_dd * PQ_k[3];      //!< PQ^k / k! (each direction)
+    const mirp_dd * gammap_inv;   //!< gammap^(-k)
+    const mirp_dd * gammaq_inv;   //!< gammaq^(-k)
+    const mirp_dd * gammapq_pow;  //!< gammapq^k
+    const mirp_dd * gammapq_inv;  //!< gammapq^(-k)
+} mirp_gtoeri_dd_quartet;
+
+
+static mirp_dd mirp_G_dd(mirp_dd fp, mirp_dd fq,
+                         int np, int nq, int w1, int w2,
+                         const mirp_gtoeri_dd_quartet * q)
+{
+    const int k = np + nq - 2 * (w1 + w2);
+
+    /* (-1)^np * fp * fq * np! * nq! * k!
+     *   * gammap^(w1-np) * gammaq^(w2-nq) * gammapq^k
+     *   / (w1! * w2! * (np-2*w1)! * (nq-2*w2)!)
+     */
+    mirp_dd G = mirp_dd_mul(fp, fq);
+    if(NEG1_POW(np) < 0)
+        G = mirp_dd_neg(G);
+
+    G = mirp_dd_mul(G, q->fac[np]);
+    G = mirp_dd_mul(G, q->fac[nq]);
+    G = mirp_dd_mul(G, q->fac[k]);
+
+    G = mirp_dd_mul(G, q->gammap_inv[np - w1]);
+    G = mirp_dd_mul(G, q->gammaq_inv[nq - w2]);
+    G = mirp_dd_mul(G, q->gammapq_pow[k]);
+
+    G = mirp_dd_mul(G, q->inv_fac[w1]);
+    G = mirp_dd_mul(G, q->inv_fac[w2]);
+    G = mirp_dd_mul(G, q->inv_fac[np - 2 * w1]);
+    G = mirp_dd_mul(G, q->inv_fac[nq - 2 * w2]);
+    return G;
+}
+
+
+/*! \brief Computes the sum over the G terms for a single cartesian integral
+ *
+ * The result does not include the prefactor
+ */
+static mirp_dd mirp_gtoeri_sum_dd(int lp_max, int mp_max, int np_max,
+                                  int lq_max, int mq_max, int nq_max,
+                                  const mirp_dd * flp, const mirp_dd * fmp, const mirp_dd * fnp,
+                                  const mirp_dd * flq, const mirp_dd * fmq, const mirp_dd * fnq,
+                                  const mirp_gtoeri_dd_quartet * q)
+{
+    mirp_dd integral = mirp_dd_set_d(0.0);
+
+    for(int lp = 0; lp <= lp_max; lp++)
+    for(int lq = 0; lq <= lq_max; lq++)
+    for(int u1 = 0; u1 <= (lp/2); u1++)
+    for(int u2 = 0; u2 <= (lq/2); u2++)
+    {
+        const mirp_dd Gx = mirp_G_dd(flp[lp], flq[lq], lp, lq, u1, u2, q);
+
+        for(int mp = 0; mp <= mp_max; mp++)
+        for(int mq = 0; mq <= mq_max; mq++)
+        for(int v1 = 0; v1 <= (mp/2); v1++)
+        for(int v2 = 0; v2 <= (mq/2); v2++)
+        {
+            const mirp_dd Gy = mirp_G_dd(fmp[mp], fmq[mq], mp, mq, v1, v2, q);
+            const mirp_dd Gxy = mirp_dd_mul(Gx, Gy);
+
+            for(int np = 0; np <= np_max; np++)
+            for(int nq = 0; nq <= nq_max; nq++)
+            for(int w1 = 0; w1 <= (np/2); w1++)
+            for(int w2 = 0; w2 <= (nq/2); w2++)
+            {
+                const mirp_dd Gz = mirp_G_dd(fnp[np], fnq[nq], np, nq, w1, w2, q);
+
+                /* Gxyz = Gx * Gy * Gz / 4^(u1+u2+v1+v2+w1+w2) */
+                mirp_dd Gxyz = mirp_dd_mul(Gxy, Gz);
+                Gxyz = mirp_dd_mul_2exp(Gxyz, -2*(u1 + u2 + v1 + v2 + w1 + w2));
+
+                mirp_dd block = mirp_dd_set_d(0.0);
+
+                for(int tx = 0; tx <= ((lp + lq - 2 * (u1 + u2)) / 2); tx++)
+                {
+                    /* tmp4x = PQ[0]^xfac / (xfac! * tx!) */
+                    const int xfac = lp + lq - 2*(u1 + u2 + tx);
+                    const mirp_dd tmp4x = mirp_dd_mul(q->PQ_k[0][xfac], q->inv_fac[tx]);
+
+                    for(int ty = 0; ty <= ((mp + mq - 2 * (v1 + v2)) / 2); ty++)
+                    {
+                        const int yfac = mp + mq - 2*(v1 + v2 + ty);
+                        const mirp_dd tmp4y = mirp_dd_mul(q->PQ_k[1][yfac], q->inv_fac[ty]);
+                        const mirp_dd tmp4xy = mirp_dd_mul(tmp4x, tmp4y);
+
+                        for(int tz = 0; tz <= ((np + nq - 2 * (w1 + w2)) / 2); tz++)
+                        {
+                            const int zfac = np + nq - 2*(w1 + w2 + tz);
+                            const mirp_dd tmp4z = mirp_dd_mul(q->PQ_k[2][zfac], q->inv_fac[tz]);
+
+                            const int zeta = lp + lq + mp + mq + np + nq - 2*(u1 + u2 + v1 + v2 + w1 + w2) - tx - ty - tz;
+
+                            mirp_dd term = mirp_dd_mul(tmp4xy, tmp4z);
+                            term = mirp_dd_mul(term, q->gammapq_inv[tx + ty + tz]);
+                            term = mirp_dd_mul(term, q->F[zeta]);
+
+                            /* Divide by 4^(tx+ty+tz), which is exact */
+                            term = mirp_dd_mul_2exp(term, -2*(tx + ty + tz));
+
+                            if(NEG1_POW(tx+ty+tz) < 0)
+                                term = mirp_dd_neg(term);
+
+                            block = mirp_dd_add(block, term);
+                        }
+                    }
+                }
+
+                integral = mirp_dd_add(integral, mirp_dd_mul(Gxyz, block));
+            }
+        }
+    }
+
+    return integral;
+}
+
+
+/*! \brief Computes a single cartesian GTO electron repulsion integral
+ *         from double-double inputs
+ */
+static mirp_dd mirp_gtoeri_single_dd_core(const int * lmn1, const mirp_dd * A, mirp_dd alpha1,
+                                          const int * lmn2, const mirp_dd * B, mirp_dd alpha2,
+                                          const int * lmn3, const mirp_dd * C, mirp_dd alpha3,
+                                          const int * lmn4, const mirp_dd * D, mirp_dd alpha4)
+{
+    const int L = lmn1[0]+lmn1[1]+lmn1[2] + lmn2[0]+lmn2[1]+lmn2[2]
+                + lmn3[0]+lmn3[1]+lmn3[2] + lmn4[0]+lmn4[1]+lmn4[2];
+
+    /* Gaussian Product Theorem */
+    mirp_dd P[3], PA[3], PB[3], Q[3], QC[3], QD[3], PQ[3];
+    mirp_dd gammap, gammaq, AB2, CD2;
+
+    mirp_gpt_dd(alpha1, alpha2, A, B, &gammap, P, PA, PB, &AB2);
+    mirp_gpt_dd(alpha3, alpha4, C, D, &gammaq, Q, QC, QD, &CD2);
+
+    /* gammapq = gammap * gammaq / (gammap + gammaq) */
+    const mirp_dd gammapq = mirp_dd_div(mirp_dd_mul(gammap, gammaq), mirp_dd_add(gammap, gammaq));
+
+    mirp_dd PQ2 = mirp_dd_set_d(0.0);
+    for(int x = 0; x < 3; x++)
+    {
+        PQ[x] = mirp_dd_sub(P[x], Q[x]);
+        PQ2 = mirp_dd_add(PQ2, mirp_dd_sqr(PQ[x]));
+    }
+
+    /* Boys function */
+    mirp_dd F[L+1];
+    mirp_boys_dd(F, L, mirp_dd_mul(PQ2, gammapq));
+
+    /* Factorials */
+    mirp_dd fac[L+1], inv_fac[L+1];
+    fac[0] = mirp_dd_set_d(1.0);
+    for(int i = 1; i <= L; i++)
+        fac[i] = mirp_dd_mul_d(fac[i-1], i);
+    for(int i = 0; i <= L; i++)
+        inv_fac[i] = mirp_dd_div(mirp_dd_set_d(1.0), fac[i]);
+
+    /* Powers used in the f-arrays and the sums */
+    mirp_dd PA_pow[3][L+1], PB_pow[3][L+1], QC_pow[3][L+1], QD_pow[3][L+1], PQ_k[3][L+1];
+
+    for(int x = 0; x < 3; x++)
+    {
+        mirp_pow_vec_dd(PA_pow[x], PA[x], L);
+        mirp_pow_vec_dd(PB_pow[x], PB[x], L);
+        mirp_pow_vec_dd(QC_pow[x], QC[x], L);
+        mirp_pow_vec_dd(QD_pow[x], QD[x], L);
+
+        /* PQ_k[x][k] = PQ[x]^k / k! */
+        mirp_pow_vec_dd(PQ_k[x], PQ[x], L);
+        for(int k = 2; k <= L; k++)
+            PQ_k[x][k] = mirp_dd_mul(PQ_k[x][k], inv_fac[k]);
+    }
+
+    const mirp_dd one = mirp_dd_set_d(1.0);
+    mirp_dd gammap_inv[L+1], gammaq_inv[L+1], gammapq_pow[L+1], gammapq_inv[L+1];
+    mirp_pow_vec_dd(gammap_inv, mirp_dd_div(one, gammap), L);
+    mirp_pow_vec_dd(gammaq_inv, mirp_dd_div(one, gammaq), L);
+    mirp_pow_vec_dd(gammapq_pow, gammapq, L);
+    mirp_pow_vec_dd(gammapq_inv, mirp_dd_div(one, gammapq), L);
+
+    const mirp_gtoeri_dd_quartet q = { fac, inv_fac, F,
+                                       { PQ_k[0], PQ_k[1], PQ_k[2] },
+                                       gammap_inv, gammaq_inv, gammapq_pow, gammapq_inv };
+
+    /* f-arrays */
+    mirp_dd flp[lmn1[0]+lmn2[0]+1];
+    mirp_dd fmp[lmn1[1]+lmn2[1]+1];
+    mirp_dd fnp[lmn1[2]+lmn2[2]+1];
+    mirp_dd flq[lmn3[0]+lmn4[0]+1];
+    mirp_dd fmq[lmn3[1]+lmn4[1]+1];
+    mirp_dd fnq[lmn3[2]+lmn4[2]+1];
+
+    mirp_farr_dd(flp, lmn1[0], lmn2[0], PA_pow[0], PB_pow[0]);
+    mirp_farr_dd(fmp, lmn1[1], lmn2[1], PA_pow[1], PB_pow[1]);
+    mirp_farr_dd(fnp, lmn1[2], lmn2[2], PA_pow[2], PB_pow[2]);
+    mirp_farr_dd(flq, lmn3[0], lmn4[0], QC_pow[0], QD_pow[0]);
+    mirp_farr_dd(fmq, lmn3[1], lmn4[1], QC_pow[1], QD_pow[1]);
+    mirp_farr_dd(fnq, lmn3[2], lmn4[2], QC_pow[2], QD_pow[2]);
+
+    const mirp_dd sum = mirp_gtoeri_sum_dd(lmn1[0]+lmn2[0], lmn1[1]+lmn2[1], lmn1[2]+lmn2[2],
+                                           lmn3[0]+lmn4[0], lmn3[1]+lmn4[1], lmn3[2]+lmn4[2],
+                                           flp, fmp, fnp, flq, fmq, fnq, &q);
+
+    /* Prefactor
+     *
+     * 2 * pi**2.5 * K1 * K2 / (gammap * gammaq * sqrt(gammap + gammaq))
+     *
+     * with K1 = exp(-alpha1 * alpha2 * AB2 / gammap) (and similar for K2).
+     */
+    const mirp_dd pi = mirp_dd_const_pi();
+    mirp_dd pfac = mirp_dd_mul_2exp(mirp_dd_mul(mirp_dd_sqr(pi), mirp_dd_sqrt(pi)), 1);
+
+    const mirp_dd K1 = mirp_dd_exp(mirp_dd_neg(mirp_dd_div(mirp_dd_mul(mirp_dd_mul(alpha1, alpha2), AB2), gammap)));
+    const mirp_dd K2 = mirp_dd_exp(mirp_dd_neg(mirp_dd_div(mirp_dd_mul(mirp_dd_mul(alpha3, alpha4), CD2), gammaq)));
+    pfac = mirp_dd_mul(pfac, mirp_dd_mul(K1, K2));
+
+    mirp_dd denom = mirp_dd_sqrt(mirp_dd_add(gammap, gammaq));
+    denom = mirp_dd_mul(denom, mirp_dd_mul(gammap, gammaq));
+    pfac = mirp_dd_div(pfac, denom);
+
+    return mirp_dd_mul(sum, pfac);
+}
+
+
+void mirp_gtoeri_single_dd(arb_t integral,
+                           const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                           const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                           const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                           const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                           slong working_prec)
+{
+    assert(lmn1[0] >= 0); assert(lmn1[1] >= 0); assert(lmn1[2] >= 0);
+    assert(lmn2[0] >= 0); assert(lmn2[1] >= 0); assert(lmn2[2] >= 0);
+    assert(lmn3[0] >= 0); assert(lmn3[1] >= 0); assert(lmn3[2] >= 0);
+    assert(lmn4[0] >= 0); assert(lmn4[1] >= 0); assert(lmn4[2] >= 0);
+
+    mirp_dd A_dd[3], B_dd[3], C_dd[3], D_dd[3];
+    mirp_dd alpha1_dd, alpha2_dd, alpha3_dd, alpha4_dd;
+
+    /* Inputs that are not exactly doubles are
+     * handled by the interval arithmetic kernel */
+    int exact = mirp_dd_set_arb(&alpha1_dd, alpha1) &&
+                mirp_dd_set_arb(&alpha2_dd, alpha2) &&
+                mirp_dd_set_arb(&alpha3_dd, alpha3) &&
+                mirp_dd_set_arb(&alpha4_dd, alpha4);
+
+    for(int x = 0; x < 3 && exact; x++)
+    {
+        exact = mirp_dd_set_arb(A_dd + x, A + x) &&
+                mirp_dd_set_arb(B_dd + x, B + x) &&
+                mirp_dd_set_arb(C_dd + x, C + x) &&
+                mirp_dd_set_arb(D_dd + x, D + x);
+    }
+
+    if(!exact)
+    {
+        mirp_gtoeri_single(integral,
+                           lmn1, A, alpha1,
+                           lmn2, B, alpha2,
+                           lmn3, C, alpha3,
+                           lmn4, D, alpha4,
+                           working_prec);
+        return;
+    }
+
+    const mirp_dd result = mirp_gtoeri_single_dd_core(lmn1, A_dd, alpha1_dd,
+                                                      lmn2, B_dd, alpha2_dd,
+                                                      lmn3, C_dd, alpha3_dd,
+                                                      lmn4, D_dd, alpha4_dd);
+    mirp_dd_get_arb(integral, result);
+}
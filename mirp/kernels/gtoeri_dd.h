@@ -0,0 +1,42 @@
+/*! \file
+ *
+ * \brief Kernel for electron repulsion integrals of gaussian orbitals
+ *        in double-double arithmetic
+ *
+ * The results carry rigorous error bounds, like the interval arithmetic
+ * kernels, but are limited to roughly 100 bits. They are used as
+ * an intermediate step of the exact functions, between the low-precision
+ * fast path and interval arithmetic at higher precision
+ * (see \ref mirp_integral4_exact_fast).
+ */
+
+#pragma once
+
+#include <arb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Computes a single cartesian GTO electron repulsion integral
+ *         (double-double arithmetic)
+ *
+ * The inputs are expected to be exactly representable as doubles, as is
+ * the case in the exact functions. If they are not, the integral is computed
+ * by \ref mirp_gtoeri_single at \p working_prec instead.
+ *
+ * The result is converted to an arb_t, with the accumulated error bound
+ * as its radius.
+ *
+ * \copydetails mirp_gtoeri_single
+ */
+void mirp_gtoeri_single_dd(arb_t integral,
+                           const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                           const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                           const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                           const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                           slong working_prec);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,562 @@
+/*! \file
+ *
+ * \brief Kernel for electron repulsion integrals of gaussian orbitals
+ *        using the Head-Gordon-Pople recurrence relations
+ */
+
+
+
+/***********************************************************
+ * The integrals are built in two steps:
+ *
+ * 1. The Obara-Saika vertical recurrence relation (VRR)
+ *    builds [e0|f0]^(m) from the Boys function
+ *    (Obara & Saika, J. Chem. Phys. 84, 3963 (1986))
+ *
+ * 2. The horizontal recurrence relation (HRR) moves angular
+ *    momentum from the first to the second center of each pair
+ *    (Head-Gordon & Pople, J. Chem. Phys. 89, 5777 (1988))
+***********************************************************/
+
+#include "mirp/kernels/boys.h"
+#include "mirp/kernels/gtoeri_hgp.h"
+#include "mirp/math.h"
+#include "mirp/gpt.h"
+#include "mirp/shell.h"
+#include "mirp/pragma.h"
+#include <assert.h>
+
+
+/*! \brief Index of a cartesian function within its shell
+ *         (in the MIRP ordering)
+ */
+static long mirp_hgp_cartidx(const int * lmn)
+{
+    const int lx = lmn[1] + lmn[2];
+    return (lx*(lx+1))/2 + lmn[2];
+}
+
+
+/*! \brief Direction (x=0, y=1, z=2) used to build a function
+ *         via a recurrence relation
+ */
+static int mirp_hgp_direction(const int * lmn)
+{
+    if(lmn[0] > 0)
+        return 0;
+    else if(lmn[1] > 0)
+        return 1;
+    else
+        return 2;
+}
+
+
+/*! \brief Terms of a primitive quartet used in the VRR */
+typedef struct
+{
+    int L;            //!< Total angular momentum of the quartet
+    arb_ptr PA;       //!< P - A (length 3)
+    arb_ptr QC;       //!< Q - C (length 3)
+    arb_ptr WP;       //!< W - P (length 3)
+    arb_ptr WQ;       //!< W - Q (length 3)
+    arb_t oo2p;       //!< 1/(2*gammap)
+    arb_t oo2q;       //!< 1/(2*gammaq)
+    arb_t oo2pq;      //!< 1/(2*(gammap + gammaq))
+    arb_t rho_p;      //!< gammapq / gammap
+    arb_t rho_q;      //!< gammapq / gammaq
+} mirp_hgp_quartet;
+
+
+/* Number of m values stored for [e0|f0]^(m) */
+#define MIRP_HGP_NM(L, e, f) ((L) - (e) - (f) + 1)
+
+
+/*! \brief Obtain a pointer to [e0|f0]^(m) within the VRR storage */
+static arb_ptr mirp_hgp_vrr_ptr(arb_ptr const * vrr, int nf_am, const mirp_hgp_quartet * q,
+                                int e, int f, long ie, long jf, int m)
+{
+    const long nm = MIRP_HGP_NM(q->L, e, f);
+    return vrr[e*nf_am + f] + (ie*MIRP_NCART(f) + jf)*nm + m;
+}
+
+
+/*! \brief Builds [00|f0]^(m) from [00|(f-1)0]^(m) and [00|(f-2)0]^(m) */
+static void mirp_hgp_vrr_ket(arb_ptr const * vrr, int nf_am, int f,
+                             const mirp_hgp_quartet * q, slong working_prec)
+{
+    const long ncart_f = MIRP_NCART(f);
+    const int nm = MIRP_HGP_NM(q->L, 0, f);
+
+    int lmn_f[ncart_f][3];
+    mirp_gaussian_fill_lmn(f, (int *)lmn_f);
+
+    arb_t tmp;
+    arb_init(tmp);
+
+    for(long jf = 0; jf < ncart_f; jf++)
+    {
+        const int i = mirp_hgp_direction(lmn_f[jf]);
+
+        int fm1[3] = { lmn_f[jf][0], lmn_f[jf][1], lmn_f[jf][2] };
+        fm1[i]--;
+        const int c_i = fm1[i];
+        const long jfm1 = mirp_hgp_cartidx(fm1);
+
+        for(int m = 0; m < nm; m++)
+        {
+            arb_ptr dst = mirp_hgp_vrr_ptr(vrr, nf_am, q, 0, f, 0, jf, m);
+            arb_srcptr src1 = mirp_hgp_vrr_ptr(vrr, nf_am, q, 0, f-1, 0, jfm1, m);
+
+            /* QC_i [00|(f-1)0]^(m) + WQ_i [00|(f-1)0]^(m+1) */
+            arb_mul(dst, q->QC+i, src1, working_prec);
+            arb_addmul(dst, q->WQ+i, src1+1, working_prec);
+
+            if(c_i > 0)
+            {
+                int fm2[3] = { fm1[0], fm1[1], fm1[2] };
+                fm2[i]--;
+                arb_srcptr src2 = mirp_hgp_vrr_ptr(vrr, nf_am, q, 0, f-2, 0, mirp_hgp_cartidx(fm2), m);
+
+                /* c_i/(2q) * ([00|(f-2)0]^(m) - rho/q [00|(f-2)0]^(m+1)) */
+                arb_mul(tmp, q->rho_q, src2+1, working_prec);
+                arb_sub(tmp, src2, tmp, working_prec);
+                arb_mul(tmp, tmp, q->oo2q, working_prec);
+                arb_mul_si(tmp, tmp, c_i, working_prec);
+                arb_add(dst, dst, tmp, working_prec);
+            }
+        }
+    }
+
+    arb_clear(tmp);
+}
+
+
+/*! \brief Builds [e0|f0]^(m) from lower values of e (and f) */
+static void mirp_hgp_vrr_bra(arb_ptr const * vrr, int nf_am, int e, int f,
+                             const mirp_hgp_quartet * q, slong working_prec)
+{
+    const long ncart_e = MIRP_NCART(e);
+    const long ncart_f = MIRP_NCART(f);
+    const int nm = MIRP_HGP_NM(q->L, e, f);
+
+    int lmn_e[ncart_e][3];
+    int lmn_f[ncart_f][3];
+    mirp_gaussian_fill_lmn(e, (int *)lmn_e);
+    mirp_gaussian_fill_lmn(f, (int *)lmn_f);
+
+    arb_t tmp;
+    arb_init(tmp);
+
+    for(long ie = 0; ie < ncart_e; ie++)
+    {
+        const int i = mirp_hgp_direction(lmn_e[ie]);
+
+        int em1[3] = { lmn_e[ie][0], lmn_e[ie][1], lmn_e[ie][2] };
+        em1[i]--;
+        const int a_i = em1[i];
+        const long iem1 = mirp_hgp_cartidx(em1);
+
+        long iem2 = 0;
+        if(a_i > 0)
+        {
+            int em2[3] = { em1[0], em1[1], em1[2] };
+            em2[i]--;
+            iem2 = mirp_hgp_cartidx(em2);
+        }
+
+        for(long jf = 0; jf < ncart_f; jf++)
+        {
+            const int c_i = lmn_f[jf][i];
+
+            long jfm1 = 0;
+            if(c_i > 0)
+            {
+                int fm1[3] = { lmn_f[jf][0], lmn_f[jf][1], lmn_f[jf][2] };
+                fm1[i]--;
+                jfm1 = mirp_hgp_cartidx(fm1);
+            }
+
+            for(int m = 0; m < nm; m++)
+            {
+                arb_ptr dst = mirp_hgp_vrr_ptr(vrr, nf_am, q, e, f, ie, jf, m);
+                arb_srcptr src1 = mirp_hgp_vrr_ptr(vrr, nf_am, q, e-1, f, iem1, jf, m);
+
+                /* PA_i [(e-1)0|f0]^(m) + WP_i [(e-1)0|f0]^(m+1) */
+                arb_mul(dst, q->PA+i, src1, working_prec);
+                arb_addmul(dst, q->WP+i, src1+1, working_prec);
+
+                if(a_i > 0)
+                {
+                    arb_srcptr src2 = mirp_hgp_vrr_ptr(vrr, nf_am, q, e-2, f, iem2, jf, m);
+
+                    /* a_i/(2p) * ([(e-2)0|f0]^(m) - rho/p [(e-2)0|f0]^(m+1)) */
+                    arb_mul(tmp, q->rho_p, src2+1, working_prec);
+                    arb_sub(tmp, src2, tmp, working_prec);
+                    arb_mul(tmp, tmp, q->oo2p, working_prec);
+                    arb_mul_si(tmp, tmp, a_i, working_prec);
+                    arb_add(dst, dst, tmp, working_prec);
+                }
+
+                if(c_i > 0)
+                {
+                    arb_srcptr src3 = mirp_hgp_vrr_ptr(vrr, nf_am, q, e-1, f-1, iem1, jfm1, m+1);
+
+                    /* c_i/(2(p+q)) * [(e-1)0|(f-1)0]^(m+1) */
+                    arb_mul(tmp, src3, q->oo2pq, working_prec);
+                    arb_mul_si(tmp, tmp, c_i, working_prec);
+                    arb_add(dst, dst, tmp, working_prec);
+                }
+            }
+        }
+    }
+
+    arb_clear(tmp);
+}
+
+
+/*! \brief Applies the horizontal recurrence relation to one pair
+ *
+ * The HRR is (a,b+1_i) = (a+1_i,b) + AB_i (a,b), and does not depend on
+ * the other pair. The other pair is carried along as an additional,
+ * slowest-running index k (of length \p nother).
+ *
+ * \param [out] out    Integrals (a,b) for am1 = \p l1 and am2 = \p l2,
+ *                     in the layout [k][ia][ib]
+ * \param [in]  in     Integrals (e,0) for e = \p l1 to \p l1 + \p l2,
+ *                     in the layout [k][ie]. Element in[e-l1] is for
+ *                     angular momentum e.
+ * \param [in]  AB     Difference between the two centers (length 3)
+ */
+static void mirp_hgp_hrr(arb_ptr out, int l1, int l2, arb_ptr const * in,
+                         arb_srcptr AB, long nother, slong working_prec)
+{
+    /* T[b][a-l1] holds (a,b), for b = 0..l2 and a = l1..l1+l2-b */
+    arb_ptr T[l2+1][l2+1];
+
+    if(l2 == 0)
+    {
+        _arb_vec_set(out, in[0], nother*MIRP_NCART(l1));
+        return;
+    }
+
+    for(int a = l1; a <= l1+l2; a++)
+        T[0][a-l1] = in[a-l1];
+
+    for(int b = 1; b <= l2; b++)
+    {
+        const long ncart_b = MIRP_NCART(b);
+        const long ncart_bm1 = MIRP_NCART(b-1);
+
+        int lmn_b[ncart_b][3];
+        mirp_gaussian_fill_lmn(b, (int *)lmn_b);
+
+        for(int a = l1; a <= l1+l2-b; a++)
+        {
+            const long ncart_a = MIRP_NCART(a);
+            const long ncart_ap1 = MIRP_NCART(a+1);
+
+            int lmn_a[ncart_a][3];
+            mirp_gaussian_fill_lmn(a, (int *)lmn_a);
+
+            if(b == l2)
+                T[b][a-l1] = out;
+            else
+                T[b][a-l1] = _arb_vec_init(nother*ncart_a*ncart_b);
+
+            arb_srcptr Tap1_bm1 = T[b-1][a+1-l1];
+            arb_srcptr Ta_bm1 = T[b-1][a-l1];
+            arb_ptr Ta_b = T[b][a-l1];
+
+            for(long ib = 0; ib < ncart_b; ib++)
+            {
+                const int i = mirp_hgp_direction(lmn_b[ib]);
+
+                int bm1[3] = { lmn_b[ib][0], lmn_b[ib][1], lmn_b[ib][2] };
+                bm1[i]--;
+                const long ibm1 = mirp_hgp_cartidx(bm1);
+
+                for(long ia = 0; ia < ncart_a; ia++)
+                {
+                    int ap1[3] = { lmn_a[ia][0], lmn_a[ia][1], lmn_a[ia][2] };
+                    ap1[i]++;
+                    const long iap1 = mirp_hgp_cartidx(ap1);
+
+                    for(long k = 0; k < nother; k++)
+                    {
+                        arb_ptr dst = Ta_b + (k*ncart_a + ia)*ncart_b + ib;
+                        arb_srcptr src1 = Tap1_bm1 + (k*ncart_ap1 + iap1)*ncart_bm1 + ibm1;
+                        arb_srcptr src2 = Ta_bm1 + (k*ncart_a + ia)*ncart_bm1 + ibm1;
+
+                        arb_mul(dst, AB+i, src2, working_prec);
+                        arb_add(dst, dst, src1, working_prec);
+                    }
+                }
+            }
+        }
+
+        /* The previous level is no longer needed
+         * (level 0 belongs to the caller) */
+        if(b > 1)
+        {
+            for(int a = l1; a <= l1+l2-(b-1); a++)
+                _arb_vec_clear(T[b-1][a-l1], nother*MIRP_NCART(a)*MIRP_NCART(b-1));
+        }
+    }
+}
+
+
+void mirp_gtoeri_hgp_prim(arb_ptr integrals,
+                          int am1, arb_srcptr A, const arb_t alpha1,
+                          int am2, arb_srcptr B, const arb_t alpha2,
+                          int am3, arb_srcptr C, const arb_t alpha3,
+                          int am4, arb_srcptr D, const arb_t alpha4,
+                          slong working_prec)
+{
+    assert(am1 >= 0);
+    assert(am2 >= 0);
+    assert(am3 >= 0);
+    assert(am4 >= 0);
+
+    const int L = am1 + am2 + am3 + am4;
+    const int Le = am1 + am2;  /* Maximum am of the bra in the VRR */
+    const int Lf = am3 + am4;  /* Maximum am of the ket in the VRR */
+    const int nf_am = Lf + 1;
+
+    const long ncart1 = MIRP_NCART(am1);
+    const long ncart2 = MIRP_NCART(am2);
+    const long ncart12 = ncart1 * ncart2;
+
+    mirp_hgp_quartet q;
+    q.L = L;
+    q.PA = _arb_vec_init(3);
+    q.QC = _arb_vec_init(3);
+    q.WP = _arb_vec_init(3);
+    q.WQ = _arb_vec_init(3);
+    arb_init(q.oo2p);
+    arb_init(q.oo2q);
+    arb_init(q.oo2pq);
+    arb_init(q.rho_p);
+    arb_init(q.rho_q);
+
+    /* Temporary variables used in constructing expressions */
+    arb_t tmp1, tmp2;
+    arb_init(tmp1);
+    arb_init(tmp2);
+
+    /*************************************************
+     * Calculate all the various terms from the GPT
+     *************************************************/
+    arb_ptr P  = _arb_vec_init(3);
+    arb_ptr PB = _arb_vec_init(3);
+    arb_ptr Q  = _arb_vec_init(3);
+    arb_ptr QD = _arb_vec_init(3);
+    arb_ptr PQ = _arb_vec_init(3);
+    arb_ptr AB = _arb_vec_init(3);
+    arb_ptr CD = _arb_vec_init(3);
+
+    arb_t gammap, gammaq, gammapq, gammap_q;
+    arb_t AB2, CD2, PQ2;
+    arb_init(gammap);
+    arb_init(gammaq);
+    arb_init(gammapq);
+    arb_init(gammap_q);
+    arb_init(AB2);
+    arb_init(CD2);
+    arb_init(PQ2);
+
+    mirp_gpt(alpha1, alpha2, A, B, gammap, P, q.PA, PB, AB2, working_prec);
+    mirp_gpt(alpha3, alpha4, C, D, gammaq, Q, q.QC, QD, CD2, working_prec);
+
+    /*
+     * gammap_q = gammap + gammaq
+     * gammapq = gammap * gammaq / (gammap + gammaq)
+     */
+    arb_add(gammap_q, gammap, gammaq, working_prec);
+    arb_mul(gammapq, gammap, gammaq, working_prec);
+    arb_div(gammapq, gammapq, gammap_q, working_prec);
+
+    /*
+     * PQ = P - Q
+     * W = (gammap * P + gammaq * Q) / (gammap + gammaq), so
+     * WP = W - P = -gammaq/(gammap + gammaq) * PQ
+     * WQ = W - Q =  gammap/(gammap + gammaq) * PQ
+     */
+    arb_div(tmp1, gammaq, gammap_q, working_prec);
+    arb_neg(tmp1, tmp1);
+    arb_div(tmp2, gammap, gammap_q, working_prec);
+
+    for(int i = 0; i < 3; i++)
+    {
+        arb_sub(PQ+i, P+i, Q+i, working_prec);
+        arb_mul(q.WP+i, PQ+i, tmp1, working_prec);
+        arb_mul(q.WQ+i, PQ+i, tmp2, working_prec);
+        arb_sub(AB+i, A+i, B+i, working_prec);
+        arb_sub(CD+i, C+i, D+i, working_prec);
+    }
+
+    arb_mul(PQ2, PQ+0, PQ+0, working_prec);
+    arb_addmul(PQ2, PQ+1, PQ+1, working_prec);
+    arb_addmul(PQ2, PQ+2, PQ+2, working_prec);
+
+    /* Coefficients used in the VRR */
+    arb_mul_2exp_si(tmp1, gammap, 1);
+    arb_inv(q.oo2p, tmp1, working_prec);
+    arb_mul_2exp_si(tmp1, gammaq, 1);
+    arb_inv(q.oo2q, tmp1, working_prec);
+    arb_mul_2exp_si(tmp1, gammap_q, 1);
+    arb_inv(q.oo2pq, tmp1, working_prec);
+    arb_div(q.rho_p, gammapq, gammap, working_prec);
+    arb_div(q.rho_q, gammapq, gammaq, working_prec);
+
+
+    /*************************************************
+     * VRR storage
+     * vrr[e*nf_am + f] holds [e0|f0]^(m), in the layout [ie][jf][m]
+     *************************************************/
+    arb_ptr vrr[(Le+1)*nf_am];
+    for(int e = 0; e <= Le; e++)
+    for(int f = 0; f <= Lf; f++)
+        vrr[e*nf_am + f] = _arb_vec_init(MIRP_NCART(e)*MIRP_NCART(f)*MIRP_HGP_NM(L, e, f));
+
+
+    /*
+     * [00|00]^(m) = pfac * F_m(gammapq * PQ2)
+     */
+    arb_ptr ssss = vrr[0];
+    arb_mul(tmp1, PQ2, gammapq, working_prec);
+    mirp_boys(ssss, L, tmp1, working_prec);
+
+    /* Calculate the prefactor
+     *
+     * start with pfac = 2 * pi**2.5
+     */
+    arb_t pfac;
+    arb_init(pfac);
+    arb_const_pi(pfac, working_prec);
+    arb_pow_ui(pfac, pfac, 5, working_prec);
+    arb_sqrt(pfac, pfac, working_prec);
+    arb_mul_ui(pfac, pfac, 2, working_prec);
+
+    /*
+     * Now multiply by K1 and K2
+     * K1 = exp(-alpha1 * alpha2 * AB2 / gammap);
+     * K2 = exp(-alpha3 * alpha4 * CD2 / gammaq);
+     */
+    arb_mul(tmp2, alpha1, alpha2, working_prec);
+    arb_mul(tmp2, tmp2, AB2, working_prec);
+    arb_div(tmp2, tmp2, gammap, working_prec);
+    arb_neg(tmp2, tmp2);
+    arb_exp(tmp2, tmp2, working_prec);
+    arb_mul(pfac, pfac, tmp2, working_prec);
+
+    arb_mul(tmp2, alpha3, alpha4, working_prec);
+    arb_mul(tmp2, tmp2, CD2, working_prec);
+    arb_div(tmp2, tmp2, gammaq, working_prec);
+    arb_neg(tmp2, tmp2);
+    arb_exp(tmp2, tmp2, working_prec);
+    arb_mul(pfac, pfac, tmp2, working_prec);
+
+    /*
+     * divide by (gammap * gammaq * sqrt(gammap + gammaq))
+     */
+    arb_sqrt(tmp2, gammap_q, working_prec);
+    arb_mul(tmp2, tmp2, gammap, working_prec);
+    arb_mul(tmp2, tmp2, gammaq, working_prec);
+    arb_div(pfac, pfac, tmp2, working_prec);
+
+    _arb_vec_scalar_mul(ssss, ssss, L+1, pfac, working_prec);
+
+
+    /*************************************************
+     * Vertical recurrence
+     *************************************************/
+    for(int f = 1; f <= Lf; f++)
+        mirp_hgp_vrr_ket(vrr, nf_am, f, &q, working_prec);
+
+    for(int e = 1; e <= Le; e++)
+    for(int f = 0; f <= Lf; f++)
+        mirp_hgp_vrr_bra(vrr, nf_am, e, f, &q, working_prec);
+
+
+    /*************************************************
+     * Horizontal recurrence
+     *
+     * First on the bra, for every (f0| that is needed
+     * by the HRR on the ket. Then on the ket.
+     *************************************************/
+    arb_ptr ket_in[Lf-am3+1];
+
+    for(int f = am3; f <= Lf; f++)
+    {
+        const long ncart_f = MIRP_NCART(f);
+
+        /* Rearrange [e0|f0]^(0) into the layout [jf][ie] */
+        arb_ptr bra_in[Le-am1+1];
+        for(int e = am1; e <= Le; e++)
+        {
+            const long ncart_e = MIRP_NCART(e);
+            bra_in[e-am1] = _arb_vec_init(ncart_f*ncart_e);
+
+            for(long jf = 0; jf < ncart_f; jf++)
+            for(long ie = 0; ie < ncart_e; ie++)
+                arb_swap(bra_in[e-am1] + jf*ncart_e + ie,
+                         mirp_hgp_vrr_ptr(vrr, nf_am, &q, e, f, ie, jf, 0));
+        }
+
+        /* bra_out is in the layout [jf][ia][ib] */
+        arb_ptr bra_out = _arb_vec_init(ncart_f*ncart12);
+        mirp_hgp_hrr(bra_out, am1, am2, bra_in, AB, ncart_f, working_prec);
+
+        /* Rearrange into the layout [iab][jf] for the ket HRR */
+        ket_in[f-am3] = _arb_vec_init(ncart12*ncart_f);
+        for(long iab = 0; iab < ncart12; iab++)
+        for(long jf = 0; jf < ncart_f; jf++)
+            arb_swap(ket_in[f-am3] + iab*ncart_f + jf,
+                     bra_out + jf*ncart12 + iab);
+
+        for(int e = am1; e <= Le; e++)
+            _arb_vec_clear(bra_in[e-am1], ncart_f*MIRP_NCART(e));
+        _arb_vec_clear(bra_out, ncart_f*ncart12);
+    }
+
+    /* The output is in the layout [ia][ib][ic][id], which is the
+     * ordering expected of the integrals */
+    mirp_hgp_hrr(integrals, am3, am4, ket_in, CD, ncart12, working_prec);
+
+
+    /* cleanup */
+    for(int f = am3; f <= Lf; f++)
+        _arb_vec_clear(ket_in[f-am3], ncart12*MIRP_NCART(f));
+
+    for(int e = 0; e <= Le; e++)
+    for(int f = 0; f <= Lf; f++)
+        _arb_vec_clear(vrr[e*nf_am + f], MIRP_NCART(e)*MIRP_NCART(f)*MIRP_HGP_NM(L, e, f));
+
+    _arb_vec_clear(q.PA, 3);
+    _arb_vec_clear(q.QC, 3);
+    _arb_vec_clear(q.WP, 3);
+    _arb_vec_clear(q.WQ, 3);
+    arb_clear(q.oo2p);
+    arb_clear(q.oo2q);
+    arb_clear(q.oo2pq);
+    arb_clear(q.rho_p);
+    arb_clear(q.rho_q);
+
+    _arb_vec_clear(P,  3);
+    _arb_vec_clear(PB, 3);
+    _arb_vec_clear(Q,  3);
+    _arb_vec_clear(QD, 3);
+    _arb_vec_clear(PQ, 3);
+    _arb_vec_clear(AB, 3);
+    _arb_vec_clear(CD, 3);
+    arb_clear(gammap);
+    arb_clear(gammaq);
+    arb_clear(gammapq);
+    arb_clear(gammap_q);
+    arb_clear(AB2);
+    arb_clear(CD2);
+    arb_clear(PQ2);
+    arb_clear(pfac);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+}
@@ -0,0 +1,109 @@
+/*! \file
+ *
+ * \brief Kernel for electron repulsion integrals of gaussian orbitals
+ *        using the Head-Gordon-Pople recurrence relations
+ */
+
+#pragma once
+
+#include <arb.h>
+#include "mirp/kernels/integral4_wrappers.h"
+#include "mirp/kernels/gtoeri_bound.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \brief Computes all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet using recurrence relations
+ *         (interval arithmetic)
+ *
+ * The integrals are built with the Obara-Saika vertical recurrence
+ * relation (VRR) and then the Head-Gordon-Pople horizontal recurrence
+ * relation (HRR). The results are the same as \ref mirp_gtoeri_prim,
+ * but the cost grows much more slowly with angular momentum.
+ *
+ * The \p integrals buffer must be able to hold
+ * ncart(am1) * ncart(am2) * ncart(am3) * ncart(am4) elements.
+ *
+ * \param [out] integrals
+ *              Resulting integrals
+ * \param [in]  am1,am2,am3,am4
+ *              Angular momentum of the four centers
+ * \param [in]  A,B,C,D
+ *              XYZ coordinates of the four centers (each of length 3)
+ * \param [in]  alpha1,alpha2,alpha3,alpha4
+ *              Exponents of the gaussian on the four centers
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+void mirp_gtoeri_hgp_prim(arb_ptr integrals,
+                          int am1, arb_srcptr A, const arb_t alpha1,
+                          int am2, arb_srcptr B, const arb_t alpha2,
+                          int am3, arb_srcptr C, const arb_t alpha3,
+                          int am4, arb_srcptr D, const arb_t alpha4,
+                          slong working_prec);
+
+
+/*! \brief Bounds all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet
+ *
+ * The bound does not depend on the method, so this is \ref mirp_gtoeri_bound.
+ */
+static inline
+double mirp_gtoeri_hgp_bound(int am1, const double * A, double alpha1,
+                             int am2, const double * B, double alpha2,
+                             int am3, const double * C, double alpha3,
+                             int am4, const double * D, double alpha4)
+{
+    return mirp_gtoeri_bound(am1, A, alpha1,
+                             am2, B, alpha2,
+                             am3, C, alpha3,
+                             am4, D, alpha4);
+}
+
+
+/*******************
+ * Wrappings
+ *******************/
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using recurrence relations (interval arithmetic)
+ *
+ * \copydetails mirp_gtoeri_exact
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+MIRP_WRAP_SHELL4(gtoeri_hgp)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using recurrence relations (string inputs)
+ *
+ * \copydetails mirp_gtoeri_hgp
+ */
+MIRP_WRAP_SHELL4_STR(gtoeri_hgp)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using recurrence relations (string inputs, target digits)
+ *
+ * \copydetails mirp_integral4_target
+ */
+MIRP_WRAP_SHELL4_TARGET(gtoeri_hgp)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using recurrence relations (exact double precision)
+ *
+ * \copydetails mirp_gtoeri_exact
+ */
+MIRP_WRAP_SHELL4_EXACT(gtoeri_hgp)
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,505 @@
+/*! \file
+ *
+ * \brief Kernel for electron repulsion integrals of gaussian orbitals
+ *        using the McMurchie-Davidson scheme
+ */
+
+
+
+/***********************************************************
+ * Each product of primitive gaussians is expanded in
+ * Hermite gaussians with coefficients E^{ij}_t, and the
+ * integral becomes
+ *
+ *   (ab|cd) = pfac * sum_{tuv} E^{ab}_{tuv}
+ *                  * sum_{TUV} (-1)^(T+U+V) E^{cd}_{TUV} R_{t+T,u+U,v+V}
+ *
+ * McMurchie & Davidson, J. Comp. Phys. 26, 218 (1978)
+ * Helgaker, Jorgensen, Olsen, "Molecular Electronic-Structure
+ * Theory", Chapter 9
+***********************************************************/
+
+#include "mirp/kernels/boys.h"
+#include "mirp/kernels/gtoeri_md.h"
+#include "mirp/math.h"
+#include "mirp/gpt.h"
+#include "mirp/shell.h"
+#include "mirp/pragma.h"
+#include <assert.h>
+
+
+/*! \brief Hermite expansion coefficients of a primitive pair */
+typedef struct
+{
+    int l1;       //!< Angular momentum of the first center
+    int l2;       //!< Angular momentum of the second center
+    arb_ptr E[3]; //!< E^{ij}_t for each direction, see \ref MIRP_MD_EIDX
+} mirp_md_pair;
+
+
+/* Index of E^{ij}_t within an mirp_md_pair */
+#define MIRP_MD_EIDX(pair, i, j, t) \
+        ((((i)*((pair)->l2+1) + (j)) * ((pair)->l1+(pair)->l2+1)) + (t))
+
+/* Number of E coefficients of an mirp_md_pair (for each direction) */
+#define MIRP_MD_NE(l1, l2) \
+        (((l1)+1) * ((l2)+1) * ((l1)+(l2)+1))
+
+
+/*! \brief Computes the Hermite expansion coefficients of a primitive pair
+ *
+ * E^{00}_0 = 1 (the exponential factor is part of the prefactor)
+ * E^{i+1,j}_t = 1/(2p) E^{ij}_{t-1} + PA E^{ij}_t + (t+1) E^{ij}_{t+1}
+ * E^{i,j+1}_t = 1/(2p) E^{ij}_{t-1} + PB E^{ij}_t + (t+1) E^{ij}_{t+1}
+ *
+ * If \p alternate is nonzero, the coefficients for odd t are negated
+ * (this is the (-1)^t factor for the ket).
+ */
+static void mirp_md_pair_init(mirp_md_pair * pair, int l1, int l2,
+                              arb_srcptr PA, arb_srcptr PB, const arb_t gamma,
+                              int alternate, slong working_prec)
+{
+    const int tmax = l1 + l2;
+    const long ne = MIRP_MD_NE(l1, l2);
+
+    pair->l1 = l1;
+    pair->l2 = l2;
+
+    arb_t oo2p, tmp;
+    arb_init(oo2p);
+    arb_init(tmp);
+
+    /* 1/(2p) */
+    arb_mul_2exp_si(tmp, gamma, 1);
+    arb_inv(oo2p, tmp, working_prec);
+
+    for(int x = 0; x < 3; x++)
+    {
+        arb_ptr E = _arb_vec_init(ne);
+        pair->E[x] = E;
+
+        arb_one(E + MIRP_MD_EIDX(pair, 0, 0, 0));
+
+        for(int i = 0; i <= l1; i++)
+        for(int j = 0; j <= l2; j++)
+        {
+            if(i == 0 && j == 0)
+                continue;
+
+            /* Build from (i-1, j) if possible, otherwise from (i, j-1) */
+            const int i0 = (i > 0) ? i-1 : i;
+            const int j0 = (i > 0) ? j : j-1;
+            arb_srcptr XA = (i > 0) ? PA + x : PB + x;
+
+            for(int t = 0; t <= i+j; t++)
+            {
+                arb_ptr dst = E + MIRP_MD_EIDX(pair, i, j, t);
+
+                if(t <= i0+j0)
+                    arb_mul(dst, XA, E + MIRP_MD_EIDX(pair, i0, j0, t), working_prec);
+                else
+                    arb_zero(dst);
+
+                if(t > 0)
+                    arb_addmul(dst, oo2p, E + MIRP_MD_EIDX(pair, i0, j0, t-1), working_prec);
+
+                if(t+1 <= i0+j0)
+                {
+                    arb_mul_si(tmp, E + MIRP_MD_EIDX(pair, i0, j0, t+1), t+1, working_prec);
+                    arb_add(dst, dst, tmp, working_prec);
+                }
+            }
+        }
+
+        if(alternate)
+        {
+            for(int i = 0; i <= l1; i++)
+            for(int j = 0; j <= l2; j++)
+            for(int t = 1; t <= tmax; t += 2)
+                arb_neg(E + MIRP_MD_EIDX(pair, i, j, t), E + MIRP_MD_EIDX(pair, i, j, t));
+        }
+    }
+
+    arb_clear(oo2p);
+    arb_clear(tmp);
+}
+
+
+/*! \brief Frees memory associated with a pair */
+static void mirp_md_pair_clear(mirp_md_pair * pair)
+{
+    for(int x = 0; x < 3; x++)
+        _arb_vec_clear(pair->E[x], MIRP_MD_NE(pair->l1, pair->l2));
+}
+
+
+/* Index of R^{(n)}_{tuv} in the table of auxiliary integrals */
+#define MIRP_MD_RIDX(n, t, u, v) \
+        ((((n)*(L+1) + (t))*(L+1) + (u))*(L+1) + (v))
+
+
+/*! \brief Computes the auxiliary Hermite integrals R_{tuv}
+ *
+ * R^{(n)}_{000} = (-2 gammapq)^n F_n(gammapq * PQ2)
+ * R^{(n)}_{t+1,u,v} = t R^{(n+1)}_{t-1,u,v} + PQ_x R^{(n+1)}_{t,u,v}
+ *
+ * (and similar for u and v). On output, R^{(0)}_{tuv} is stored at
+ * MIRP_MD_RIDX(0, t, u, v) for t+u+v <= L.
+ */
+static void mirp_md_rtuv(arb_ptr R, int L, arb_srcptr F,
+                         arb_srcptr PQ, const arb_t gammapq,
+                         slong working_prec)
+{
+    arb_t fac, tmp;
+    arb_init(fac);
+    arb_init(tmp);
+
+    /* fac = (-2 gammapq)^n */
+    arb_one(fac);
+    arb_mul_si(tmp, gammapq, -2, working_prec);
+
+    for(int n = 0; n <= L; n++)
+    {
+        arb_mul(R + MIRP_MD_RIDX(n, 0, 0, 0), F + n, fac, working_prec);
+        arb_mul(fac, fac, tmp, working_prec);
+    }
+
+    for(int tuv = 1; tuv <= L; tuv++)
+    for(int n = 0; n <= L-tuv; n++)
+    for(int t = 0; t <= tuv; t++)
+    for(int u = 0; u <= tuv-t; u++)
+    {
+        const int v = tuv - t - u;
+        arb_ptr dst = R + MIRP_MD_RIDX(n, t, u, v);
+
+        if(t > 0)
+        {
+            arb_mul(dst, PQ+0, R + MIRP_MD_RIDX(n+1, t-1, u, v), working_prec);
+            if(t > 1)
+            {
+                arb_mul_si(tmp, R + MIRP_MD_RIDX(n+1, t-2, u, v), t-1, working_prec);
+                arb_add(dst, dst, tmp, working_prec);
+            }
+        }
+        else if(u > 0)
+        {
+            arb_mul(dst, PQ+1, R + MIRP_MD_RIDX(n+1, t, u-1, v), working_prec);
+            if(u > 1)
+            {
+                arb_mul_si(tmp, R + MIRP_MD_RIDX(n+1, t, u-2, v), u-1, working_prec);
+                arb_add(dst, dst, tmp, working_prec);
+            }
+        }
+        else
+        {
+            arb_mul(dst, PQ+2, R + MIRP_MD_RIDX(n+1, t, u, v-1), working_prec);
+            if(v > 1)
+            {
+                arb_mul_si(tmp, R + MIRP_MD_RIDX(n+1, t, u, v-2), v-1, working_prec);
+                arb_add(dst, dst, tmp, working_prec);
+            }
+        }
+    }
+
+    arb_clear(fac);
+    arb_clear(tmp);
+}
+
+
+/*! \brief Computes the integrals for a list of cartesian components
+ *
+ * \p lmn1 through \p lmn4 hold the components for each center
+ * (with \p nlmn1, etc, components). The integrals are stored in the
+ * usual ordering (the component of \p lmn4 is fastest).
+ */
+static void mirp_gtoeri_md_compute(arb_ptr integrals,
+                                   long nlmn1, const int * lmn1, int am1, arb_srcptr A, const arb_t alpha1,
+                                   long nlmn2, const int * lmn2, int am2, arb_srcptr B, const arb_t alpha2,
+                                   long nlmn3, const int * lmn3, int am3, arb_srcptr C, const arb_t alpha3,
+                                   long nlmn4, const int * lmn4, int am4, arb_srcptr D, const arb_t alpha4,
+                                   slong working_prec)
+{
+    const int L = am1 + am2 + am3 + am4;
+    const int Lp = am1 + am2;
+    const long nket = nlmn3*nlmn4;
+
+    /* Size of the intermediate W array for each ket component.
+     * Indexed by t, u, v (each from 0 to Lp) */
+    const long nw = (long)(Lp+1)*(Lp+1)*(Lp+1);
+    #define MIRP_MD_WIDX(t, u, v) ((((t)*(Lp+1)) + (u))*(Lp+1) + (v))
+
+    /* Temporary variables used in constructing expressions */
+    arb_t tmp1, tmp2;
+    arb_init(tmp1);
+    arb_init(tmp2);
+
+    /*************************************************
+     * Calculate all the various terms from the GPT
+     *************************************************/
+    arb_ptr P  = _arb_vec_init(3);
+    arb_ptr PA = _arb_vec_init(3);
+    arb_ptr PB = _arb_vec_init(3);
+    arb_ptr Q  = _arb_vec_init(3);
+    arb_ptr QC = _arb_vec_init(3);
+    arb_ptr QD = _arb_vec_init(3);
+    arb_ptr PQ = _arb_vec_init(3);
+
+    arb_t gammap, gammaq, gammapq, gammap_q;
+    arb_t AB2, CD2, PQ2, pfac;
+    arb_init(gammap);
+    arb_init(gammaq);
+    arb_init(gammapq);
+    arb_init(gammap_q);
+    arb_init(AB2);
+    arb_init(CD2);
+    arb_init(PQ2);
+    arb_init(pfac);
+
+    mirp_gpt(alpha1, alpha2, A, B, gammap, P, PA, PB, AB2, working_prec);
+    mirp_gpt(alpha3, alpha4, C, D, gammaq, Q, QC, QD, CD2, working_prec);
+
+    /*
+     * gammap_q = gammap + gammaq
+     * gammapq = gammap * gammaq / (gammap + gammaq)
+     */
+    arb_add(gammap_q, gammap, gammaq, working_prec);
+    arb_mul(gammapq, gammap, gammaq, working_prec);
+    arb_div(gammapq, gammapq, gammap_q, working_prec);
+
+    arb_sub(PQ+0, P+0, Q+0, working_prec);
+    arb_sub(PQ+1, P+1, Q+1, working_prec);
+    arb_sub(PQ+2, P+2, Q+2, working_prec);
+
+    arb_mul(PQ2, PQ+0, PQ+0, working_prec);
+    arb_addmul(PQ2, PQ+1, PQ+1, working_prec);
+    arb_addmul(PQ2, PQ+2, PQ+2, working_prec);
+
+
+    /*************************************************
+     * Hermite coefficients for both pairs
+     *************************************************/
+    mirp_md_pair bra, ket;
+    mirp_md_pair_init(&bra, am1, am2, PA, PB, gammap, 0, working_prec);
+    mirp_md_pair_init(&ket, am3, am4, QC, QD, gammaq, 1, working_prec);
+
+
+    /*************************************************
+     * Auxiliary integrals
+     *************************************************/
+    const long nr = (long)(L+1)*(L+1)*(L+1)*(L+1);
+    arb_ptr F = _arb_vec_init(L+1);
+    arb_ptr R = _arb_vec_init(nr);
+
+    arb_mul(tmp1, PQ2, gammapq, working_prec);
+    mirp_boys(F, L, tmp1, working_prec);
+    mirp_md_rtuv(R, L, F, PQ, gammapq, working_prec);
+
+
+    /* Calculate the prefactor
+     *
+     * start with pfac = 2 * pi**2.5
+     */
+    arb_const_pi(pfac, working_prec);
+    arb_pow_ui(pfac, pfac, 5, working_prec);
+    arb_sqrt(pfac, pfac, working_prec);
+    arb_mul_ui(pfac, pfac, 2, working_prec);
+
+    /*
+     * Now multiply by K1 and K2
+     * K1 = exp(-alpha1 * alpha2 * AB2 / gammap);
+     * K2 = exp(-alpha3 * alpha4 * CD2 / gammaq);
+     */
+    arb_mul(tmp2, alpha1, alpha2, working_prec);
+    arb_mul(tmp2, tmp2, AB2, working_prec);
+    arb_div(tmp2, tmp2, gammap, working_prec);
+    arb_neg(tmp2, tmp2);
+    arb_exp(tmp2, tmp2, working_prec);
+    arb_mul(pfac, pfac, tmp2, working_prec);
+
+    arb_mul(tmp2, alpha3, alpha4, working_prec);
+    arb_mul(tmp2, tmp2, CD2, working_prec);
+    arb_div(tmp2, tmp2, gammaq, working_prec);
+    arb_neg(tmp2, tmp2);
+    arb_exp(tmp2, tmp2, working_prec);
+    arb_mul(pfac, pfac, tmp2, working_prec);
+
+    /*
+     * divide by (gammap * gammaq * sqrt(gammap + gammaq))
+     */
+    arb_sqrt(tmp2, gammap_q, working_prec);
+    arb_mul(tmp2, tmp2, gammap, working_prec);
+    arb_mul(tmp2, tmp2, gammaq, working_prec);
+    arb_div(pfac, pfac, tmp2, working_prec);
+
+
+    /*************************************************
+     * Contract the ket with the auxiliary integrals
+     *
+     * W^{cd}_{tuv} = sum_{TUV} (-1)^(T+U+V) E^{cd}_{TUV} R_{t+T,u+U,v+V}
+     *
+     * (The sign is already included in the ket coefficients)
+     *************************************************/
+    arb_ptr W = _arb_vec_init(nket*nw);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for collapse(2)
+    #endif
+    for(long k = 0; k < nlmn3; k++)
+    for(long l = 0; l < nlmn4; l++)
+    {
+        const int * l3 = lmn3 + 3*k;
+        const int * l4 = lmn4 + 3*l;
+        const int Tmax = l3[0] + l4[0];
+        const int Umax = l3[1] + l4[1];
+        const int Vmax = l3[2] + l4[2];
+
+        arb_ptr Wkl = W + (k*nlmn4 + l)*nw;
+
+        arb_t Ecd;
+        arb_init(Ecd);
+
+        for(int T = 0; T <= Tmax; T++)
+        for(int U = 0; U <= Umax; U++)
+        for(int V = 0; V <= Vmax; V++)
+        {
+            arb_mul(Ecd, ket.E[0] + MIRP_MD_EIDX(&ket, l3[0], l4[0], T),
+                         ket.E[1] + MIRP_MD_EIDX(&ket, l3[1], l4[1], U), working_prec);
+            arb_mul(Ecd, Ecd, ket.E[2] + MIRP_MD_EIDX(&ket, l3[2], l4[2], V), working_prec);
+
+            for(int t = 0; t <= Lp; t++)
+            for(int u = 0; u <= Lp-t; u++)
+            for(int v = 0; v <= Lp-t-u; v++)
+                arb_addmul(Wkl + MIRP_MD_WIDX(t, u, v), Ecd,
+                           R + MIRP_MD_RIDX(0, t+T, u+U, v+V), working_prec);
+        }
+
+        arb_clear(Ecd);
+    }
+
+
+    /*************************************************
+     * Contract the bra with W
+     *************************************************/
+    #ifdef _OPENMP
+    #pragma omp parallel for collapse(4)
+    #endif
+    for(long i = 0; i < nlmn1; i++)
+    for(long j = 0; j < nlmn2; j++)
+    for(long k = 0; k < nlmn3; k++)
+    for(long l = 0; l < nlmn4; l++)
+    {
+        const long idx = i*nlmn4*nlmn3*nlmn2
+                       + j*nlmn4*nlmn3
+                       + k*nlmn4
+                       + l;
+
+        const int * l1 = lmn1 + 3*i;
+        const int * l2 = lmn2 + 3*j;
+        arb_srcptr Wkl = W + (k*nlmn4 + l)*nw;
+
+        arb_t Eab;
+        arb_init(Eab);
+
+        arb_zero(integrals + idx);
+
+        for(int t = 0; t <= l1[0] + l2[0]; t++)
+        for(int u = 0; u <= l1[1] + l2[1]; u++)
+        for(int v = 0; v <= l1[2] + l2[2]; v++)
+        {
+            arb_mul(Eab, bra.E[0] + MIRP_MD_EIDX(&bra, l1[0], l2[0], t),
+                         bra.E[1] + MIRP_MD_EIDX(&bra, l1[1], l2[1], u), working_prec);
+            arb_mul(Eab, Eab, bra.E[2] + MIRP_MD_EIDX(&bra, l1[2], l2[2], v), working_prec);
+            arb_addmul(integrals + idx, Eab, Wkl + MIRP_MD_WIDX(t, u, v), working_prec);
+        }
+
+        /* apply the prefactor */
+        arb_mul(integrals + idx, integrals + idx, pfac, working_prec);
+
+        arb_clear(Eab);
+    }
+
+    #undef MIRP_MD_WIDX
+
+
+    /* cleanup */
+    mirp_md_pair_clear(&bra);
+    mirp_md_pair_clear(&ket);
+    _arb_vec_clear(F, L+1);
+    _arb_vec_clear(R, nr);
+    _arb_vec_clear(W, nket*nw);
+
+    _arb_vec_clear(P,  3);
+    _arb_vec_clear(PA, 3);
+    _arb_vec_clear(PB, 3);
+    _arb_vec_clear(Q,  3);
+    _arb_vec_clear(QC, 3);
+    _arb_vec_clear(QD, 3);
+    _arb_vec_clear(PQ, 3);
+    arb_clear(gammap);
+    arb_clear(gammaq);
+    arb_clear(gammapq);
+    arb_clear(gammap_q);
+    arb_clear(AB2);
+    arb_clear(CD2);
+    arb_clear(PQ2);
+    arb_clear(pfac);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+}
+
+
+void mirp_gtoeri_md_single(arb_t integral,
+                          const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                          const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                          const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                          const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                          slong working_prec)
+{
+    assert(lmn1[0] >= 0); assert(lmn1[1] >= 0); assert(lmn1[2] >= 0);
+    assert(lmn2[0] >= 0); assert(lmn2[1] >= 0); assert(lmn2[2] >= 0);
+    assert(lmn3[0] >= 0); assert(lmn3[1] >= 0); assert(lmn3[2] >= 0);
+    assert(lmn4[0] >= 0); assert(lmn4[1] >= 0); assert(lmn4[2] >= 0);
+
+    mirp_gtoeri_md_compute(integral,
+                           1, lmn1, lmn1[0]+lmn1[1]+lmn1[2], A, alpha1,
+                           1, lmn2, lmn2[0]+lmn2[1]+lmn2[2], B, alpha2,
+                           1, lmn3, lmn3[0]+lmn3[1]+lmn3[2], C, alpha3,
+                           1, lmn4, lmn4[0]+lmn4[1]+lmn4[2], D, alpha4,
+                           working_prec);
+}
+
+
+void mirp_gtoeri_md_prim(arb_ptr integrals,
+                        int am1, arb_srcptr A, const arb_t alpha1,
+                        int am2, arb_srcptr B, const arb_t alpha2,
+                        int am3, arb_srcptr C, const arb_t alpha3,
+                        int am4, arb_srcptr D, const arb_t alpha4,
+                        slong working_prec)
+{
+    assert(am1 >= 0);
+    assert(am2 >= 0);
+    assert(am3 >= 0);
+    assert(am4 >= 0);
+
+    const long ncart1 = MIRP_NCART(am1);
+    const long ncart2 = MIRP_NCART(am2);
+    const long ncart3 = MIRP_NCART(am3);
+    const long ncart4 = MIRP_NCART(am4);
+
+    int lmn1[ncart1][3];
+    int lmn2[ncart2][3];
+    int lmn3[ncart3][3];
+    int lmn4[ncart4][3];
+
+    mirp_gaussian_fill_lmn(am1, (int*)lmn1);
+    mirp_gaussian_fill_lmn(am2, (int*)lmn2);
+    mirp_gaussian_fill_lmn(am3, (int*)lmn3);
+    mirp_gaussian_fill_lmn(am4, (int*)lmn4);
+
+    mirp_gtoeri_md_compute(integrals,
+                           ncart1, (int*)lmn1, am1, A, alpha1,
+                           ncart2, (int*)lmn2, am2, B, alpha2,
+                           ncart3, (int*)lmn3, am3, C, alpha3,
+                           ncart4, (int*)lmn4, am4, D, alpha4,
+                           working_prec);
+}
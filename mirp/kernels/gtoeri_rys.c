@@ -0,0 +1,399 @@
+/*! \file
+ *
+ * \brief Kernel for electron repulsion integrals of gaussian orbitals
+ *        using Rys quadrature
+ */
+
+
+
+/***********************************************************
+ * The integral is written as a sum over the roots of the
+ * Rys polynomials
+ *
+ *   (ab|cd) = pfac * sum_i w_i Ix(x_i) Iy(x_i) Iz(x_i)
+ *
+ * where the two-dimensional integrals Ix, Iy, Iz are built
+ * with the recurrence relations of
+ * Rys, Dupuis, and King, J. Comp. Chem. 4, 154 (1983)
+ * followed by horizontal recurrence relations.
+ *
+ * The quadrature is exact with L/2+1 roots.
+***********************************************************/
+
+#include "mirp/kernels/rys.h"
+#include "mirp/kernels/gtoeri_rys.h"
+#include "mirp/math.h"
+#include "mirp/gpt.h"
+#include "mirp/shell.h"
+#include "mirp/pragma.h"
+#include <assert.h>
+
+
+/* Index into the table of two-dimensional integrals.
+ * Layout is [n][b][m][d], where n is the angular momentum
+ * on the first center (after the VRR, before the HRR), and similar for m */
+#define MIRP_RYS_IDX(n, b, m, d) \
+        ((((n)*(lb+1) + (b))*(Lf+1) + (m))*(ld+1) + (d))
+
+
+/*! \brief Computes the integrals for a list of cartesian components
+ *
+ * \p lmn1 through \p lmn4 hold the components for each center
+ * (with \p nlmn1, etc, components). The integrals are stored in the
+ * usual ordering (the component of \p lmn4 is fastest).
+ */
+static void mirp_gtoeri_rys_compute(arb_ptr integrals,
+                                    long nlmn1, const int * lmn1, int am1, arb_srcptr A, const arb_t alpha1,
+                                    long nlmn2, const int * lmn2, int am2, arb_srcptr B, const arb_t alpha2,
+                                    long nlmn3, const int * lmn3, int am3, arb_srcptr C, const arb_t alpha3,
+                                    long nlmn4, const int * lmn4, int am4, arb_srcptr D, const arb_t alpha4,
+                                    slong working_prec)
+{
+    const int L = am1 + am2 + am3 + am4;
+    const int nroots = L/2 + 1;
+
+    const int la = am1;
+    const int lb = am2;
+    const int lc = am3;
+    const int ld = am4;
+    const int Le = la + lb;
+    const int Lf = lc + ld;
+
+    const long ntable = (long)(Le+1)*(lb+1)*(Lf+1)*(ld+1);
+    const long nint = nlmn1*nlmn2*nlmn3*nlmn4;
+
+    _arb_vec_zero(integrals, nint);
+
+    /* Temporary variables used in constructing expressions */
+    arb_t tmp1, tmp2;
+    arb_init(tmp1);
+    arb_init(tmp2);
+
+    /*************************************************
+     * Calculate all the various terms from the GPT
+     *************************************************/
+    arb_ptr P  = _arb_vec_init(3);
+    arb_ptr PA = _arb_vec_init(3);
+    arb_ptr PB = _arb_vec_init(3);
+    arb_ptr Q  = _arb_vec_init(3);
+    arb_ptr QC = _arb_vec_init(3);
+    arb_ptr QD = _arb_vec_init(3);
+    arb_ptr PQ = _arb_vec_init(3);
+    arb_ptr AB = _arb_vec_init(3);
+    arb_ptr CD = _arb_vec_init(3);
+
+    arb_t gammap, gammaq, gammapq, gammap_q;
+    arb_t AB2, CD2, PQ2, pfac;
+    arb_init(gammap);
+    arb_init(gammaq);
+    arb_init(gammapq);
+    arb_init(gammap_q);
+    arb_init(AB2);
+    arb_init(CD2);
+    arb_init(PQ2);
+    arb_init(pfac);
+
+    mirp_gpt(alpha1, alpha2, A, B, gammap, P, PA, PB, AB2, working_prec);
+    mirp_gpt(alpha3, alpha4, C, D, gammaq, Q, QC, QD, CD2, working_prec);
+
+    /*
+     * gammap_q = gammap + gammaq
+     * gammapq = gammap * gammaq / (gammap + gammaq)
+     */
+    arb_add(gammap_q, gammap, gammaq, working_prec);
+    arb_mul(gammapq, gammap, gammaq, working_prec);
+    arb_div(gammapq, gammapq, gammap_q, working_prec);
+
+    for(int i = 0; i < 3; i++)
+    {
+        arb_sub(PQ+i, P+i, Q+i, working_prec);
+        arb_sub(AB+i, A+i, B+i, working_prec);
+        arb_sub(CD+i, C+i, D+i, working_prec);
+    }
+
+    arb_mul(PQ2, PQ+0, PQ+0, working_prec);
+    arb_addmul(PQ2, PQ+1, PQ+1, working_prec);
+    arb_addmul(PQ2, PQ+2, PQ+2, working_prec);
+
+
+    /*************************************************
+     * Roots and weights of the quadrature
+     *************************************************/
+    arb_ptr roots = _arb_vec_init(nroots);
+    arb_ptr weights = _arb_vec_init(nroots);
+
+    arb_mul(tmp1, PQ2, gammapq, working_prec);
+    mirp_rys_roots(roots, weights, nroots, tmp1, working_prec);
+
+
+    /* Calculate the prefactor
+     *
+     * start with pfac = 2 * pi**2.5
+     */
+    arb_const_pi(pfac, working_prec);
+    arb_pow_ui(pfac, pfac, 5, working_prec);
+    arb_sqrt(pfac, pfac, working_prec);
+    arb_mul_ui(pfac, pfac, 2, working_prec);
+
+    /*
+     * Now multiply by K1 and K2
+     * K1 = exp(-alpha1 * alpha2 * AB2 / gammap);
+     * K2 = exp(-alpha3 * alpha4 * CD2 / gammaq);
+     */
+    arb_mul(tmp2, alpha1, alpha2, working_prec);
+    arb_mul(tmp2, tmp2, AB2, working_prec);
+    arb_div(tmp2, tmp2, gammap, working_prec);
+    arb_neg(tmp2, tmp2);
+    arb_exp(tmp2, tmp2, working_prec);
+    arb_mul(pfac, pfac, tmp2, working_prec);
+
+    arb_mul(tmp2, alpha3, alpha4, working_prec);
+    arb_mul(tmp2, tmp2, CD2, working_prec);
+    arb_div(tmp2, tmp2, gammaq, working_prec);
+    arb_neg(tmp2, tmp2);
+    arb_exp(tmp2, tmp2, working_prec);
+    arb_mul(pfac, pfac, tmp2, working_prec);
+
+    /*
+     * divide by (gammap * gammaq * sqrt(gammap + gammaq))
+     */
+    arb_sqrt(tmp2, gammap_q, working_prec);
+    arb_mul(tmp2, tmp2, gammap, working_prec);
+    arb_mul(tmp2, tmp2, gammaq, working_prec);
+    arb_div(pfac, pfac, tmp2, working_prec);
+
+
+    /*************************************************
+     * Loop over the roots
+     *************************************************/
+    arb_ptr I[3];
+    for(int x = 0; x < 3; x++)
+        I[x] = _arb_vec_init(ntable);
+
+    arb_t B00, B10, B01, C00, C00p;
+    arb_init(B00);
+    arb_init(B10);
+    arb_init(B01);
+    arb_init(C00);
+    arb_init(C00p);
+
+    for(int r = 0; r < nroots; r++)
+    {
+        arb_srcptr u2 = roots + r;
+
+        /*
+         * B00 = u2 / (2(p+q))
+         * B10 = (1 - gammapq/p * u2) / 2p
+         * B01 = (1 - gammapq/q * u2) / 2q
+         */
+        arb_div(B00, u2, gammap_q, working_prec);
+        arb_mul_2exp_si(B00, B00, -1);
+
+        arb_mul(tmp1, gammapq, u2, working_prec);
+        arb_div(tmp1, tmp1, gammap, working_prec);
+        arb_sub_ui(tmp1, tmp1, 1, working_prec);
+        arb_neg(tmp1, tmp1);
+        arb_div(B10, tmp1, gammap, working_prec);
+        arb_mul_2exp_si(B10, B10, -1);
+
+        arb_mul(tmp1, gammapq, u2, working_prec);
+        arb_div(tmp1, tmp1, gammaq, working_prec);
+        arb_sub_ui(tmp1, tmp1, 1, working_prec);
+        arb_neg(tmp1, tmp1);
+        arb_div(B01, tmp1, gammaq, working_prec);
+        arb_mul_2exp_si(B01, B01, -1);
+
+        for(int x = 0; x < 3; x++)
+        {
+            arb_ptr Ix = I[x];
+
+            /*
+             * C00  = PA - q/(p+q) * PQ * u2
+             * C00p = QC + p/(p+q) * PQ * u2
+             */
+            arb_mul(tmp1, PQ+x, u2, working_prec);
+            arb_div(tmp1, tmp1, gammap_q, working_prec);
+            arb_mul(tmp2, tmp1, gammaq, working_prec);
+            arb_sub(C00, PA+x, tmp2, working_prec);
+            arb_mul(tmp2, tmp1, gammap, working_prec);
+            arb_add(C00p, QC+x, tmp2, working_prec);
+
+            /* Two-dimensional integrals G(n,m), stored at [n][0][m][0] */
+            arb_one(Ix + MIRP_RYS_IDX(0, 0, 0, 0));
+
+            for(int n = 1; n <= Le; n++)
+            {
+                arb_ptr dst = Ix + MIRP_RYS_IDX(n, 0, 0, 0);
+                arb_mul(dst, C00, Ix + MIRP_RYS_IDX(n-1, 0, 0, 0), working_prec);
+                if(n > 1)
+                {
+                    arb_mul_si(tmp1, B10, n-1, working_prec);
+                    arb_addmul(dst, tmp1, Ix + MIRP_RYS_IDX(n-2, 0, 0, 0), working_prec);
+                }
+            }
+
+            for(int m = 1; m <= Lf; m++)
+            {
+                for(int n = 0; n <= Le; n++)
+                {
+                    arb_ptr dst = Ix + MIRP_RYS_IDX(n, 0, m, 0);
+                    arb_mul(dst, C00p, Ix + MIRP_RYS_IDX(n, 0, m-1, 0), working_prec);
+                    if(m > 1)
+                    {
+                        arb_mul_si(tmp1, B01, m-1, working_prec);
+                        arb_addmul(dst, tmp1, Ix + MIRP_RYS_IDX(n, 0, m-2, 0), working_prec);
+                    }
+                    if(n > 0)
+                    {
+                        arb_mul_si(tmp1, B00, n, working_prec);
+                        arb_addmul(dst, tmp1, Ix + MIRP_RYS_IDX(n-1, 0, m-1, 0), working_prec);
+                    }
+                }
+            }
+
+            /* HRR on the bra: I(n,b+1) = I(n+1,b) + AB I(n,b) */
+            for(int b = 1; b <= lb; b++)
+            for(int n = 0; n <= Le-b; n++)
+            for(int m = 0; m <= Lf; m++)
+            {
+                arb_ptr dst = Ix + MIRP_RYS_IDX(n, b, m, 0);
+                arb_mul(dst, AB+x, Ix + MIRP_RYS_IDX(n, b-1, m, 0), working_prec);
+                arb_add(dst, dst, Ix + MIRP_RYS_IDX(n+1, b-1, m, 0), working_prec);
+            }
+
+            /* HRR on the ket: I(m,d+1) = I(m+1,d) + CD I(m,d) */
+            for(int n = 0; n <= la; n++)
+            for(int b = 0; b <= lb; b++)
+            for(int d = 1; d <= ld; d++)
+            for(int m = 0; m <= Lf-d; m++)
+            {
+                arb_ptr dst = Ix + MIRP_RYS_IDX(n, b, m, d);
+                arb_mul(dst, CD+x, Ix + MIRP_RYS_IDX(n, b, m, d-1), working_prec);
+                arb_add(dst, dst, Ix + MIRP_RYS_IDX(n, b, m+1, d-1), working_prec);
+            }
+        }
+
+        /* Add this root's contribution to all the integrals */
+        #ifdef _OPENMP
+        #pragma omp parallel for collapse(4)
+        #endif
+        for(long i = 0; i < nlmn1; i++)
+        for(long j = 0; j < nlmn2; j++)
+        for(long k = 0; k < nlmn3; k++)
+        for(long l = 0; l < nlmn4; l++)
+        {
+            const long idx = i*nlmn4*nlmn3*nlmn2
+                           + j*nlmn4*nlmn3
+                           + k*nlmn4
+                           + l;
+
+            const int * l1 = lmn1 + 3*i;
+            const int * l2 = lmn2 + 3*j;
+            const int * l3 = lmn3 + 3*k;
+            const int * l4 = lmn4 + 3*l;
+
+            arb_t contrib;
+            arb_init(contrib);
+
+            arb_mul(contrib, weights + r, I[0] + MIRP_RYS_IDX(l1[0], l2[0], l3[0], l4[0]), working_prec);
+            arb_mul(contrib, contrib,     I[1] + MIRP_RYS_IDX(l1[1], l2[1], l3[1], l4[1]), working_prec);
+            arb_mul(contrib, contrib,     I[2] + MIRP_RYS_IDX(l1[2], l2[2], l3[2], l4[2]), working_prec);
+            arb_add(integrals + idx, integrals + idx, contrib, working_prec);
+
+            arb_clear(contrib);
+        }
+    }
+
+    /* apply the prefactor */
+    _arb_vec_scalar_mul(integrals, integrals, nint, pfac, working_prec);
+
+
+    /* cleanup */
+    for(int x = 0; x < 3; x++)
+        _arb_vec_clear(I[x], ntable);
+
+    _arb_vec_clear(roots, nroots);
+    _arb_vec_clear(weights, nroots);
+    arb_clear(B00);
+    arb_clear(B10);
+    arb_clear(B01);
+    arb_clear(C00);
+    arb_clear(C00p);
+
+    _arb_vec_clear(P,  3);
+    _arb_vec_clear(PA, 3);
+    _arb_vec_clear(PB, 3);
+    _arb_vec_clear(Q,  3);
+    _arb_vec_clear(QC, 3);
+    _arb_vec_clear(QD, 3);
+    _arb_vec_clear(PQ, 3);
+    _arb_vec_clear(AB, 3);
+    _arb_vec_clear(CD, 3);
+    arb_clear(gammap);
+    arb_clear(gammaq);
+    arb_clear(gammapq);
+    arb_clear(gammap_q);
+    arb_clear(AB2);
+    arb_clear(CD2);
+    arb_clear(PQ2);
+    arb_clear(pfac);
+    arb_clear(tmp1);
+    arb_clear(tmp2);
+}
+
+
+void mirp_gtoeri_rys_single(arb_t integral,
+                            const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                            const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                            const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                            const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                            slong working_prec)
+{
+    assert(lmn1[0] >= 0); assert(lmn1[1] >= 0); assert(lmn1[2] >= 0);
+    assert(lmn2[0] >= 0); assert(lmn2[1] >= 0); assert(lmn2[2] >= 0);
+    assert(lmn3[0] >= 0); assert(lmn3[1] >= 0); assert(lmn3[2] >= 0);
+    assert(lmn4[0] >= 0); assert(lmn4[1] >= 0); assert(lmn4[2] >= 0);
+
+    mirp_gtoeri_rys_compute(integral,
+                            1, lmn1, lmn1[0]+lmn1[1]+lmn1[2], A, alpha1,
+                            1, lmn2, lmn2[0]+lmn2[1]+lmn2[2], B, alpha2,
+                            1, lmn3, lmn3[0]+lmn3[1]+lmn3[2], C, alpha3,
+                            1, lmn4, lmn4[0]+lmn4[1]+lmn4[2], D, alpha4,
+                            working_prec);
+}
+
+
+void mirp_gtoeri_rys_prim(arb_ptr integrals,
+                          int am1, arb_srcptr A, const arb_t alpha1,
+                          int am2, arb_srcptr B, const arb_t alpha2,
+                          int am3, arb_srcptr C, const arb_t alpha3,
+                          int am4, arb_srcptr D, const arb_t alpha4,
+                          slong working_prec)
+{
+    assert(am1 >= 0);
+    assert(am2 >= 0);
+    assert(am3 >= 0);
+    assert(am4 >= 0);
+
+    const long ncart1 = MIRP_NCART(am1);
+    const long ncart2 = MIRP_NCART(am2);
+    const long ncart3 = MIRP_NCART(am3);
+    const long ncart4 = MIRP_NCART(am4);
+
+    int lmn1[ncart1][3];
+    int lmn2[ncart2][3];
+    int lmn3[ncart3][3];
+    int lmn4[ncart4][3];
+
+    mirp_gaussian_fill_lmn(am1, (int*)lmn1);
+    mirp_gaussian_fill_lmn(am2, (int*)lmn2);
+    mirp_gaussian_fill_lmn(am3, (int*)lmn3);
+    mirp_gaussian_fill_lmn(am4, (int*)lmn4);
+
+    mirp_gtoeri_rys_compute(integrals,
+                            ncart1, (int*)lmn1, am1, A, alpha1,
+                            ncart2, (int*)lmn2, am2, B, alpha2,
+                            ncart3, (int*)lmn3, am3, C, alpha3,
+                            ncart4, (int*)lmn4, am4, D, alpha4,
+                            working_prec);
+}
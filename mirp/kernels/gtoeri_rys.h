@@ -0,0 +1,152 @@
+/*! \file
+ *
+ * \brief Kernel for electron repulsion integrals of gaussian orbitals
+ *        using Rys quadrature
+ */
+
+#pragma once
+
+#include <arb.h>
+#include "mirp/kernels/integral4_wrappers.h"
+#include "mirp/kernels/gtoeri_bound.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \brief Computes a single cartesian GTO electron repulsion integral
+ *         using Rys quadrature (interval arithmetic)
+ *
+ * The roots and weights of the quadrature are certified
+ * (see \ref mirp_rys_roots), so the result is a rigorous enclosure
+ * of the integral. The results are the same as \ref mirp_gtoeri_single.
+ *
+ * \copydetails mirp_gtoeri_single_exact
+ *
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+void mirp_gtoeri_rys_single(arb_t integral,
+                            const int * lmn1, arb_srcptr A, const arb_t alpha1,
+                            const int * lmn2, arb_srcptr B, const arb_t alpha2,
+                            const int * lmn3, arb_srcptr C, const arb_t alpha3,
+                            const int * lmn4, arb_srcptr D, const arb_t alpha4,
+                            slong working_prec);
+
+
+/*! \brief Computes all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet using Rys quadrature
+ *         (interval arithmetic)
+ *
+ * The roots and weights of the quadrature, as well as the two-dimensional
+ * integrals for each root, are computed only once for the entire quartet.
+ *
+ * The \p integrals buffer must be able to hold
+ * ncart(am1) * ncart(am2) * ncart(am3) * ncart(am4) elements.
+ *
+ * \param [out] integrals
+ *              Resulting integrals
+ * \param [in]  am1,am2,am3,am4
+ *              Angular momentum of the four centers
+ * \param [in]  A,B,C,D
+ *              XYZ coordinates of the four centers (each of length 3)
+ * \param [in]  alpha1,alpha2,alpha3,alpha4
+ *              Exponents of the gaussian on the four centers
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+void mirp_gtoeri_rys_prim(arb_ptr integrals,
+                          int am1, arb_srcptr A, const arb_t alpha1,
+                          int am2, arb_srcptr B, const arb_t alpha2,
+                          int am3, arb_srcptr C, const arb_t alpha3,
+                          int am4, arb_srcptr D, const arb_t alpha4,
+                          slong working_prec);
+
+
+/*! \brief Bounds all cartesian GTO electron repulsion integrals
+ *         of a primitive shell quartet
+ *
+ * The bound does not depend on the method, so this is \ref mirp_gtoeri_bound.
+ */
+static inline
+double mirp_gtoeri_rys_bound(int am1, const double * A, double alpha1,
+                             int am2, const double * B, double alpha2,
+                             int am3, const double * C, double alpha3,
+                             int am4, const double * D, double alpha4)
+{
+    return mirp_gtoeri_bound(am1, A, alpha1,
+                             am2, B, alpha2,
+                             am3, C, alpha3,
+                             am4, D, alpha4);
+}
+
+
+/*******************
+ * Wrappings
+ *******************/
+
+/*! \brief Compute a single GTO electron repulsion integral for a primitive quartet
+ *         using Rys quadrature (string inputs)
+ *
+ * \copydetails mirp_gtoeri_rys_single
+ */
+MIRP_WRAP_SINGLE4_STR(gtoeri_rys)
+
+
+/*! \brief Compute a single GTO electron repulsion integral for a primitive quartet
+ *         using Rys quadrature (string inputs, target digits)
+ *
+ * \copydetails mirp_integral4_single_target
+ */
+MIRP_WRAP_SINGLE4_TARGET(gtoeri_rys)
+
+
+/*! \brief Compute a single GTO electron repulsion integral for a primitive quartet
+ *         using Rys quadrature (exact double precision)
+ *
+ * \copydetails mirp_gtoeri_single_exact
+ */
+MIRP_WRAP_SINGLE4_EXACT(gtoeri_rys)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using Rys quadrature (interval arithmetic)
+ *
+ * \copydetails mirp_gtoeri_exact
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+MIRP_WRAP_SHELL4(gtoeri_rys)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using Rys quadrature (string inputs)
+ *
+ * \copydetails mirp_gtoeri_rys
+ */
+MIRP_WRAP_SHELL4_STR(gtoeri_rys)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using Rys quadrature (string inputs, target digits)
+ *
+ * \copydetails mirp_integral4_target
+ */
+MIRP_WRAP_SHELL4_TARGET(gtoeri_rys)
+
+
+/*! \brief Compute GTO electron repulsion integrals for a contracted
+ *         shell quartet using Rys quadrature (exact double precision)
+ *
+ * \copydetails mirp_gtoeri_exact
+ */
+MIRP_WRAP_SHELL4_EXACT_REFINE(gtoeri_rys)
+
+
+#ifdef __cplusplus
+}
+#endif
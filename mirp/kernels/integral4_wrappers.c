@@ -6,38 +6,23 @@
 #include "mirp/pragma.h"
 #include "mirp/math.h"
 #include "mirp/shell.h"
+#include "mirp/precision.h"
+#include "mirp/dd.h"
 #include "mirp/kernels/boys.h"
 #include "mirp/kernels/integral4_wrappers.h"
 #include <string.h> /* for memset */
+#include <stdlib.h>
 #include <assert.h>
+#include <math.h>
 
 
 
-/*! \brief Compute all cartesian components of a single primitive integral
- *         (interval arithmetic)
- *
- * The \p integral buffer is expected to be able to hold all primitive integrals
- * (ie, it can hold ncart(am1) * ncart(am2) * ncart(am3) * ncart(am4) elements).
- *
- * \param [out] integrals
- *              Resulting integral integral
- * \param [in]  am1,am2,am3,am4
- *              Angular momentum of the four centers
- * \param [in]  A,B,C,D
- *              XYZ coordinates of the four centers (each of length 3)
- * \param [in]  alpha1,alpha2,alpha3,alpha4
- *              Exponents of the gaussian on the four centers
- * \param [in]  cb
- *              Callback that calculates a single cartesian component of a
- *              primitive integral
- * \param [in] working_prec The working precision (binary digits/bits) to use in the calculation
- */
-static void mirp_cartloop4(arb_ptr integrals,
-                           int am1, arb_srcptr A, const arb_t alpha1,
-                           int am2, arb_srcptr B, const arb_t alpha2,
-                           int am3, arb_srcptr C, const arb_t alpha3,
-                           int am4, arb_srcptr D, const arb_t alpha4,
-                           slong working_prec, cb_integral4_single cb)
+void mirp_cartloop4(arb_ptr integrals,
+                    int am1, arb_srcptr A, const arb_t alpha1,
+                    int am2, arb_srcptr B, const arb_t alpha2,
+                    int am3, arb_srcptr C, const arb_t alpha3,
+                    int am4, arb_srcptr D, const arb_t alpha4,
+                    slong working_prec, cb_integral4_single cb)
 {
     assert(am1 >= 0);
     assert(am2 >= 0);
@@ -83,82 +68,637 @@ static void mirp_cartloop4(arb_ptr integrals,
 }
 
 
+void mirp_cartloop4_ws(arb_ptr integrals,
+                       int am1, arb_srcptr A, const arb_t alpha1,
+                       int am2, arb_srcptr B, const arb_t alpha2,
+                       int am3, arb_srcptr C, const arb_t alpha3,
+                       int am4, arb_srcptr D, const arb_t alpha4,
+                       slong working_prec, cb_integral4_single_ws cb)
+{
+    assert(am1 >= 0);
+    assert(am2 >= 0);
+    assert(am3 >= 0);
+    assert(am4 >= 0);
+
+    const long ncart1 = MIRP_NCART(am1);
+    const long ncart2 = MIRP_NCART(am2);
+    const long ncart3 = MIRP_NCART(am3);
+    const long ncart4 = MIRP_NCART(am4);
+
+    int lmn1[ncart1][3];
+    int lmn2[ncart2][3];
+    int lmn3[ncart3][3];
+    int lmn4[ncart4][3];
+
+    mirp_gaussian_fill_lmn(am1, (int*)lmn1);
+    mirp_gaussian_fill_lmn(am2, (int*)lmn2);
+    mirp_gaussian_fill_lmn(am3, (int*)lmn3);
+    mirp_gaussian_fill_lmn(am4, (int*)lmn4);
+
+    const int max_am = MAX(MAX(am1, am2), MAX(am3, am4));
+
+    #ifdef _OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        /* One workspace for each thread, reused for all the components
+         * and kept between calls */
+        mirp_workspace * ws = mirp_workspace_local_get(1, MIRP_WORKSPACE_SIZE4(max_am));
+
+        #ifdef _OPENMP
+        #pragma omp for collapse(4)
+        #endif
+        for(long i = 0; i < ncart1; i++)
+        for(long j = 0; j < ncart2; j++)
+        for(long k = 0; k < ncart3; k++)
+        for(long l = 0; l < ncart4; l++)
+        {
+            const long idx = i*ncart4*ncart3*ncart2
+                           + j*ncart4*ncart3
+                           + k*ncart4
+                           + l;
+
+            cb(integrals + idx,
+               lmn1[i], A, alpha1,
+               lmn2[j], B, alpha2,
+               lmn3[k], C, alpha3,
+               lmn4[l], D, alpha4,
+               ws, working_prec);
+        }
+
+        mirp_workspace_local_release(ws);
+    }
+}
+
+
+/*! \brief Determine if two shells are identical
+ *
+ * Shells are identical if they have the same angular momentum, center,
+ * exponents, and coefficients (including the number of primitives and
+ * general contractions).
+ */
+static int mirp_shell_identical(int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                                int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2)
+{
+    if(am1 != am2 || nprim1 != nprim2 || ngen1 != ngen2)
+        return 0;
+
+    for(int i = 0; i < 3; i++)
+        if(!arb_equal(A + i, B + i))
+            return 0;
+
+    for(int i = 0; i < nprim1; i++)
+        if(!arb_equal(alpha1 + i, alpha2 + i))
+            return 0;
+
+    for(int i = 0; i < nprim1*ngen1; i++)
+        if(!arb_equal(coeff1 + i, coeff2 + i))
+            return 0;
+
+    return 1;
+}
+
+
+/*! \brief Determine which shells of a quartet are identical
+ *
+ * shell_class[q] is set to the index of the first shell identical to shell q
+ */
+static void mirp_shell_class(int * shell_class,
+                             const int * am, arb_srcptr const * center,
+                             const int * nprim, const int * ngen,
+                             arb_srcptr const * alpha, arb_srcptr const * coeff)
+{
+    for(int q = 0; q < 4; q++)
+    {
+        shell_class[q] = q;
+
+        for(int p = 0; p < q; p++)
+        {
+            if(mirp_shell_identical(am[p], center[p], nprim[p], ngen[p], alpha[p], coeff[p],
+                                    am[q], center[q], nprim[q], ngen[q], alpha[q], coeff[q]))
+            {
+                shell_class[q] = shell_class[p];
+                break;
+            }
+        }
+    }
+}
+
+
+/* The eight permutations of a shell quartet that leave
+ * the integral unchanged. Position q of the permuted quartet
+ * is filled by position perm[q] of the original, ie,
+ * (ij|kl), (ji|kl), (ij|lk), (ji|lk), (kl|ij), (lk|ij), (kl|ji), (lk|ji)
+ */
+static const int mirp_quartet_perms[8][4] = { {0, 1, 2, 3}, {1, 0, 2, 3}, {0, 1, 3, 2}, {1, 0, 3, 2},
+                                              {2, 3, 0, 1}, {3, 2, 0, 1}, {2, 3, 1, 0}, {3, 2, 1, 0} };
+
+
+/*! \brief Pointer to a function that computes the integrals of the
+ *         primitive quartet given by the primitive indices \p prim
+ *
+ * At least the components with indices in \p idx are computed.
+ * \p ws holds one workspace for each thread (see \ref mirp_workspace_nthreads).
+ */
+typedef void (*mirp_prim4_fn)(arb_ptr integrals, const int * prim,
+                              const long * idx, long nidx,
+                              const void * data, mirp_workspace * ws,
+                              slong working_prec);
+
+
+/*! \brief Contracts primitive quartets into a contracted shell quartet
+ *
+ * The primitive quartets are computed by \p fn. The normalized coefficients
+ * are given as products for the bra and ket pairs
+ * (see \ref mirp_shellpair::coeff for the layout).
+ *
+ * \p shell_class is used for permutational symmetry
+ * (see \ref mirp_shell_class).
+ */
+static void mirp_integral4_contract(arb_ptr integrals,
+                                    const int * shell_class, const int * am,
+                                    const int * nprim, const int * ngen,
+                                    arb_srcptr coeff12, arb_srcptr coeff34,
+                                    mirp_prim4_fn fn, const void * data,
+                                    slong working_prec)
+{
+    const long ncart[4] = { MIRP_NCART(am[0]), MIRP_NCART(am[1]), MIRP_NCART(am[2]), MIRP_NCART(am[3]) };
+    const long ncart1234 = ncart[0]*ncart[1]*ncart[2]*ncart[3];
+    const long ngen1234 = ngen[0]*ngen[1]*ngen[2]*ngen[3];
+    const long full_size = ncart1234*ngen1234;
+    const long nprim12 = nprim[0]*nprim[1];
+    const long nprim34 = nprim[2]*nprim[3];
+
+    arb_ptr integral_buffer = _arb_vec_init(ncart1234);
+
+    _arb_vec_zero(integrals, full_size);
+
+
+    /*
+     * Permutational symmetry
+     *
+     * If some of the shells are identical, the integrals of a primitive quartet
+     * (i j | k l) are a permutation of the integrals of (j i | k l), etc.
+     * So each primitive quartet is only computed once, and then contributes
+     * to all the primitive quartets it is related to.
+     *
+     * A primitive quartet such as (i i | k l) is also mapped onto itself by some
+     * of the permutations. Then its cartesian components are permutations of
+     * each other, and only the symmetry-unique ones are computed.
+     */
+
+    /* Which permutations are valid for these shells */
+    int nperm = 0;
+    int perms[8][4];
+    for(int n = 0; n < 8; n++)
+    {
+        const int * perm = mirp_quartet_perms[n];
+        if(shell_class[0] == shell_class[perm[0]] && shell_class[1] == shell_class[perm[1]] &&
+           shell_class[2] == shell_class[perm[2]] && shell_class[3] == shell_class[perm[3]])
+        {
+            for(int q = 0; q < 4; q++)
+                perms[nperm][q] = perm[q];
+            nperm++;
+        }
+    }
+
+    /* For each valid permutation, where each component of the permuted
+     * quartet comes from in the original quartet */
+    long * perm_idx = malloc(nperm * ncart1234 * sizeof(long));
+    for(int n = 0; n < nperm; n++)
+    {
+        const int * perm = perms[n];
+
+        long a[4];
+        for(a[0] = 0; a[0] < ncart[0]; a[0]++)
+        for(a[1] = 0; a[1] < ncart[1]; a[1]++)
+        for(a[2] = 0; a[2] < ncart[2]; a[2]++)
+        for(a[3] = 0; a[3] < ncart[3]; a[3]++)
+        {
+            long b[4];
+            for(int q = 0; q < 4; q++)
+                b[perm[q]] = a[q];
+
+            const long idx = ((a[0]*ncart[1] + a[1])*ncart[2] + a[2])*ncart[3] + a[3];
+            perm_idx[n*ncart1234 + idx] = ((b[0]*ncart[1] + b[1])*ncart[2] + b[2])*ncart[3] + b[3];
+        }
+    }
+
+    /* Symmetry-unique components of a primitive quartet, and for each
+     * component, the unique component it is equal to */
+    long * unique = malloc(ncart1234 * sizeof(long));
+    long * unique_of = malloc(ncart1234 * sizeof(long));
+
+    /* One workspace for each thread, reused for all the primitive quartets
+     * and kept between calls */
+    const int max_am = MAX(MAX(am[0], am[1]), MAX(am[2], am[3]));
+    mirp_workspace * ws = mirp_workspace_local_get(mirp_workspace_nthreads(),
+                                                   MIRP_WORKSPACE_SIZE4(max_am));
+
+
+    for(int i = 0; i < nprim[0]; i++)
+    for(int j = 0; j < nprim[1]; j++)
+    for(int k = 0; k < nprim[2]; k++)
+    for(int l = 0; l < nprim[3]; l++)
+    {
+        const int prim[4] = { i, j, k, l };
+
+        /* Find all the distinct primitive quartets related to this one.
+         * Only compute this one if it is the largest of them */
+        int nimage = 0;
+        int image_perm[8];
+        int image_prim[8][4];
+        int canonical = 1;
+
+        /* Permutations that map this primitive quartet onto itself */
+        int nstab = 0;
+        int stab_perm[8];
+
+        for(int n = 0; n < nperm && canonical; n++)
+        {
+            int p[4];
+            for(int q = 0; q < 4; q++)
+                p[q] = prim[perms[n][q]];
+
+            const long pidx = ((p[0]*nprim[1] + p[1])*nprim[2] + p[2])*nprim[3] + p[3];
+            const long idx = ((i*nprim[1] + j)*nprim[2] + k)*nprim[3] + l;
+            if(pidx > idx)
+                canonical = 0;
+            if(pidx == idx)
+                stab_perm[nstab++] = n;
+
+            int duplicate = 0;
+            for(int m = 0; m < nimage; m++)
+                if(p[0] == image_prim[m][0] && p[1] == image_prim[m][1] &&
+                   p[2] == image_prim[m][2] && p[3] == image_prim[m][3])
+                    duplicate = 1;
+
+            if(!duplicate)
+            {
+                for(int q = 0; q < 4; q++)
+                    image_prim[nimage][q] = p[q];
+                image_perm[nimage] = n;
+                nimage++;
+            }
+        }
+
+        if(!canonical)
+            continue;
+
+        /* A component is unique if it is the smallest of the
+         * components the permutations map it to */
+        long nunique = 0;
+        for(long q = 0; q < ncart1234; q++)
+        {
+            unique_of[q] = q;
+            for(int n = 0; n < nstab; n++)
+                unique_of[q] = MIN(unique_of[q], perm_idx[stab_perm[n]*ncart1234 + q]);
+
+            if(unique_of[q] == q)
+                unique[nunique++] = q;
+        }
+
+        fn(integral_buffer, prim, unique, nunique, data, ws, working_prec);
+
+        for(long q = 0; q < ncart1234; q++)
+            if(unique_of[q] != q)
+                arb_set(integral_buffer + q, integral_buffer + unique_of[q]);
+
+        for(int n = 0; n < nimage; n++)
+        {
+            const int * p = image_prim[n];
+            const long * pidx = perm_idx + image_perm[n]*ncart1234;
+            const long p12 = p[0]*nprim[1] + p[1];
+            const long p34 = p[2]*nprim[3] + p[3];
+
+            #ifdef _OPENMP
+            #pragma omp parallel for collapse(4)
+            #endif
+            for(int m = 0; m < ngen[0]; m++)
+            for(int o = 0; o < ngen[1]; o++)
+            for(int r = 0; r < ngen[2]; r++)
+            for(int s = 0; s < ngen[3]; s++)
+            {
+                /* A temporary variable (used to build up the coefficient) */
+                arb_t coeff;
+                arb_init(coeff);
+
+                arb_mul(coeff, coeff12 + ((m*ngen[1] + o)*nprim12 + p12),
+                               coeff34 + ((r*ngen[3] + s)*nprim34 + p34), working_prec);
+
+                const long start = ncart1234*(
+                                   m*ngen[3]*ngen[2]*ngen[1]
+                                 + o*ngen[3]*ngen[2]
+                                 + r*ngen[3]
+                                 + s);
+
+                for(long q = 0; q < ncart1234; q++)
+                    arb_addmul(integrals+start+q, integral_buffer+pidx[q], coeff, working_prec);
+
+                arb_clear(coeff);
+            }
+        }
+    }
+
+    mirp_workspace_local_release(ws);
+
+    free(unique_of);
+    free(unique);
+    free(perm_idx);
+    _arb_vec_clear(integral_buffer, ncart1234);
+}
+
+
+/*! \brief Computes the products of normalized coefficients of two shells
+ *
+ * See \ref mirp_shellpair::coeff for the layout of \p coeff12
+ */
+static void mirp_coeff_products(arb_ptr coeff12,
+                                int am1, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                                int am2, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                                slong working_prec)
+{
+    arb_ptr coeff1_norm = _arb_vec_init(nprim1 * ngen1);
+    arb_ptr coeff2_norm = _arb_vec_init(nprim2 * ngen2);
+
+    mirp_normalize_shell(am1, nprim1, ngen1, alpha1, coeff1, coeff1_norm, working_prec);
+    mirp_normalize_shell(am2, nprim2, ngen2, alpha2, coeff2, coeff2_norm, working_prec);
+
+    for(int m = 0; m < ngen1; m++)
+    for(int n = 0; n < ngen2; n++)
+    for(int i = 0; i < nprim1; i++)
+    for(int j = 0; j < nprim2; j++)
+    {
+        const long idx = ((m*ngen2 + n)*nprim1 + i)*nprim2 + j;
+        arb_mul(coeff12 + idx, coeff1_norm + (m*nprim1 + i), coeff2_norm + (n*nprim2 + j), working_prec);
+    }
+
+    _arb_vec_clear(coeff1_norm, nprim1*ngen1);
+    _arb_vec_clear(coeff2_norm, nprim2*ngen2);
+}
+
+
+/* Data passed to mirp_integral4_prim_fn. Only one of cb and cb_idx is set */
+typedef struct
+{
+    const int * am;
+    arb_srcptr const * center;
+    arb_srcptr const * alpha;
+    cb_integral4_prim cb;
+    cb_integral4_prim_idx cb_idx;
+} mirp_integral4_prim_data;
+
+
+static void mirp_integral4_prim_fn(arb_ptr integrals, const int * prim,
+                                   const long * idx, long nidx,
+                                   const void * data, mirp_workspace * ws,
+                                   slong working_prec)
+{
+    const mirp_integral4_prim_data * d = data;
+
+    if(d->cb_idx != NULL)
+        d->cb_idx(integrals, idx, nidx,
+                  d->am[0], d->center[0], d->alpha[0] + prim[0],
+                  d->am[1], d->center[1], d->alpha[1] + prim[1],
+                  d->am[2], d->center[2], d->alpha[2] + prim[2],
+                  d->am[3], d->center[3], d->alpha[3] + prim[3],
+                  ws, working_prec);
+    else
+        d->cb(integrals,
+              d->am[0], d->center[0], d->alpha[0] + prim[0],
+              d->am[1], d->center[1], d->alpha[1] + prim[1],
+              d->am[2], d->center[2], d->alpha[2] + prim[2],
+              d->am[3], d->center[3], d->alpha[3] + prim[3],
+              working_prec);
+}
+
+
+/*! \brief Compute all cartesian integrals of a contracted shell quartet
+ *         from either kind of primitive callback
+ *
+ * Exactly one of \p cb and \p cb_idx must be given
+ * (see \ref mirp_integral4 and \ref mirp_integral4_idx).
+ */
+static void mirp_integral4_common(arb_ptr integrals,
+                                  int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                                  int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                                  int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3,
+                                  int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4,
+                                  slong working_prec, cb_integral4_prim cb, cb_integral4_prim_idx cb_idx)
+{
+    assert(am1 >= 0); assert(nprim1 > 0); assert(ngen1 > 0);
+    assert(am2 >= 0); assert(nprim2 > 0); assert(ngen2 > 0);
+    assert(am3 >= 0); assert(nprim3 > 0); assert(ngen3 > 0);
+    assert(am4 >= 0); assert(nprim4 > 0); assert(ngen4 > 0);
+
+    const int am[4] = { am1, am2, am3, am4 };
+    const int nprim[4] = { nprim1, nprim2, nprim3, nprim4 };
+    const int ngen[4] = { ngen1, ngen2, ngen3, ngen4 };
+    arb_srcptr center[4] = { A, B, C, D };
+    arb_srcptr alpha[4] = { alpha1, alpha2, alpha3, alpha4 };
+    arb_srcptr coeff[4] = { coeff1, coeff2, coeff3, coeff4 };
+
+    const long ncoeff12 = nprim1*nprim2*ngen1*ngen2;
+    const long ncoeff34 = nprim3*nprim4*ngen3*ngen4;
+    arb_ptr coeff12 = _arb_vec_init(ncoeff12);
+    arb_ptr coeff34 = _arb_vec_init(ncoeff34);
+
+    mirp_coeff_products(coeff12,
+                        am1, nprim1, ngen1, alpha1, coeff1,
+                        am2, nprim2, ngen2, alpha2, coeff2,
+                        working_prec);
+    mirp_coeff_products(coeff34,
+                        am3, nprim3, ngen3, alpha3, coeff3,
+                        am4, nprim4, ngen4, alpha4, coeff4,
+                        working_prec);
+
+    int shell_class[4];
+    mirp_shell_class(shell_class, am, center, nprim, ngen, alpha, coeff);
+
+    mirp_integral4_prim_data data = { am, center, alpha, cb, cb_idx };
+
+    mirp_integral4_contract(integrals, shell_class, am, nprim, ngen,
+                            coeff12, coeff34,
+                            mirp_integral4_prim_fn, &data,
+                            working_prec);
+
+    _arb_vec_clear(coeff12, ncoeff12);
+    _arb_vec_clear(coeff34, ncoeff34);
+}
+
+
 void mirp_integral4(arb_ptr integrals,
                     int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
                     int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
                     int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3,
                     int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4,
-                    slong working_prec, cb_integral4_single cb)
+                    slong working_prec, cb_integral4_prim cb)
+{
+    mirp_integral4_common(integrals,
+                          am1, A, nprim1, ngen1, alpha1, coeff1,
+                          am2, B, nprim2, ngen2, alpha2, coeff2,
+                          am3, C, nprim3, ngen3, alpha3, coeff3,
+                          am4, D, nprim4, ngen4, alpha4, coeff4,
+                          working_prec, cb, NULL);
+}
+
+
+void mirp_integral4_idx(arb_ptr integrals,
+                        int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                        int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                        int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3,
+                        int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4,
+                        slong working_prec, cb_integral4_prim_idx cb)
+{
+    mirp_integral4_common(integrals,
+                          am1, A, nprim1, ngen1, alpha1, coeff1,
+                          am2, B, nprim2, ngen2, alpha2, coeff2,
+                          am3, C, nprim3, ngen3, alpha3, coeff3,
+                          am4, D, nprim4, ngen4, alpha4, coeff4,
+                          working_prec, NULL, cb);
+}
+
+
+void mirp_integral4_subset(arb_ptr integrals, const long * idx, long nidx,
+                           int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                           int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                           int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3,
+                           int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4,
+                           slong working_prec, cb_integral4_single cb)
 {
     assert(am1 >= 0); assert(nprim1 > 0); assert(ngen1 > 0);
     assert(am2 >= 0); assert(nprim2 > 0); assert(ngen2 > 0);
     assert(am3 >= 0); assert(nprim3 > 0); assert(ngen3 > 0);
     assert(am4 >= 0); assert(nprim4 > 0); assert(ngen4 > 0);
 
-    const long ncart1234 = MIRP_NCART4(am1, am2, am3, am4);
-    const long ngen1234 = ngen1*ngen2*ngen3*ngen4;
-    const long full_size = ncart1234*ngen1234;
+    const long ncart1 = MIRP_NCART(am1);
+    const long ncart2 = MIRP_NCART(am2);
+    const long ncart3 = MIRP_NCART(am3);
+    const long ncart4 = MIRP_NCART(am4);
+    const long ncart1234 = ncart1*ncart2*ncart3*ncart4;
+    const long nprim12 = nprim1*nprim2;
+    const long nprim34 = nprim3*nprim4;
 
-    arb_ptr integral_buffer = _arb_vec_init(ncart1234);
-    arb_ptr coeff1_norm = _arb_vec_init(nprim1 * ngen1);
-    arb_ptr coeff2_norm = _arb_vec_init(nprim2 * ngen2);
-    arb_ptr coeff3_norm = _arb_vec_init(nprim3 * ngen3);
-    arb_ptr coeff4_norm = _arb_vec_init(nprim4 * ngen4);
+    int lmn1[ncart1][3];
+    int lmn2[ncart2][3];
+    int lmn3[ncart3][3];
+    int lmn4[ncart4][3];
 
-    mirp_normalize_shell(am1, nprim1, ngen1, alpha1, coeff1, coeff1_norm, working_prec);
-    mirp_normalize_shell(am2, nprim2, ngen2, alpha2, coeff2, coeff2_norm, working_prec);
-    mirp_normalize_shell(am3, nprim3, ngen3, alpha3, coeff3, coeff3_norm, working_prec);
-    mirp_normalize_shell(am4, nprim4, ngen4, alpha4, coeff4, coeff4_norm, working_prec);
+    mirp_gaussian_fill_lmn(am1, (int*)lmn1);
+    mirp_gaussian_fill_lmn(am2, (int*)lmn2);
+    mirp_gaussian_fill_lmn(am3, (int*)lmn3);
+    mirp_gaussian_fill_lmn(am4, (int*)lmn4);
 
-    _arb_vec_zero(integrals, full_size);
+    const long ncoeff12 = nprim12*ngen1*ngen2;
+    const long ncoeff34 = nprim34*ngen3*ngen4;
+    arb_ptr coeff12 = _arb_vec_init(ncoeff12);
+    arb_ptr coeff34 = _arb_vec_init(ncoeff34);
 
+    mirp_coeff_products(coeff12,
+                        am1, nprim1, ngen1, alpha1, coeff1,
+                        am2, nprim2, ngen2, alpha2, coeff2,
+                        working_prec);
+    mirp_coeff_products(coeff34,
+                        am3, nprim3, ngen3, alpha3, coeff3,
+                        am4, nprim4, ngen4, alpha4, coeff4,
+                        working_prec);
 
-    for(int i = 0; i < nprim1; i++)
-    for(int j = 0; j < nprim2; j++)
-    for(int k = 0; k < nprim3; k++)
-    for(int l = 0; l < nprim4; l++)
+    #ifdef _OPENMP
+    #pragma omp parallel for
+    #endif
+    for(long n = 0; n < nidx; n++)
     {
-        mirp_cartloop4(integral_buffer,
-                       am1, A, alpha1 + i,
-                       am2, B, alpha2 + j,
-                       am3, C, alpha3 + k,
-                       am4, D, alpha4 + l,
-                       working_prec, cb);
-
-        #ifdef _OPENMP
-        #pragma omp parallel for collapse(4)
-        #endif
-        for(int m = 0; m < ngen1; m++)
-        for(int n = 0; n < ngen2; n++)
-        for(int o = 0; o < ngen3; o++)
-        for(int p = 0; p < ngen4; p++)
+        /* Which general contractions and cartesian components
+         * this integral is for */
+        const long gen = idx[n] / ncart1234;
+        const long cart = idx[n] % ncart1234;
+
+        const long m = gen / (ngen4*ngen3*ngen2);
+        const long o = (gen / (ngen4*ngen3)) % ngen2;
+        const long r = (gen / ngen4) % ngen3;
+        const long t = gen % ngen4;
+
+        const long i = cart / (ncart4*ncart3*ncart2);
+        const long j = (cart / (ncart4*ncart3)) % ncart2;
+        const long k = (cart / ncart4) % ncart3;
+        const long l = cart % ncart4;
+
+        arb_t prim_integral, coeff;
+        arb_init(prim_integral);
+        arb_init(coeff);
+
+        arb_zero(integrals + idx[n]);
+
+        for(int p1 = 0; p1 < nprim1; p1++)
+        for(int p2 = 0; p2 < nprim2; p2++)
+        for(int p3 = 0; p3 < nprim3; p3++)
+        for(int p4 = 0; p4 < nprim4; p4++)
         {
-            /* A temporary variable (used to build up the coefficient) */
-            arb_t coeff;
-            arb_init(coeff);
+            cb(prim_integral,
+               lmn1[i], A, alpha1 + p1,
+               lmn2[j], B, alpha2 + p2,
+               lmn3[k], C, alpha3 + p3,
+               lmn4[l], D, alpha4 + p4,
+               working_prec);
+
+            arb_mul(coeff, coeff12 + ((m*ngen2 + o)*nprim12 + p1*nprim2 + p2),
+                           coeff34 + ((r*ngen4 + t)*nprim34 + p3*nprim4 + p4), working_prec);
+            arb_addmul(integrals + idx[n], prim_integral, coeff, working_prec);
+        }
 
-            arb_mul(coeff, coeff1_norm+(m*nprim1+i), coeff2_norm+(n*nprim2+j), working_prec);
-            arb_mul(coeff, coeff,                    coeff3_norm+(o*nprim3+k), working_prec);
-            arb_mul(coeff, coeff,                    coeff4_norm+(p*nprim4+l), working_prec);
+        arb_clear(prim_integral);
+        arb_clear(coeff);
+    }
 
-            const long start = ncart1234*(
-                               m*ngen4*ngen3*ngen2
-                             + n*ngen4*ngen3
-                             + o*ngen4
-                             + p);
+    _arb_vec_clear(coeff12, ncoeff12);
+    _arb_vec_clear(coeff34, ncoeff34);
+}
 
-            for(long q = 0; q < ncart1234; q++)
-                arb_addmul(integrals+start+q, integral_buffer+q, coeff, working_prec);
 
-            arb_clear(coeff);
-        }
-    }
+/* Data passed to mirp_integral4_shellpair_fn */
+typedef struct
+{
+    const mirp_shellpair * bra;
+    const mirp_shellpair * ket;
+    cb_integral4_shellpair_prim cb;
+} mirp_integral4_shellpair_data;
 
-    _arb_vec_clear(integral_buffer, ncart1234);
-    _arb_vec_clear(coeff1_norm, nprim1*ngen1);
-    _arb_vec_clear(coeff2_norm, nprim2*ngen2);
-    _arb_vec_clear(coeff3_norm, nprim3*ngen3);
-    _arb_vec_clear(coeff4_norm, nprim4*ngen4);
+
+static void mirp_integral4_shellpair_fn(arb_ptr integrals, const int * prim,
+                                        const long * idx, long nidx,
+                                        const void * data, mirp_workspace * ws,
+                                        slong working_prec)
+{
+    const mirp_integral4_shellpair_data * d = data;
+
+    d->cb(integrals, idx, nidx,
+          d->bra, prim[0]*d->bra->nprim2 + prim[1],
+          d->ket, prim[2]*d->ket->nprim2 + prim[3],
+          ws, working_prec);
+}
+
+
+void mirp_integral4_shellpair(arb_ptr integrals,
+                              const mirp_shellpair * bra,
+                              const mirp_shellpair * ket,
+                              slong working_prec, cb_integral4_shellpair_prim cb)
+{
+    const int am[4] = { bra->am1, bra->am2, ket->am1, ket->am2 };
+    const int nprim[4] = { bra->nprim1, bra->nprim2, ket->nprim1, ket->nprim2 };
+    const int ngen[4] = { bra->ngen1, bra->ngen2, ket->ngen1, ket->ngen2 };
+    arb_srcptr center[4] = { bra->A, bra->B, ket->A, ket->B };
+    arb_srcptr alpha[4] = { bra->alpha1, bra->alpha2, ket->alpha1, ket->alpha2 };
+    arb_srcptr coeff[4] = { bra->coeff1, bra->coeff2, ket->coeff1, ket->coeff2 };
+
+    int shell_class[4];
+    mirp_shell_class(shell_class, am, center, nprim, ngen, alpha, coeff);
+
+    mirp_integral4_shellpair_data data = { bra, ket, cb };
+
+    mirp_integral4_contract(integrals, shell_class, am, nprim, ngen,
+                            bra->coeff, ket->coeff,
+                            mirp_integral4_shellpair_fn, &data,
+                            working_prec);
 }
 
 
@@ -300,62 +840,645 @@ void mirp_integral4_str(arb_ptr integrals,
 
 
 
-void mirp_integral4_single_exact(double * integral,
-                                 const int * lmn1, const double * A, double alpha1,
-                                 const int * lmn2, const double * B, double alpha2,
-                                 const int * lmn3, const double * C, double alpha3,
-                                 const int * lmn4, const double * D, double alpha4,
-                                 cb_integral4_single cb)
+/*! \brief Updates the smallest and largest exponent with
+ *         the exponents of a shell
+ */
+static void mirp_exponent_range(double * alpha_min, double * alpha_max,
+                                const double * alpha, int nprim)
 {
-    assert(lmn1[0] >= 0); assert(lmn1[1] >= 0); assert(lmn1[2] >= 0);
-    assert(lmn2[0] >= 0); assert(lmn2[1] >= 0); assert(lmn2[2] >= 0);
-    assert(lmn3[0] >= 0); assert(lmn3[1] >= 0); assert(lmn3[2] >= 0);
-    assert(lmn4[0] >= 0); assert(lmn4[1] >= 0); assert(lmn4[2] >= 0);
-
-    /* convert arguments to arb_t */
-    arb_ptr A_mp = _arb_vec_init(3);
-    arb_ptr B_mp = _arb_vec_init(3);
-    arb_ptr C_mp = _arb_vec_init(3);
-    arb_ptr D_mp = _arb_vec_init(3);
-
-    arb_t alpha1_mp, alpha2_mp, alpha3_mp, alpha4_mp;
-    arb_init(alpha1_mp);
-    arb_init(alpha2_mp);
-    arb_init(alpha3_mp);
-    arb_init(alpha4_mp);
-
-    arb_set_d(alpha1_mp, alpha1);
-    arb_set_d(alpha2_mp, alpha2);
-    arb_set_d(alpha3_mp, alpha3);
-    arb_set_d(alpha4_mp, alpha4);
-
-    for(int i = 0; i < 3; i++)
+    for(int i = 0; i < nprim; i++)
     {
-        arb_set_d(A_mp + i, A[i]);
-        arb_set_d(B_mp + i, B[i]);
-        arb_set_d(C_mp + i, C[i]);
-        arb_set_d(D_mp + i, D[i]);
+        *alpha_min = MIN(*alpha_min, alpha[i]);
+        *alpha_max = MAX(*alpha_max, alpha[i]);
     }
+}
 
-    /* Final integral output */
-    arb_t integral_mp;
-    arb_init(integral_mp);
 
-    /* The target precision is the number of bits in
-     * double precision (53) + lots of safety */
-    const slong target_prec = 64;
+/*! \brief Updates the smallest and largest exponent with
+ *         the exponents of a shell (string input)
+ *
+ * The exponents are only needed for an estimate, so
+ * conversion to double precision is enough
+ */
+static void mirp_exponent_range_str(double * alpha_min, double * alpha_max,
+                                    const char ** alpha, int nprim)
+{
+    for(int i = 0; i < nprim; i++)
+    {
+        const double a = strtod(alpha[i], NULL);
+        mirp_exponent_range(alpha_min, alpha_max, &a, 1);
+    }
+}
 
-    slong working_prec = target_prec;
-    int suff_acc = 0;
 
+/*! \brief Updates the largest argument of the Boys function
+ *         (PQ^2 * gammapq) with all primitive quartets of a shell quartet
+ *
+ * This is only needed for an estimate, so it is computed
+ * in double precision
+ */
+static void mirp_boys_arg_range(double * T_max,
+                                const double * A, const double * alpha1, int nprim1,
+                                const double * B, const double * alpha2, int nprim2,
+                                const double * C, const double * alpha3, int nprim3,
+                                const double * D, const double * alpha4, int nprim4)
+{
+    for(int i = 0; i < nprim1; i++)
+    for(int j = 0; j < nprim2; j++)
+    {
+        const double p = alpha1[i] + alpha2[j];
+        double P[3];
+        for(int x = 0; x < 3; x++)
+            P[x] = (alpha1[i]*A[x] + alpha2[j]*B[x]) / p;
+
+        for(int k = 0; k < nprim3; k++)
+        for(int l = 0; l < nprim4; l++)
+        {
+            const double q = alpha3[k] + alpha4[l];
+            double PQ2 = 0.0;
+            for(int x = 0; x < 3; x++)
+            {
+                const double PQ = P[x] - (alpha3[k]*C[x] + alpha4[l]*D[x]) / q;
+                PQ2 += PQ*PQ;
+            }
+
+            *T_max = MAX(*T_max, PQ2 * p*q/(p+q));
+        }
+    }
+}
+
+
+/*! \brief Updates the largest argument of the Boys function
+ *         (PQ^2 * gammapq) with all primitive quartets of
+ *         a shell quartet (string input)
+ *
+ * \copydetails mirp_boys_arg_range
+ */
+static void mirp_boys_arg_range_str(double * T_max,
+                                    const char ** A, const char ** alpha1, int nprim1,
+                                    const char ** B, const char ** alpha2, int nprim2,
+                                    const char ** C, const char ** alpha3, int nprim3,
+                                    const char ** D, const char ** alpha4, int nprim4)
+{
+    const char ** center_str[4] = { A, B, C, D };
+    const char ** alpha_str[4] = { alpha1, alpha2, alpha3, alpha4 };
+    const int nprim[4] = { nprim1, nprim2, nprim3, nprim4 };
+
+    double center[4][3];
+    double * alpha[4];
+
+    for(int n = 0; n < 4; n++)
+    {
+        for(int x = 0; x < 3; x++)
+            center[n][x] = strtod(center_str[n][x], NULL);
+
+        alpha[n] = malloc(nprim[n] * sizeof(double));
+        for(int i = 0; i < nprim[n]; i++)
+            alpha[n][i] = strtod(alpha_str[n][i], NULL);
+    }
+
+    mirp_boys_arg_range(T_max,
+                        center[0], alpha[0], nprim1,
+                        center[1], alpha[1], nprim2,
+                        center[2], alpha[2], nprim3,
+                        center[3], alpha[3], nprim4);
+
+    for(int n = 0; n < 4; n++)
+        free(alpha[n]);
+}
+
+
+slong mirp_integral4_single_target(arb_t integral,
+                                   const int * lmn1, const char ** A, const char * alpha1,
+                                   const int * lmn2, const char ** B, const char * alpha2,
+                                   const int * lmn3, const char ** C, const char * alpha3,
+                                   const int * lmn4, const char ** D, const char * alpha4,
+                                   long ndigits, cb_integral4_single_str cb)
+{
+    const slong target_prec = mirp_prec_from_digits(ndigits);
+
+    /* Start with a precision estimated from the angular momentum,
+     * the exponents, and the arguments of the Boys function */
+    const int L = lmn1[0] + lmn1[1] + lmn1[2] + lmn2[0] + lmn2[1] + lmn2[2]
+                + lmn3[0] + lmn3[1] + lmn3[2] + lmn4[0] + lmn4[1] + lmn4[2];
+
+    double alpha_min = strtod(alpha1, NULL);
+    double alpha_max = alpha_min;
+    mirp_exponent_range_str(&alpha_min, &alpha_max, &alpha2, 1);
+    mirp_exponent_range_str(&alpha_min, &alpha_max, &alpha3, 1);
+    mirp_exponent_range_str(&alpha_min, &alpha_max, &alpha4, 1);
+
+    double T_max = 0.0;
+    mirp_boys_arg_range_str(&T_max, A, &alpha1, 1, B, &alpha2, 1,
+                                    C, &alpha3, 1, D, &alpha4, 1);
+
+    slong working_prec = mirp_prec_initial(L, alpha_min, alpha_max, T_max, target_prec);
+
+    while(1)
+    {
+        cb(integral,
+           lmn1, A, alpha1,
+           lmn2, B, alpha2,
+           lmn3, C, alpha3,
+           lmn4, D, alpha4,
+           working_prec);
+
+        slong min_bits = target_prec;
+        const int suff_acc = mirp_prec_target_reached(integral, target_prec, &min_bits);
+
+        if(suff_acc || working_prec > MIRP_PREC_TARGET_MAX)
+            break;
+
+        working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
+    }
+
+    return working_prec;
+}
+
+
+slong mirp_integral4_target(arb_ptr integrals,
+                            int am1, const char ** A, int nprim1, int ngen1, const char ** alpha1, const char ** coeff1,
+                            int am2, const char ** B, int nprim2, int ngen2, const char ** alpha2, const char ** coeff2,
+                            int am3, const char ** C, int nprim3, int ngen3, const char ** alpha3, const char ** coeff3,
+                            int am4, const char ** D, int nprim4, int ngen4, const char ** alpha4, const char ** coeff4,
+                            long ndigits, cb_integral4_str cb)
+{
+    const slong target_prec = mirp_prec_from_digits(ndigits);
+    const long nintegrals = MIRP_NCART(am1) * MIRP_NCART(am2) * MIRP_NCART(am3) * MIRP_NCART(am4)
+                          * ngen1 * ngen2 * ngen3 * ngen4;
+
+    /* Start with a precision estimated from the angular momentum,
+     * the exponents, and the arguments of the Boys function */
+    double alpha_min = strtod(alpha1[0], NULL);
+    double alpha_max = alpha_min;
+    mirp_exponent_range_str(&alpha_min, &alpha_max, alpha1, nprim1);
+    mirp_exponent_range_str(&alpha_min, &alpha_max, alpha2, nprim2);
+    mirp_exponent_range_str(&alpha_min, &alpha_max, alpha3, nprim3);
+    mirp_exponent_range_str(&alpha_min, &alpha_max, alpha4, nprim4);
+
+    double T_max = 0.0;
+    mirp_boys_arg_range_str(&T_max, A, alpha1, nprim1, B, alpha2, nprim2,
+                                    C, alpha3, nprim3, D, alpha4, nprim4);
+
+    slong working_prec = mirp_prec_initial(am1+am2+am3+am4, alpha_min, alpha_max, T_max, target_prec);
+
+    while(1)
+    {
+        cb(integrals,
+           am1, A, nprim1, ngen1, alpha1, coeff1,
+           am2, B, nprim2, ngen2, alpha2, coeff2,
+           am3, C, nprim3, ngen3, alpha3, coeff3,
+           am4, D, nprim4, ngen4, alpha4, coeff4,
+           working_prec);
+
+        /* Check all integrals, so that min_bits covers all
+         * of the ones that are not accurate enough */
+        slong min_bits = target_prec;
+        int suff_acc = 1;
+        for(long i = 0; i < nintegrals; i++)
+        {
+            if(!mirp_prec_target_reached(integrals + i, target_prec, &min_bits))
+                suff_acc = 0;
+        }
+
+        if(suff_acc || working_prec > MIRP_PREC_TARGET_MAX)
+            break;
+
+        working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
+    }
+
+    return working_prec;
+}
+
+
+/*! \brief Determine if an integral has sufficient accuracy for conversion
+ *         to double precision
+ *
+ * We need at least \p target_prec bits OR the value is zero (has zero precision)
+ * and the error bounds is exactly zero when converted to double precision
+ *
+ * \param [inout] min_bits If the integral is not sufficiently accurate, this is
+ *                         lowered to its relative accuracy (see \ref mirp_prec_next)
+ * \return Nonzero if the integral is sufficiently accurate
+ */
+static int mirp_integral4_accurate1(const arb_t integral,
+                                    slong target_prec, slong working_prec,
+                                    slong * min_bits)
+{
+    int suff_acc = 1;
+    slong bits = arb_rel_accuracy_bits(integral);
+
+    if(bits > 0 && bits < target_prec)
+    {
+        suff_acc = 0;
+        *min_bits = MIN(*min_bits, bits);
+    }
+    else if(bits <= 0)
+    {
+        /* for comparisons */
+        arf_t ubound, lbound;
+        arf_init(ubound);
+        arf_init(lbound);
+
+        arb_get_ubound_arf(ubound, integral, working_prec);
+        arb_get_lbound_arf(lbound, integral, working_prec);
+
+        PRAGMA_WARNING_PUSH
+        PRAGMA_WARNING_IGNORE_FP_UNDERFLOW
+
+        if(arf_cmpabs_d(lbound, MIRP_DBL_TRUE_MIN) > 0 || 
+           arf_cmpabs_d(ubound, MIRP_DBL_TRUE_MIN) > 0)
+        {
+            suff_acc = 0; 
+            *min_bits = 0;
+        }
+
+        PRAGMA_WARNING_POP
+
+        arf_clear(lbound);
+        arf_clear(ubound);
+    }
+
+    return suff_acc;
+}
+
+
+/*! \brief Determine if integrals have sufficient accuracy for conversion
+ *         to double precision
+ *
+ * See \ref mirp_integral4_accurate1
+ *
+ * \param [out] min_bits The smallest relative accuracy of the integrals that
+ *                       are not sufficiently accurate (see \ref mirp_prec_next)
+ * \return Nonzero if all \p n integrals are sufficiently accurate
+ */
+static int mirp_integral4_accurate(arb_srcptr integrals, long n,
+                                   slong target_prec, slong working_prec,
+                                   slong * min_bits)
+{
+    int suff_acc = 1;
+    *min_bits = target_prec;
+
+    for(long i = 0; i < n; i++)
+        if(!mirp_integral4_accurate1(integrals + i, target_prec, working_prec, min_bits))
+            suff_acc = 0;
+
+    return suff_acc;
+}
+
+
+/*! \brief Determine if an interval determines the correctly
+ *         rounded double precision value of an integral
+ *
+ * This is true if both bounds of the interval round to the same value. Since
+ * rounding is monotonic, every value inside the interval (including
+ * the exact integral) then rounds to that value.
+ *
+ * \param [out] value  The correctly rounded value (only if certified)
+ * \return Nonzero if the interval determines the correctly rounded value
+ */
+static int mirp_integral4_certify(double * value, const arb_t integral, slong working_prec)
+{
     /* for comparisons */
     arf_t ubound, lbound;
     arf_init(ubound);
     arf_init(lbound);
 
+    arb_get_ubound_arf(ubound, integral, working_prec);
+    arb_get_lbound_arf(lbound, integral, working_prec);
+
+    PRAGMA_WARNING_PUSH
+    PRAGMA_WARNING_IGNORE_FP_UNDERFLOW
+
+    const double lvalue = arf_get_d(lbound, ARF_RND_NEAR);
+    const int certified = arb_is_finite(integral) &&
+                          lvalue == arf_get_d(ubound, ARF_RND_NEAR);
+
+    PRAGMA_WARNING_POP
+
+    if(certified)
+        *value = lvalue;
+
+    arf_clear(lbound);
+    arf_clear(ubound);
+
+    return certified;
+}
+
+
+/*! \brief Converts integrals to double precision
+ *
+ * We get the value from the midpoint of the arb struct. Integrals
+ * without any accuracy are zero (see \ref mirp_integral4_accurate)
+ */
+static void mirp_integral4_get_d(double * integrals, arb_srcptr integral_mp, long n)
+{
+    for(long i = 0; i < n; i++)
+    {
+        if(arb_rel_accuracy_bits(integral_mp + i) <= 0)
+            integrals[i] = 0.0;
+        else
+            integrals[i] = arf_get_d(arb_midref(integral_mp + i), ARF_RND_NEAR);
+    }
+}
+
+
+/*! \brief log2 of the magnitude below which integrals are zero in double precision
+ *
+ * Values below half the smallest subnormal round to zero. One bit
+ * is subtracted to cover the rounding of the sum of the bounds.
+ */
+#define MIRP_LOG2_UNDERFLOW (-1076.0)
+
+
+/*! \brief Determine from an a-priori bound if all integrals of
+ *         a contracted quartet are zero in double precision
+ *
+ * The bounds of all primitive quartets are summed, weighted by bounds on the
+ * products of the (normalized) coefficients. As soon as a single primitive
+ * quartet may be representable, nothing more is computed.
+ *
+ * \param [in] cmax12,cmax34 Upper bounds on the absolute value of the products of
+ *                           coefficients of the bra and ket primitive pairs, over all
+ *                           general contractions (index i*nprim2 + j)
+ * \return Nonzero if all integrals are proven to round to zero
+ */
+static int mirp_integral4_negligible(const int * am, const double * const * center,
+                                     const int * nprim, const double * const * alpha,
+                                     const double * cmax12, const double * cmax34,
+                                     cb_integral4_bound cb_bound)
+{
+    /* The sum is kept as 2^lmax * sum to avoid underflow */
+    double lmax = -INFINITY;
+    double sum = 0.0;
+
+    for(int i = 0; i < nprim[0]; i++)
+    for(int j = 0; j < nprim[1]; j++)
+    for(int k = 0; k < nprim[2]; k++)
+    for(int l = 0; l < nprim[3]; l++)
+    {
+        const double c = cmax12[i*nprim[1]+j] * cmax34[k*nprim[3]+l];
+        if(c == 0.0)
+            continue;
+
+        const double b = log2(c) + cb_bound(am[0], center[0], alpha[0][i],
+                                            am[1], center[1], alpha[1][j],
+                                            am[2], center[2], alpha[2][k],
+                                            am[3], center[3], alpha[3][l]);
+
+        /* Also catches NaN and infinite bounds */
+        if(!(b < MIRP_LOG2_UNDERFLOW))
+            return 0;
+
+        if(b > lmax)
+        {
+            sum = sum * exp2(lmax - b) + 1.0;
+            lmax = b;
+        }
+        else
+            sum += exp2(b - lmax);
+    }
+
+    /* All coefficients are zero */
+    if(sum == 0.0)
+        return 1;
+
+    return lmax + log2(sum) < MIRP_LOG2_UNDERFLOW;
+}
+
+
+/*! \brief Computes upper bounds on the absolute value of the normalized
+ *         coefficients of a shell, over all general contractions
+ *
+ * The normalization is done with interval arithmetic, so the bounds are rigorous.
+ *
+ * \param [out] cmax Bounds for each primitive (of length \p nprim)
+ */
+static void mirp_coeff_max(double * cmax,
+                           int am, int nprim, int ngen,
+                           const double * alpha, const double * coeff)
+{
+    arb_ptr alpha_mp = _arb_vec_init(nprim);
+    arb_ptr coeff_mp = _arb_vec_init(nprim*ngen);
+    arb_ptr coeff_norm = _arb_vec_init(nprim*ngen);
+
+    for(int i = 0; i < nprim; i++)
+        arb_set_d(alpha_mp + i, alpha[i]);
+    for(int i = 0; i < nprim*ngen; i++)
+        arb_set_d(coeff_mp + i, coeff[i]);
+
+    mirp_normalize_shell(am, nprim, ngen, alpha_mp, coeff_mp, coeff_norm, MIRP_PREC_FAST);
+
+    arf_t ubound;
+    arf_init(ubound);
+
+    for(int i = 0; i < nprim; i++)
+    {
+        cmax[i] = 0.0;
+        for(int n = 0; n < ngen; n++)
+        {
+            arb_get_abs_ubound_arf(ubound, coeff_norm + (n*nprim + i), MIRP_PREC_FAST);
+            cmax[i] = MAX(cmax[i], arf_get_d(ubound, ARF_RND_UP));
+        }
+    }
+
+    arf_clear(ubound);
+    _arb_vec_clear(alpha_mp, nprim);
+    _arb_vec_clear(coeff_mp, nprim*ngen);
+    _arb_vec_clear(coeff_norm, nprim*ngen);
+}
+
+
+/*! \brief Determine from an a-priori bound if all integrals of
+ *         a contracted shell quartet are zero in double precision
+ *
+ * See \ref mirp_integral4_negligible
+ */
+static int mirp_integral4_shell_negligible(int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                                           int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                                           int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
+                                           int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
+                                           cb_integral4_bound cb_bound)
+{
+    double cmax1[nprim1], cmax2[nprim2], cmax3[nprim3], cmax4[nprim4];
+    mirp_coeff_max(cmax1, am1, nprim1, ngen1, alpha1, coeff1);
+    mirp_coeff_max(cmax2, am2, nprim2, ngen2, alpha2, coeff2);
+    mirp_coeff_max(cmax3, am3, nprim3, ngen3, alpha3, coeff3);
+    mirp_coeff_max(cmax4, am4, nprim4, ngen4, alpha4, coeff4);
+
+    double cmax12[nprim1*nprim2], cmax34[nprim3*nprim4];
+    for(int i = 0; i < nprim1; i++)
+    for(int j = 0; j < nprim2; j++)
+        cmax12[i*nprim2+j] = cmax1[i] * cmax2[j];
+    for(int k = 0; k < nprim3; k++)
+    for(int l = 0; l < nprim4; l++)
+        cmax34[k*nprim4+l] = cmax3[k] * cmax4[l];
+
+    const int am[4] = { am1, am2, am3, am4 };
+    const int nprim[4] = { nprim1, nprim2, nprim3, nprim4 };
+    const double * center[4] = { A, B, C, D };
+    const double * alpha[4] = { alpha1, alpha2, alpha3, alpha4 };
+
+    return mirp_integral4_negligible(am, center, nprim, alpha, cmax12, cmax34, cb_bound);
+}
+
+
+/*! \brief Determine from an a-priori bound if all integrals of a contracted
+ *         shell quartet given by shell pairs are zero in double precision
+ *
+ * See \ref mirp_integral4_negligible
+ */
+static int mirp_integral4_shellpair_negligible(const mirp_shellpair * bra,
+                                               const mirp_shellpair * ket,
+                                               cb_integral4_bound cb_bound)
+{
+    const mirp_shellpair * pairs[2] = { bra, ket };
+    const int nprim[4] = { bra->nprim1, bra->nprim2, ket->nprim1, ket->nprim2 };
+    const int am[4] = { bra->am1, bra->am2, ket->am1, ket->am2 };
+
+    /* The pairs hold the exact double precision inputs */
+    double center_d[4][3];
+    double * alpha_d[4];
+    double * cmax[2];
+
+    arf_t ubound;
+    arf_init(ubound);
+
+    for(int p = 0; p < 2; p++)
+    {
+        const mirp_shellpair * sp = pairs[p];
+        const int nprim12 = sp->nprim1 * sp->nprim2;
+
+        for(int i = 0; i < 3; i++)
+        {
+            center_d[2*p][i] = arf_get_d(arb_midref(sp->A + i), ARF_RND_NEAR);
+            center_d[2*p+1][i] = arf_get_d(arb_midref(sp->B + i), ARF_RND_NEAR);
+        }
+
+        alpha_d[2*p] = malloc(sp->nprim1 * sizeof(double));
+        alpha_d[2*p+1] = malloc(sp->nprim2 * sizeof(double));
+        for(int i = 0; i < sp->nprim1; i++)
+            alpha_d[2*p][i] = arf_get_d(arb_midref(sp->alpha1 + i), ARF_RND_NEAR);
+        for(int i = 0; i < sp->nprim2; i++)
+            alpha_d[2*p+1][i] = arf_get_d(arb_midref(sp->alpha2 + i), ARF_RND_NEAR);
+
+        cmax[p] = malloc(nprim12 * sizeof(double));
+        for(int ij = 0; ij < nprim12; ij++)
+        {
+            cmax[p][ij] = 0.0;
+            for(int mn = 0; mn < sp->ngen1 * sp->ngen2; mn++)
+            {
+                arb_get_abs_ubound_arf(ubound, sp->coeff + (mn*nprim12 + ij), MIRP_PREC_FAST);
+                cmax[p][ij] = MAX(cmax[p][ij], arf_get_d(ubound, ARF_RND_UP));
+            }
+        }
+    }
+
+    arf_clear(ubound);
+
+    const double * center[4] = { center_d[0], center_d[1], center_d[2], center_d[3] };
+    const double * alpha[4] = { alpha_d[0], alpha_d[1], alpha_d[2], alpha_d[3] };
+
+    const int negligible = mirp_integral4_negligible(am, center, nprim, alpha,
+                                                     cmax[0], cmax[1], cb_bound);
+
+    for(int i = 0; i < 4; i++)
+        free(alpha_d[i]);
+    free(cmax[0]);
+    free(cmax[1]);
+
+    return negligible;
+}
+
+
+
+void mirp_integral4_single_exact(double * integral,
+                                 const int * lmn1, const double * A, double alpha1,
+                                 const int * lmn2, const double * B, double alpha2,
+                                 const int * lmn3, const double * C, double alpha3,
+                                 const int * lmn4, const double * D, double alpha4,
+                                 cb_integral4_single cb, cb_integral4_bound cb_bound)
+{
+    assert(lmn1[0] >= 0); assert(lmn1[1] >= 0); assert(lmn1[2] >= 0);
+    assert(lmn2[0] >= 0); assert(lmn2[1] >= 0); assert(lmn2[2] >= 0);
+    assert(lmn3[0] >= 0); assert(lmn3[1] >= 0); assert(lmn3[2] >= 0);
+    assert(lmn4[0] >= 0); assert(lmn4[1] >= 0); assert(lmn4[2] >= 0);
+
+    const double stats_start = mirp_exact_stats_start();
+
+    const int am[4] = { lmn1[0]+lmn1[1]+lmn1[2], lmn2[0]+lmn2[1]+lmn2[2],
+                        lmn3[0]+lmn3[1]+lmn3[2], lmn4[0]+lmn4[1]+lmn4[2] };
+
+    /* The bound for the whole primitive quartet also holds for this component */
+    if(cb_bound != NULL)
+    {
+        const int nprim[4] = { 1, 1, 1, 1 };
+        const double * center[4] = { A, B, C, D };
+        const double * alpha[4] = { &alpha1, &alpha2, &alpha3, &alpha4 };
+        const double one = 1.0;
+
+        if(mirp_integral4_negligible(am, center, nprim, alpha, &one, &one, cb_bound))
+        {
+            *integral = 0.0;
+            mirp_exact_stats_record(MIRP_EXACT_SINGLE4, am, 0, 0, 0, 1, stats_start);
+            return;
+        }
+    }
+
+    /* convert arguments to arb_t */
+    arb_ptr A_mp = _arb_vec_init(3);
+    arb_ptr B_mp = _arb_vec_init(3);
+    arb_ptr C_mp = _arb_vec_init(3);
+    arb_ptr D_mp = _arb_vec_init(3);
+
+    arb_t alpha1_mp, alpha2_mp, alpha3_mp, alpha4_mp;
+    arb_init(alpha1_mp);
+    arb_init(alpha2_mp);
+    arb_init(alpha3_mp);
+    arb_init(alpha4_mp);
+
+    arb_set_d(alpha1_mp, alpha1);
+    arb_set_d(alpha2_mp, alpha2);
+    arb_set_d(alpha3_mp, alpha3);
+    arb_set_d(alpha4_mp, alpha4);
+
+    for(int i = 0; i < 3; i++)
+    {
+        arb_set_d(A_mp + i, A[i]);
+        arb_set_d(B_mp + i, B[i]);
+        arb_set_d(C_mp + i, C[i]);
+        arb_set_d(D_mp + i, D[i]);
+    }
+
+    /* Final integral output */
+    arb_t integral_mp;
+    arb_init(integral_mp);
+
+    /* The target precision is the number of bits in
+     * double precision (53) + lots of safety */
+    const slong target_prec = 64;
+
+    /* Start with a precision estimated from the angular momentum,
+     * the exponents, and the arguments of the Boys function */
+    const int L = am[0] + am[1] + am[2] + am[3];
+    const double alpha_min = MIN(MIN(alpha1, alpha2), MIN(alpha3, alpha4));
+    const double alpha_max = MAX(MAX(alpha1, alpha2), MAX(alpha3, alpha4));
+
+    double T_max = 0.0;
+    mirp_boys_arg_range(&T_max, A, &alpha1, 1, B, &alpha2, 1,
+                                C, &alpha3, 1, D, &alpha4, 1);
+
+    slong working_prec = mirp_prec_initial(L, alpha_min, alpha_max, T_max, target_prec);
+    slong min_bits = 0;
+    int initial = 1;
+    int suff_acc = 0;
+    int nrounds = 0;
+
     while(!suff_acc)
     {
-        working_prec += target_prec;
+        if(!initial)
+            working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
+        nrounds++;
 
         /* Call the callback */
         cb(integral_mp,
@@ -365,37 +1488,17 @@ void mirp_integral4_single_exact(double * integral,
            lmn4, D_mp, alpha4_mp,
            working_prec);
 
-        /* Do we have sufficient accuracy? We need at least
-         * 53 bits + 11 bits safety OR the value is zero (has zero precision)
-         * and the error bounds is exactly zero when converted to double precision */
-        slong bits = arb_rel_accuracy_bits(integral_mp);
-
-        suff_acc = 1;
-        if(bits > 0 && bits < target_prec)
-            suff_acc = 0;
-        else if(bits <= 0)
-        {
-            arb_get_ubound_arf(ubound, integral_mp, working_prec);
-            arb_get_lbound_arf(lbound, integral_mp, working_prec);
-
-
-            PRAGMA_WARNING_PUSH
-            PRAGMA_WARNING_IGNORE_FP_UNDERFLOW
-
-            if(arf_cmpabs_d(lbound, MIRP_DBL_TRUE_MIN) > 0 || 
-                arf_cmpabs_d(ubound, MIRP_DBL_TRUE_MIN) > 0)
-                suff_acc = 0; 
-
-            PRAGMA_WARNING_POP
-        }
+        suff_acc = mirp_integral4_accurate(integral_mp, 1, target_prec, working_prec, &min_bits);
+        mirp_prec_record(initial, suff_acc);
+        initial = 0;
     }
 
     /* We get the value from the midpoint of the arb struct */
     *integral = arf_get_d(arb_midref(integral_mp), ARF_RND_NEAR);
 
+    mirp_exact_stats_record(MIRP_EXACT_SINGLE4, am, working_prec, nrounds, nrounds, 1, stats_start);
+
     /* Cleanup */
-    arf_clear(lbound);
-    arf_clear(ubound);
     _arb_vec_clear(A_mp, 3);
     _arb_vec_clear(B_mp, 3);
     _arb_vec_clear(C_mp, 3);
@@ -408,18 +1511,48 @@ void mirp_integral4_single_exact(double * integral,
 }
 
 
-void mirp_integral4_exact(double * integrals,
-                          int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
-                          int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
-                          int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
-                          int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
-                          cb_integral4 cb)
+/*! \brief Compute all cartesian integrals of a contracted shell quartet
+ *         to exact double precision, starting at a fixed low
+ *         precision (four-center)
+ *
+ * The quartet is first computed at \ref MIRP_PREC_FAST bits, and then
+ * (if \p cb_single_dd is given) in double-double arithmetic. Only after
+ * that comes the precision from \ref mirp_prec_initial.
+ *
+ * \copydetails mirp_integral4_exact_fast
+ */
+static void mirp_integral4_exact_tiers(double * integrals,
+                                       int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                                       int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                                       int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
+                                       int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
+                                       cb_integral4_single cb_single_dd,
+                                       cb_integral4 cb, cb_integral4_single cb_single,
+                                       cb_integral4_bound cb_bound)
 {
     assert(am1 >= 0); assert(nprim1 > 0); assert(ngen1 > 0);
     assert(am2 >= 0); assert(nprim2 > 0); assert(ngen2 > 0);
     assert(am3 >= 0); assert(nprim3 > 0); assert(ngen3 > 0);
     assert(am4 >= 0); assert(nprim4 > 0); assert(ngen4 > 0);
 
+    const double stats_start = mirp_exact_stats_start();
+    const int am[4] = { am1, am2, am3, am4 };
+
+    /* Integrals far below the double precision range would otherwise
+     * need many attempts, only to be rounded to zero */
+    if(cb_bound != NULL &&
+       mirp_integral4_shell_negligible(am1, A, nprim1, ngen1, alpha1, coeff1,
+                                       am2, B, nprim2, ngen2, alpha2, coeff2,
+                                       am3, C, nprim3, ngen3, alpha3, coeff3,
+                                       am4, D, nprim4, ngen4, alpha4, coeff4,
+                                       cb_bound))
+    {
+        const long nintegrals = ngen1*ngen2*ngen3*ngen4 * MIRP_NCART4(am1, am2, am3, am4);
+        memset(integrals, 0, nintegrals * sizeof(double));
+        mirp_exact_stats_record(MIRP_EXACT_SHELL4, am, 0, 0, 0, nintegrals, stats_start);
+        return;
+    }
+
     /* convert arguments to arb_t */
     arb_ptr A_mp = _arb_vec_init(3);
     arb_ptr B_mp = _arb_vec_init(3);
@@ -471,66 +1604,129 @@ void mirp_integral4_exact(double * integrals,
     /* The target precision is the number of bits in double precision (53) + safety */
     const slong target_prec = 64;
 
-    slong working_prec = target_prec;
+    /* Start with a precision estimated from the angular momentum,
+     * the exponents, and the arguments of the Boys function */
+    double alpha_min = alpha1[0];
+    double alpha_max = alpha1[0];
+    mirp_exponent_range(&alpha_min, &alpha_max, alpha1, nprim1);
+    mirp_exponent_range(&alpha_min, &alpha_max, alpha2, nprim2);
+    mirp_exponent_range(&alpha_min, &alpha_max, alpha3, nprim3);
+    mirp_exponent_range(&alpha_min, &alpha_max, alpha4, nprim4);
+
+    double T_max = 0.0;
+    mirp_boys_arg_range(&T_max, A, alpha1, nprim1, B, alpha2, nprim2,
+                                C, alpha3, nprim3, D, alpha4, nprim4);
+
+    const slong initial_prec = mirp_prec_initial(am1+am2+am3+am4, alpha_min, alpha_max,
+                                                 T_max, target_prec);
+    slong working_prec = 0;
+    slong min_bits = 0;
     int suff_acc = 0;
 
-    /* for comparisons */
-    arf_t ubound, lbound;
-    arf_init(ubound);
-    arf_init(lbound);
+    /* Integrals that are not yet sufficiently accurate */
+    long * failed = malloc(nintegrals * sizeof(long));
+    long nfailed = nintegrals;
+
+    /* For the escalation statistics */
+    int nrounds = 0;
+    long nevals = 0;
 
     while(!suff_acc)
     {
-        working_prec += target_prec;
+        cb_integral4_single cb_retry = cb_single;
 
-        /* Call the callback */
-        cb(integral_mp,
-           am1, A_mp, nprim1, ngen1, alpha1_mp, coeff1_mp,
-           am2, B_mp, nprim2, ngen2, alpha2_mp, coeff2_mp,
-           am3, C_mp, nprim3, ngen3, alpha3_mp, coeff3_mp,
-           am4, D_mp, nprim4, ngen4, alpha4_mp, coeff4_mp,
-           working_prec);
+        /* The attempts at a fixed low precision are not predictions,
+         * and are counted separately (see mirp_prec_record_fixed) */
+        int fixed = 0;
+        int initial = 0;
 
-        suff_acc = 1;
-        for(long i = 0; i < nintegrals; i++)
+        if(nrounds == 0)
         {
-            /* Do we have sufficient accuracy? We need at least
-             * 53 bits + 11 bits safety OR the value is zero (has zero precision)
-             * and the error bounds is exactly zero when converted to double precision */
-            slong bits = arb_rel_accuracy_bits(integral_mp + i);
+            /* Fast path: a cheap, low-precision interval evaluation. Many
+             * integrals are already determined to double precision */
+            working_prec = MIRP_PREC_FAST;
+            fixed = 1;
+        }
+        else if(cb_single_dd != NULL && working_prec < MIRP_DD_PREC)
+        {
+            /* The failed integrals are then tried in double-double
+             * arithmetic before going to higher precision */
+            working_prec = MIRP_DD_PREC;
+            cb_retry = cb_single_dd;
+            fixed = 1;
+        }
+        else if(working_prec < initial_prec)
+        {
+            working_prec = initial_prec;
+            initial = 1;
+        }
+        else
+            working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
 
-            if(bits > 0 && bits < target_prec)
-                suff_acc = 0;
-            else if(bits <= 0)
-            {
-                arb_get_ubound_arf(ubound, integral_mp + i, working_prec);
-                arb_get_lbound_arf(lbound, integral_mp + i, working_prec);
+        if(nrounds == 0 || cb_retry == NULL)
+        {
+            /* Call the callback for the whole quartet */
+            cb(integral_mp,
+               am1, A_mp, nprim1, ngen1, alpha1_mp, coeff1_mp,
+               am2, B_mp, nprim2, ngen2, alpha2_mp, coeff2_mp,
+               am3, C_mp, nprim3, ngen3, alpha3_mp, coeff3_mp,
+               am4, D_mp, nprim4, ngen4, alpha4_mp, coeff4_mp,
+               working_prec);
+
+            nfailed = nintegrals;
+            for(long i = 0; i < nintegrals; i++)
+                failed[i] = i;
+        }
+        else
+        {
+            /* Only recompute the integrals that failed. The rest
+             * are kept from previous attempts */
+            mirp_integral4_subset(integral_mp, failed, nfailed,
+                                  am1, A_mp, nprim1, ngen1, alpha1_mp, coeff1_mp,
+                                  am2, B_mp, nprim2, ngen2, alpha2_mp, coeff2_mp,
+                                  am3, C_mp, nprim3, ngen3, alpha3_mp, coeff3_mp,
+                                  am4, D_mp, nprim4, ngen4, alpha4_mp, coeff4_mp,
+                                  working_prec, cb_retry);
+        }
 
-                PRAGMA_WARNING_PUSH
-                PRAGMA_WARNING_IGNORE_FP_UNDERFLOW
+        nrounds++;
+        nevals += nfailed;
 
-                if(arf_cmpabs_d(lbound, MIRP_DBL_TRUE_MIN) > 0 || 
-                   arf_cmpabs_d(ubound, MIRP_DBL_TRUE_MIN) > 0)
-                    suff_acc = 0; 
+        /* Check the integrals that were just computed, and
+         * keep the ones that are still not accurate enough */
+        long nstill_failed = 0;
+        min_bits = target_prec;
 
-                PRAGMA_WARNING_POP
-            }
+        for(long i = 0; i < nfailed; i++)
+        {
+            const long idx = failed[i];
+
+            /* At the lowest precision, the interval is rarely accurate to
+             * the target precision. It may still determine the rounded value */
+            if(working_prec == MIRP_PREC_FAST &&
+               mirp_integral4_certify(integrals + idx, integral_mp + idx, working_prec))
+                continue;
+
+            if(mirp_integral4_accurate1(integral_mp + idx, target_prec, working_prec, &min_bits))
+                mirp_integral4_get_d(integrals + idx, integral_mp + idx, 1);
+            else
+                failed[nstill_failed++] = idx;
         }
-    }
 
+        nfailed = nstill_failed;
+        suff_acc = (nfailed == 0);
 
-    /* We get the value from the midpoint of the arb struct */
-    for(long i = 0; i < nintegrals; i++)
-    {
-        if(arb_rel_accuracy_bits(integral_mp + i) <= 0)
-            integrals[i] = 0.0;
+        if(fixed)
+            mirp_prec_record_fixed(suff_acc);
         else
-            integrals[i] = arf_get_d(arb_midref(integral_mp + i), ARF_RND_NEAR);
+            mirp_prec_record(initial, suff_acc);
     }
 
+    free(failed);
+
+    mirp_exact_stats_record(MIRP_EXACT_SHELL4, am, working_prec, nrounds, nevals, nintegrals, stats_start);
+
     /* Cleanup */
-    arf_clear(lbound);
-    arf_clear(ubound);
     _arb_vec_clear(A_mp, 3);
     _arb_vec_clear(B_mp, 3);
     _arb_vec_clear(C_mp, 3);
@@ -546,3 +1742,172 @@ void mirp_integral4_exact(double * integrals,
     _arb_vec_clear(integral_mp, nintegrals);
 }
 
+
+void mirp_integral4_exact_fast(double * integrals,
+                               int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                               int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                               int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
+                               int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
+                               cb_integral4_single cb_single_dd,
+                               cb_integral4 cb, cb_integral4_single cb_single,
+                               cb_integral4_bound cb_bound)
+{
+    mirp_integral4_exact_tiers(integrals,
+                               am1, A, nprim1, ngen1, alpha1, coeff1,
+                               am2, B, nprim2, ngen2, alpha2, coeff2,
+                               am3, C, nprim3, ngen3, alpha3, coeff3,
+                               am4, D, nprim4, ngen4, alpha4, coeff4,
+                               cb_single_dd, cb, cb_single, cb_bound);
+}
+
+
+void mirp_integral4_exact_refine(double * integrals,
+                                 int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                                 int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                                 int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
+                                 int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
+                                 cb_integral4 cb, cb_integral4_single cb_single,
+                                 cb_integral4_bound cb_bound)
+{
+    mirp_integral4_exact_tiers(integrals,
+                               am1, A, nprim1, ngen1, alpha1, coeff1,
+                               am2, B, nprim2, ngen2, alpha2, coeff2,
+                               am3, C, nprim3, ngen3, alpha3, coeff3,
+                               am4, D, nprim4, ngen4, alpha4, coeff4,
+                               NULL, cb, cb_single, cb_bound);
+}
+
+
+void mirp_integral4_exact(double * integrals,
+                          int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                          int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                          int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
+                          int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
+                          cb_integral4 cb, cb_integral4_bound cb_bound)
+{
+    mirp_integral4_exact_refine(integrals,
+                                am1, A, nprim1, ngen1, alpha1, coeff1,
+                                am2, B, nprim2, ngen2, alpha2, coeff2,
+                                am3, C, nprim3, ngen3, alpha3, coeff3,
+                                am4, D, nprim4, ngen4, alpha4, coeff4,
+                                cb, NULL, cb_bound);
+}
+
+
+void mirp_integral4_shellpair_exact(double * integrals,
+                                    const mirp_shellpair * bra,
+                                    const mirp_shellpair * ket,
+                                    cb_integral4_shellpair cb,
+                                    cb_integral4_bound cb_bound)
+{
+    const double stats_start = mirp_exact_stats_start();
+    const int am[4] = { bra->am1, bra->am2, ket->am1, ket->am2 };
+
+    const long ngen = bra->ngen1 * bra->ngen2 * ket->ngen1 * ket->ngen2;
+    const long ncart = MIRP_NCART4(bra->am1, bra->am2, ket->am1, ket->am2);
+    const long nintegrals = ngen*ncart;
+
+    /* Integrals far below the double precision range are zero */
+    if(cb_bound != NULL && mirp_integral4_shellpair_negligible(bra, ket, cb_bound))
+    {
+        memset(integrals, 0, nintegrals * sizeof(double));
+        mirp_exact_stats_record(MIRP_EXACT_SHELL4, am, 0, 0, 0, nintegrals, stats_start);
+        return;
+    }
+
+    arb_ptr integral_mp = _arb_vec_init(nintegrals);
+
+    /* The target precision is the number of bits in double precision (53) + safety */
+    const slong target_prec = 64;
+
+    /* Start with a precision estimated from the angular momentum,
+     * the exponents, and the arguments of the Boys function */
+    const mirp_shellpair * pairs[2] = { bra, ket };
+    double alpha_min = arf_get_d(arb_midref(bra->alpha1), ARF_RND_NEAR);
+    double alpha_max = alpha_min;
+
+    for(int p = 0; p < 2; p++)
+    {
+        for(int i = 0; i < pairs[p]->nprim1; i++)
+        {
+            const double a = arf_get_d(arb_midref(pairs[p]->alpha1 + i), ARF_RND_NEAR);
+            mirp_exponent_range(&alpha_min, &alpha_max, &a, 1);
+        }
+        for(int i = 0; i < pairs[p]->nprim2; i++)
+        {
+            const double a = arf_get_d(arb_midref(pairs[p]->alpha2 + i), ARF_RND_NEAR);
+            mirp_exponent_range(&alpha_min, &alpha_max, &a, 1);
+        }
+    }
+
+    /* The pairs already contain the centers and exponents
+     * of the product gaussians */
+    double T_max = 0.0;
+    const long nprim12 = bra->nprim1 * bra->nprim2;
+    const long nprim34 = ket->nprim1 * ket->nprim2;
+
+    for(long ij = 0; ij < nprim12; ij++)
+    for(long kl = 0; kl < nprim34; kl++)
+    {
+        const double p = arf_get_d(arb_midref(bra->gamma + ij), ARF_RND_NEAR);
+        const double q = arf_get_d(arb_midref(ket->gamma + kl), ARF_RND_NEAR);
+        double PQ2 = 0.0;
+        for(int x = 0; x < 3; x++)
+        {
+            const double PQ = arf_get_d(arb_midref(bra->P + 3*ij + x), ARF_RND_NEAR)
+                            - arf_get_d(arb_midref(ket->P + 3*kl + x), ARF_RND_NEAR);
+            PQ2 += PQ*PQ;
+        }
+
+        T_max = MAX(T_max, PQ2 * p*q/(p+q));
+    }
+
+    const int L = bra->am1 + bra->am2 + ket->am1 + ket->am2;
+    slong working_prec = mirp_prec_initial(L, alpha_min, alpha_max, T_max, target_prec);
+    slong min_bits = 0;
+    int initial = 1;
+    int suff_acc = 0;
+    int nrounds = 0;
+
+    while(!suff_acc)
+    {
+        if(!initial)
+            working_prec = mirp_prec_next(working_prec, min_bits, target_prec);
+        nrounds++;
+
+        /* The pairs can be used directly if they were built with
+         * (at least) this precision. Otherwise, rebuild them */
+        mirp_shellpair bra_tmp, ket_tmp;
+        const mirp_shellpair * bra_prec = bra;
+        const mirp_shellpair * ket_prec = ket;
+
+        if(bra->working_prec < working_prec)
+        {
+            mirp_shellpair_init_from(&bra_tmp, bra, working_prec);
+            bra_prec = &bra_tmp;
+        }
+        if(ket->working_prec < working_prec)
+        {
+            mirp_shellpair_init_from(&ket_tmp, ket, working_prec);
+            ket_prec = &ket_tmp;
+        }
+
+        cb(integral_mp, bra_prec, ket_prec, working_prec);
+
+        if(bra_prec != bra)
+            mirp_shellpair_clear(&bra_tmp);
+        if(ket_prec != ket)
+            mirp_shellpair_clear(&ket_tmp);
+
+        suff_acc = mirp_integral4_accurate(integral_mp, nintegrals, target_prec, working_prec, &min_bits);
+        mirp_prec_record(initial, suff_acc);
+        initial = 0;
+    }
+
+    mirp_integral4_get_d(integrals, integral_mp, nintegrals);
+
+    mirp_exact_stats_record(MIRP_EXACT_SHELL4, am, working_prec, nrounds,
+                            nrounds*nintegrals, nintegrals, stats_start);
+
+    _arb_vec_clear(integral_mp, nintegrals);
+}
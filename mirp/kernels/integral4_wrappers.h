@@ -61,21 +61,87 @@ void mirp_integral4_single_str(arb_t integral,
  * \param [in]  cb
  *              Function that computes a single cartesian four-center integral
  *              with interval arithmetic
+ * \param [in]  cb_bound
+ *              Function that bounds the integrals of a primitive quartet
+ *              (see \ref cb_integral4_bound). If the bound shows that all
+ *              integrals round to zero in double precision, they are not
+ *              computed. May be NULL.
  */
 void mirp_integral4_single_exact(double * integral,
                                  const int * lmn1, const double * A, double alpha1,
                                  const int * lmn2, const double * B, double alpha2,
                                  const int * lmn3, const double * C, double alpha3,
                                  const int * lmn4, const double * D, double alpha4,
-                                 cb_integral4_single cb);
+                                 cb_integral4_single cb, cb_integral4_bound cb_bound);
+
+
+/*! \brief Compute all cartesian components of a primitive shell quartet
+ *         one component at a time (four-center, interval arithmetic)
+ *
+ * This function takes in a pointer to a function that computes single,
+ * primitive cartesian integrals, and calls it once for every cartesian
+ * component of the primitive quartet. Kernels that do not have a native
+ * implementation for a whole primitive quartet can use this (via
+ * \ref MIRP_WRAP_PRIM4).
+ *
+ * The \p integrals buffer is expected to be able to hold all primitive integrals
+ * (ie, it can hold ncart(am1) * ncart(am2) * ncart(am3) * ncart(am4) elements).
+ *
+ * \param [out] integrals
+ *              Output for the computed integrals
+ * \param [in]  am1,am2,am3,am4
+ *              Angular momentum of the four centers
+ * \param [in]  A,B,C,D
+ *              XYZ coordinates of the four centers (each of length 3)
+ * \param [in]  alpha1,alpha2,alpha3,alpha4
+ *              Exponents of the gaussian on the four centers
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ * \param [in]  cb
+ *              Function that computes a single cartesian four-center integral
+ *              with interval arithmetic
+ */
+void mirp_cartloop4(arb_ptr integrals,
+                    int am1, arb_srcptr A, const arb_t alpha1,
+                    int am2, arb_srcptr B, const arb_t alpha2,
+                    int am3, arb_srcptr C, const arb_t alpha3,
+                    int am4, arb_srcptr D, const arb_t alpha4,
+                    slong working_prec, cb_integral4_single cb);
+
+
+/*! \brief Compute all cartesian components of a primitive shell quartet
+ *         one component at a time, reusing temporaries (four-center,
+ *         interval arithmetic)
+ *
+ * This is the same as \ref mirp_cartloop4, however the function computing
+ * single cartesian integrals takes a workspace (see \ref mirp_workspace).
+ * Each thread uses a single workspace for all the components it computes,
+ * which it keeps between calls (see \ref mirp_workspace_local_get).
+ *
+ * \copydetails mirp_cartloop4
+ */
+void mirp_cartloop4_ws(arb_ptr integrals,
+                       int am1, arb_srcptr A, const arb_t alpha1,
+                       int am2, arb_srcptr B, const arb_t alpha2,
+                       int am3, arb_srcptr C, const arb_t alpha3,
+                       int am4, arb_srcptr D, const arb_t alpha4,
+                       slong working_prec, cb_integral4_single_ws cb);
 
 
 /*! \brief Compute all cartesian integrals of a contracted shell quartet
  *         for an integral (four-center, interval arithmetic)
  *
- * This function takes in a pointer to a function that computes single,
- * primitive cartesian integrals, and uses it to compute all the cartesian
- * components for an contracted shell quartet.
+ * This function takes in a pointer to a function that computes all the
+ * cartesian components of a primitive shell quartet, and uses it to compute
+ * all the cartesian components for an contracted shell quartet.
+ *
+ * If some of the shells are identical (same angular momentum, center, exponents,
+ * and coefficients), each symmetry-unique primitive quartet is only computed
+ * once. The integrals of the remaining primitive quartets are obtained by
+ * permuting its cartesian components. Components of a primitive quartet that
+ * are equal by symmetry are computed separately by \p cb; use
+ * \ref mirp_integral4_idx to compute them only once.
  *
  * \param [out] integrals
  *              Output for the computed integral
@@ -95,8 +161,8 @@ void mirp_integral4_single_exact(double * integral,
  *              for each shell (of lengths \p nprim1 * \p ngen1, \p nprim2 * \p ngen2,
  *              \p nprim3 * \p ngen3, \p nprim4 * \p ngen4 respectively)
  * \param [in]  cb
- *              Function that computes a single cartesian four-center integral
- *              with interval arithmetic
+ *              Function that computes all cartesian components of a primitive
+ *              four-center shell quartet with interval arithmetic
  * \param [in]  working_prec
  *              The working precision (binary digits/bits) to use
  *              in the calculation
@@ -106,7 +172,64 @@ void mirp_integral4(arb_ptr integrals,
                     int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
                     int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3,
                     int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4,
-                    slong working_prec, cb_integral4_single cb);
+                    slong working_prec, cb_integral4_prim cb);
+
+
+/*! \brief Compute all cartesian integrals of a contracted shell quartet,
+ *         computing only the symmetry-unique components of each
+ *         primitive quartet (four-center, interval arithmetic)
+ *
+ * This is the same as \ref mirp_integral4, however \p cb can compute
+ * a subset of the components of a primitive quartet. If a primitive quartet
+ * is mapped onto itself by a permutation of identical shells (such as
+ * (i i | k l) or (i j | i j)), only one of each set of components related
+ * by the permutation is computed. The others are copied from it.
+ *
+ * \p cb also takes its temporaries from workspaces (one for each thread),
+ * which are reused for all the primitive quartets and kept between
+ * calls (see \ref mirp_workspace_local_get).
+ *
+ * \copydetails mirp_integral4
+ * \param [in]  cb
+ *              Function that computes the given cartesian components of a primitive
+ *              four-center shell quartet with interval arithmetic
+ */
+void mirp_integral4_idx(arb_ptr integrals,
+                        int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                        int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                        int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3,
+                        int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4,
+                        slong working_prec, cb_integral4_prim_idx cb);
+
+
+/*! \brief Compute some of the cartesian integrals of a contracted shell quartet
+ *         (four-center, interval arithmetic)
+ *
+ * Only the integrals with the indices given in \p idx are computed. Each
+ * is contracted from single cartesian integrals of the primitives. The
+ * remaining elements of \p integrals are not touched.
+ *
+ * The index of an integral is the same as its position in the output
+ * of \ref mirp_integral4.
+ *
+ * \param [inout] integrals
+ *                Output for the computed integrals (the full quartet)
+ * \param [in]    idx
+ *                Indices of the integrals to compute
+ * \param [in]    nidx
+ *                Number of indices in \p idx
+ * \param [in]    cb
+ *                Function that computes a single cartesian four-center integral
+ *                with interval arithmetic
+ *
+ * See \ref mirp_integral4 for the remaining parameters
+ */
+void mirp_integral4_subset(arb_ptr integrals, const long * idx, long nidx,
+                           int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                           int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                           int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3,
+                           int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4,
+                           slong working_prec, cb_integral4_single cb);
 
 
 /*! \brief Compute a single 4-center integral to a target precision (string input)
@@ -145,6 +268,60 @@ void mirp_integral4_str(arb_ptr integrals,
                         slong working_prec, cb_integral4 cb);
 
 
+/*! \brief Compute a single 4-center integral to a number of decimal
+ *         digits (string input)
+ *
+ * The working precision starts at a value estimated from \p ndigits, the angular
+ * momentum and the exponents, and is raised only until the integral is accurate
+ * enough (see \ref mirp_prec_target_reached). The inputs are converted again
+ * at each working precision, so the result can always be made accurate enough.
+ *
+ * \param [out] integral
+ *              Output for the computed integral
+ * \param [in]  ndigits
+ *              Number of decimal digits wanted in the result
+ * \param [in]  cb
+ *              Function that computes a single cartesian four-center integral
+ *              from string inputs
+ * \return The working precision of the last attempt. If this is larger than
+ *         \ref MIRP_PREC_TARGET_MAX, the integral may not be accurate enough.
+ *
+ * See \ref mirp_integral4_single_str for the remaining parameters
+ */
+slong mirp_integral4_single_target(arb_t integral,
+                                   const int * lmn1, const char ** A, const char * alpha1,
+                                   const int * lmn2, const char ** B, const char * alpha2,
+                                   const int * lmn3, const char ** C, const char * alpha3,
+                                   const int * lmn4, const char ** D, const char * alpha4,
+                                   long ndigits, cb_integral4_single_str cb);
+
+
+/*! \brief Compute all cartesian integrals of a contracted shell quartet
+ *         to a number of decimal digits (string input)
+ *
+ * The whole quartet is computed again at a higher working precision as long
+ * as any of its integrals is not accurate enough.
+ *
+ * \param [out] integrals
+ *              Output for the computed integrals
+ * \param [in]  ndigits
+ *              Number of decimal digits wanted in the results
+ * \param [in]  cb
+ *              Function that computes all cartesian integrals of a contracted
+ *              four-center shell quartet from string inputs
+ * \return The working precision of the last attempt (see
+ *         \ref mirp_integral4_single_target)
+ *
+ * See \ref mirp_integral4_str for the remaining parameters
+ */
+slong mirp_integral4_target(arb_ptr integrals,
+                            int am1, const char ** A, int nprim1, int ngen1, const char ** alpha1, const char ** coeff1,
+                            int am2, const char ** B, int nprim2, int ngen2, const char ** alpha2, const char ** coeff2,
+                            int am3, const char ** C, int nprim3, int ngen3, const char ** alpha3, const char ** coeff3,
+                            int am4, const char ** D, int nprim4, int ngen4, const char ** alpha4, const char ** coeff4,
+                            long ndigits, cb_integral4_str cb);
+
+
 /*! \brief Compute all cartesian integrals of a contracted shell quartet
  *         for an integral to exact double precision (four-center)
  *
@@ -152,6 +329,14 @@ void mirp_integral4_str(arb_ptr integrals,
  * as output. Internally, it uses interval arithmetic to ensure that no
  * precision is lost
  *
+ * The integrals are first computed at a low working precision
+ * (\ref MIRP_PREC_FAST). If both bounds of an interval round to the
+ * same double precision value, that is the correctly-rounded value of the
+ * integral and is returned. Otherwise, the working precision is raised,
+ * starting at the precision from \ref mirp_prec_initial. The attempt at
+ * the fixed low precision is not counted as a precision prediction
+ * (see \ref mirp_prec_record_fixed).
+ *
  * \param [out] integrals
  *              Output for the computed integrals
  * \param [in]  am1,am2,am3,am4
@@ -170,15 +355,130 @@ void mirp_integral4_str(arb_ptr integrals,
  *              for each shell (of lengths \p nprim1 * \p ngen1, \p nprim2 * \p ngen2,
  *              \p nprim3 * \p ngen3, \p nprim4 * \p ngen4 respectively)
  * \param [in]  cb
- *              Function that computes a single cartesian four-center integral
- *              with interval arithmetic
+ *              Function that computes all cartesian integrals of a contracted
+ *              four-center shell quartet with interval arithmetic
+ * \param [in]  cb_bound
+ *              Function that bounds the integrals of a primitive quartet
+ *              (see \ref cb_integral4_bound). If the bound shows that all
+ *              integrals round to zero in double precision, they are not
+ *              computed. May be NULL.
  */
 void mirp_integral4_exact(double * integrals,
                           int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
                           int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
                           int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
                           int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
-                          cb_integral4 cb);
+                          cb_integral4 cb, cb_integral4_bound cb_bound);
+
+
+/*! \brief Compute all cartesian integrals of a contracted shell quartet
+ *         for an integral to exact double precision, recomputing
+ *         only the integrals that are not accurate enough (four-center)
+ *
+ * This is the same as \ref mirp_integral4_exact, however after the first
+ * attempt, only the integrals that did not have sufficient accuracy are
+ * computed again (with \p cb_single, see \ref mirp_integral4_subset).
+ * Integrals that are already accurate enough are kept.
+ *
+ * If \p cb_single is NULL, the whole quartet is computed on every attempt.
+ *
+ * \copydetails mirp_integral4_exact
+ * \param [in]  cb_single
+ *              Function that computes a single cartesian four-center integral
+ *              with interval arithmetic
+ */
+void mirp_integral4_exact_refine(double * integrals,
+                                 int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                                 int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                                 int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
+                                 int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
+                                 cb_integral4 cb, cb_integral4_single cb_single,
+                                 cb_integral4_bound cb_bound);
+
+
+/*! \brief Compute all cartesian integrals of a contracted shell quartet
+ *         for an integral to exact double precision, trying
+ *         double-double arithmetic before higher precisions (four-center)
+ *
+ * This is the same as \ref mirp_integral4_exact_refine, however if \p cb_single_dd
+ * is given, the integrals that fail the attempt at \ref MIRP_PREC_FAST are then
+ * computed with it (double-double arithmetic, see \ref mirp_dd) before
+ * moving on to interval arithmetic at higher precision. Since its error bounds
+ * are rigorous, its results are checked just like any other attempt.
+ *
+ * The attempts at these fixed low precisions are not counted as precision
+ * predictions (see \ref mirp_prec_record_fixed).
+ *
+ * \copydetails mirp_integral4_exact_refine
+ * \param [in]  cb_single_dd
+ *              Function that computes a single cartesian four-center integral
+ *              in double-double arithmetic (may be NULL)
+ */
+void mirp_integral4_exact_fast(double * integrals,
+                               int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                               int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                               int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3,
+                               int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4,
+                               cb_integral4_single cb_single_dd,
+                               cb_integral4 cb, cb_integral4_single cb_single,
+                               cb_integral4_bound cb_bound);
+
+
+/*! \brief Compute all cartesian integrals of a contracted shell quartet
+ *         from precomputed shell pairs (four-center, interval arithmetic)
+ *
+ * This is similar to \ref mirp_integral4, however the terms that only depend
+ * on a pair of shells (Gaussian Product Theorem, normalized coefficients) are
+ * taken from \p bra and \p ket rather than being recomputed. The shells
+ * of the quartet are (bra shell 1, bra shell 2 | ket shell 1, ket shell 2).
+ * As with \ref mirp_integral4_idx, only the symmetry-unique components of
+ * each primitive quartet are computed.
+ *
+ * The pairs should have been built with (at least) \p working_prec.
+ *
+ * \param [out] integrals
+ *              Output for the computed integrals
+ * \param [in]  bra,ket
+ *              The two pairs of shells making up the quartet
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ * \param [in]  cb
+ *              Function that computes the given cartesian components of a primitive
+ *              four-center shell quartet from shell pairs with interval arithmetic
+ */
+void mirp_integral4_shellpair(arb_ptr integrals,
+                              const mirp_shellpair * bra,
+                              const mirp_shellpair * ket,
+                              slong working_prec, cb_integral4_shellpair_prim cb);
+
+
+/*! \brief Compute all cartesian integrals of a contracted shell quartet
+ *         from precomputed shell pairs to exact double precision (four-center)
+ *
+ * If the pairs were built with a precision lower than what is needed for
+ * a particular step, they are temporarily rebuilt at the higher precision.
+ * Building the pairs with 128 bits (the first precision that is tried)
+ * means they are reused directly in most cases.
+ *
+ * \param [out] integrals
+ *              Output for the computed integrals
+ * \param [in]  bra,ket
+ *              The two pairs of shells making up the quartet
+ * \param [in]  cb
+ *              Function that computes all cartesian integrals of a contracted
+ *              shell quartet from shell pairs with interval arithmetic
+ * \param [in]  cb_bound
+ *              Function that bounds the integrals of a primitive quartet
+ *              (see \ref cb_integral4_bound). If the bound shows that all
+ *              integrals round to zero in double precision, they are not
+ *              computed. May be NULL.
+ */
+void mirp_integral4_shellpair_exact(double * integrals,
+                                    const mirp_shellpair * bra,
+                                    const mirp_shellpair * ket,
+                                    cb_integral4_shellpair cb,
+                                    cb_integral4_bound cb_bound);
 
 
 /*! \brief Create a function that computes single cartesian integrals
@@ -210,12 +510,44 @@ void mirp_integral4_exact(double * integrals,
     }
 
 
+/*! \brief Create a function that computes single cartesian integrals
+ *         from string arguments to a number of decimal digits (four-center)
+ *
+ *  A function computing single cartesian integrals from string arguments
+ *  is expected to exist and be named `mirp_{name}_single_str`
+ *
+ *  The created function is named `mirp_{name}_single_target`.
+ *
+ *  \sa mirp_integral4_single_target
+ */
+#define MIRP_WRAP_SINGLE4_TARGET(name) \
+    static inline \
+    slong mirp_##name##_single_target(arb_t integral, \
+                                      const int * lmn1, const char ** A, const char * alpha1, \
+                                      const int * lmn2, const char ** B, const char * alpha2, \
+                                      const int * lmn3, const char ** C, const char * alpha3, \
+                                      const int * lmn4, const char ** D, const char * alpha4, \
+                                      long ndigits) \
+    { \
+        return mirp_integral4_single_target(integral, \
+                                            lmn1, A, alpha1, \
+                                            lmn2, B, alpha2, \
+                                            lmn3, C, alpha3, \
+                                            lmn4, D, alpha4, \
+                                            ndigits, \
+                                            mirp_##name##_single_str); \
+    }
+
+
 /*! \brief Create a function that computes single cartesian integrals
  *         to exact double precision (four-center)
  *
  *  A function computing single cartesian integrals is
  *  expected to exist and be named `mirp_{name}_single`
  *
+ *  A function bounding the integrals of a primitive quartet is also
+ *  expected to exist and be named `mirp_{name}_bound` (see \ref cb_integral4_bound).
+ *
  *  The created function is named `mirp_{name}_single_exact`.
  *
  *  \sa mirp_integral4_single_exact
@@ -233,15 +565,73 @@ void mirp_integral4_exact(double * integrals,
                                     lmn2, B, alpha2, \
                                     lmn3, C, alpha3, \
                                     lmn4, D, alpha4, \
-                                    mirp_##name##_single); \
+                                    mirp_##name##_single, mirp_##name##_bound); \
     }
 
 
 /*! \brief Create a function that computes all cartesian integrals
- *         of a contracted shell quartet (four-center, interval arithmetic)
+ *         of a primitive shell quartet (four-center, interval arithmetic)
  *
  *  A function computing single cartesian integrals is expected to exist and
- *  be named `mirp_{name}_single`
+ *  be named `mirp_{name}_single`. Kernels that can share work between the
+ *  cartesian components should implement `mirp_{name}_prim` directly instead.
+ *
+ *  The created function is named `mirp_{name}_prim`.
+ *
+ *  \sa mirp_cartloop4
+ */
+#define MIRP_WRAP_PRIM4(name) \
+    static inline \
+    void mirp_##name##_prim(arb_ptr integrals, \
+                            int am1, arb_srcptr A, const arb_t alpha1, \
+                            int am2, arb_srcptr B, const arb_t alpha2, \
+                            int am3, arb_srcptr C, const arb_t alpha3, \
+                            int am4, arb_srcptr D, const arb_t alpha4, \
+                            slong working_prec) \
+    { \
+        mirp_cartloop4(integrals, \
+                       am1, A, alpha1, \
+                       am2, B, alpha2, \
+                       am3, C, alpha3, \
+                       am4, D, alpha4, \
+                       working_prec, mirp_##name##_single); \
+    }
+
+
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a primitive shell quartet, reusing temporaries
+ *         (four-center, interval arithmetic)
+ *
+ *  A function computing single cartesian integrals with a workspace
+ *  is expected to exist and be named `mirp_{name}_single_ws`.
+ *
+ *  The created function is named `mirp_{name}_prim`.
+ *
+ *  \sa mirp_cartloop4_ws
+ */
+#define MIRP_WRAP_PRIM4_WS(name) \
+    static inline \
+    void mirp_##name##_prim(arb_ptr integrals, \
+                            int am1, arb_srcptr A, const arb_t alpha1, \
+                            int am2, arb_srcptr B, const arb_t alpha2, \
+                            int am3, arb_srcptr C, const arb_t alpha3, \
+                            int am4, arb_srcptr D, const arb_t alpha4, \
+                            slong working_prec) \
+    { \
+        mirp_cartloop4_ws(integrals, \
+                          am1, A, alpha1, \
+                          am2, B, alpha2, \
+                          am3, C, alpha3, \
+                          am4, D, alpha4, \
+                          working_prec, mirp_##name##_single_ws); \
+    }
+
+
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a contracted shell quartet (four-center, interval arithmetic)
+ *
+ *  A function computing all cartesian integrals of a primitive shell quartet
+ *  is expected to exist and be named `mirp_{name}_prim`
  *
  *  The created function is named `mirp_{name}`.
  *
@@ -261,7 +651,37 @@ void mirp_integral4_exact(double * integrals,
                        am2, B, nprim2, ngen2, alpha2, coeff2, \
                        am3, C, nprim3, ngen3, alpha3, coeff3, \
                        am4, D, nprim4, ngen4, alpha4, coeff4, \
-                       working_prec, mirp_##name##_single); \
+                       working_prec, mirp_##name##_prim); \
+    }
+
+
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a contracted shell quartet, computing only the symmetry-unique
+ *         components of each primitive quartet (four-center)
+ *
+ *  A function computing some of the cartesian integrals of a primitive
+ *  shell quartet is expected to exist and be named `mirp_{name}_prim_idx`
+ *  (see \ref cb_integral4_prim_idx).
+ *
+ *  The created function is named `mirp_{name}`.
+ *
+ *  \sa mirp_integral4_idx
+ */
+#define MIRP_WRAP_SHELL4_IDX(name) \
+    static inline \
+    void mirp_##name(arb_t integrals, \
+                     int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1, \
+                     int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2, \
+                     int am3, arb_srcptr C, int nprim3, int ngen3, arb_srcptr alpha3, arb_srcptr coeff3, \
+                     int am4, arb_srcptr D, int nprim4, int ngen4, arb_srcptr alpha4, arb_srcptr coeff4, \
+                     slong working_prec) \
+    { \
+        mirp_integral4_idx(integrals, \
+                           am1, A, nprim1, ngen1, alpha1, coeff1, \
+                           am2, B, nprim2, ngen2, alpha2, coeff2, \
+                           am3, C, nprim3, ngen3, alpha3, coeff3, \
+                           am4, D, nprim4, ngen4, alpha4, coeff4, \
+                           working_prec, mirp_##name##_prim_idx); \
     }
 
 
@@ -295,12 +715,45 @@ void mirp_integral4_exact(double * integrals,
     }
 
 
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a contracted shell quartet from string arguments
+ *         to a number of decimal digits (four-center)
+ *
+ *  A function computing all cartesian integrals of a contracted shell quartet
+ *  from string arguments is expected to exist and be named `mirp_{name}_str`
+ *
+ *  The created function is named `mirp_{name}_target`.
+ *
+ *  \sa mirp_integral4_target
+ */
+#define MIRP_WRAP_SHELL4_TARGET(name) \
+    static inline \
+    slong mirp_##name##_target(arb_ptr integrals, \
+                               int am1, const char ** A, int nprim1, int ngen1, const char ** alpha1, const char ** coeff1, \
+                               int am2, const char ** B, int nprim2, int ngen2, const char ** alpha2, const char ** coeff2, \
+                               int am3, const char ** C, int nprim3, int ngen3, const char ** alpha3, const char ** coeff3, \
+                               int am4, const char ** D, int nprim4, int ngen4, const char ** alpha4, const char ** coeff4, \
+                               long ndigits) \
+    { \
+        return mirp_integral4_target(integrals, \
+                                     am1, A, nprim1, ngen1, alpha1, coeff1, \
+                                     am2, B, nprim2, ngen2, alpha2, coeff2, \
+                                     am3, C, nprim3, ngen3, alpha3, coeff3, \
+                                     am4, D, nprim4, ngen4, alpha4, coeff4, \
+                                     ndigits, \
+                                     mirp_##name##_str); \
+    }
+
+
 /*! \brief Create a function that computes all cartesian integrals
  *         of a contracted shell quartet to exact double precision (four-center)
  *
  *  A function computing all cartesian integrals of a contracted shell quartet
  *  is expected to exist and be named `mirp_{name}`
  *
+ *  A function bounding the integrals of a primitive quartet is also
+ *  expected to exist and be named `mirp_{name}_bound` (see \ref cb_integral4_bound).
+ *
  *  The created function is named `mirp_{name}_exact`.
  *
  *  \sa mirp_integral4_exact
@@ -318,7 +771,125 @@ void mirp_integral4_exact(double * integrals,
                              am2, B, nprim2, ngen2, alpha2, coeff2, \
                              am3, C, nprim3, ngen3, alpha3, coeff3, \
                              am4, D, nprim4, ngen4, alpha4, coeff4, \
-                             mirp_##name); \
+                             mirp_##name, mirp_##name##_bound); \
+    }
+
+
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a contracted shell quartet to exact double precision,
+ *         recomputing only inaccurate integrals (four-center)
+ *
+ *  Functions computing all cartesian integrals of a contracted shell quartet
+ *  and single cartesian integrals are expected to exist and be named `mirp_{name}`
+ *  and `mirp_{name}_single`.
+ *
+ *  A function bounding the integrals of a primitive quartet is also
+ *  expected to exist and be named `mirp_{name}_bound` (see \ref cb_integral4_bound).
+ *
+ *  The created function is named `mirp_{name}_exact`.
+ *
+ *  \sa mirp_integral4_exact_refine
+ */
+#define MIRP_WRAP_SHELL4_EXACT_REFINE(name) \
+    static inline \
+    void mirp_##name##_exact(double * integrals, \
+                             int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1, \
+                             int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2, \
+                             int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3, \
+                             int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4) \
+    { \
+        mirp_integral4_exact_refine(integrals, \
+                                    am1, A, nprim1, ngen1, alpha1, coeff1, \
+                                    am2, B, nprim2, ngen2, alpha2, coeff2, \
+                                    am3, C, nprim3, ngen3, alpha3, coeff3, \
+                                    am4, D, nprim4, ngen4, alpha4, coeff4, \
+                                    mirp_##name, mirp_##name##_single, \
+                                    mirp_##name##_bound); \
+    }
+
+
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a contracted shell quartet to exact double precision,
+ *         trying double-double arithmetic before higher precisions (four-center)
+ *
+ *  A function computing all cartesian integrals of a contracted shell quartet
+ *  in interval arithmetic, and functions computing single cartesian integrals
+ *  in interval and double-double arithmetic, are expected to exist and be named
+ *  `mirp_{name}`, `mirp_{name}_single`, and `mirp_{name}_single_dd`.
+ *
+ *  A function bounding the integrals of a primitive quartet is also
+ *  expected to exist and be named `mirp_{name}_bound` (see \ref cb_integral4_bound).
+ *
+ *  The created function is named `mirp_{name}_exact`.
+ *
+ *  \sa mirp_integral4_exact_fast
+ */
+#define MIRP_WRAP_SHELL4_EXACT_FAST(name) \
+    static inline \
+    void mirp_##name##_exact(double * integrals, \
+                             int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1, \
+                             int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2, \
+                             int am3, const double * C, int nprim3, int ngen3, const double * alpha3, const double * coeff3, \
+                             int am4, const double * D, int nprim4, int ngen4, const double * alpha4, const double * coeff4) \
+    { \
+        mirp_integral4_exact_fast(integrals, \
+                                  am1, A, nprim1, ngen1, alpha1, coeff1, \
+                                  am2, B, nprim2, ngen2, alpha2, coeff2, \
+                                  am3, C, nprim3, ngen3, alpha3, coeff3, \
+                                  am4, D, nprim4, ngen4, alpha4, coeff4, \
+                                  mirp_##name##_single_dd, \
+                                  mirp_##name, mirp_##name##_single, \
+                                  mirp_##name##_bound); \
+    }
+
+
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a contracted shell quartet from precomputed shell pairs
+ *         (four-center, interval arithmetic)
+ *
+ *  A function computing the given cartesian integrals of a primitive shell quartet
+ *  from shell pairs is expected to exist and be named `mirp_{name}_shellpair_prim`
+ *  (see \ref cb_integral4_shellpair_prim)
+ *
+ *  The created function is named `mirp_{name}_shellpair`.
+ *
+ *  \sa mirp_integral4_shellpair
+ */
+#define MIRP_WRAP_SHELLPAIR4(name) \
+    static inline \
+    void mirp_##name##_shellpair(arb_ptr integrals, \
+                                 const mirp_shellpair * bra, \
+                                 const mirp_shellpair * ket, \
+                                 slong working_prec) \
+    { \
+        mirp_integral4_shellpair(integrals, bra, ket, working_prec, \
+                                 mirp_##name##_shellpair_prim); \
+    }
+
+
+/*! \brief Create a function that computes all cartesian integrals
+ *         of a contracted shell quartet from precomputed shell pairs
+ *         to exact double precision (four-center)
+ *
+ *  A function computing all cartesian integrals of a contracted shell quartet
+ *  from shell pairs is expected to exist and be named `mirp_{name}_shellpair`
+ *
+ *  A function bounding the integrals of a primitive quartet is also
+ *  expected to exist and be named `mirp_{name}_bound` (see \ref cb_integral4_bound).
+ *
+ *  The created function is named `mirp_{name}_shellpair_exact`.
+ *
+ *  \sa mirp_integral4_shellpair_exact
+ */
+#define MIRP_WRAP_SHELLPAIR4_EXACT(name) \
+    static inline \
+    void mirp_##name##_shellpair_exact(double * integrals, \
+                                       const mirp_shellpair * bra, \
+                                       const mirp_shellpair * ket) \
+    { \
+        mirp_integral4_shellpair_exact(integrals, bra, ket, \
+                                       mirp_##name##_shellpair, \
+                                       mirp_##name##_bound); \
     }
 
 
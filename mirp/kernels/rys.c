@@ -0,0 +1,332 @@
+/*! \file
+ *
+ * \brief Calculation of Rys quadrature roots and weights
+ */
+
+#include "mirp/kernels/rys.h"
+#include "mirp/kernels/boys.h"
+#include <assert.h>
+
+
+/*! \brief Evaluates the monic orthogonal polynomials p_0 through p_n
+ *
+ * The polynomials are given by the three-term recurrence
+ *
+ * p_{k+1}(x) = (x - a_k) p_k(x) - b_k p_{k-1}(x)
+ *
+ * \param [out] p  Values of p_0(x) through p_n(x) (length n+1)
+ * \param [out] dp Derivative of p_n at x (may be NULL)
+ */
+static void mirp_rys_poly_eval(arb_ptr p, arb_t dp, const arb_t x, int n,
+                               arb_srcptr a, arb_srcptr b, slong working_prec)
+{
+    arb_t xa, dp_k, dp_km1, tmp;
+    arb_init(xa);
+    arb_init(dp_k);
+    arb_init(dp_km1);
+    arb_init(tmp);
+
+    /* p_0 = 1, p_0' = 0, p_{-1} = p_{-1}' = 0 */
+    arb_one(p);
+    arb_zero(dp_k);
+    arb_zero(dp_km1);
+
+    for(int k = 0; k < n; k++)
+    {
+        arb_sub(xa, x, a + k, working_prec);
+
+        /* p_{k+1}' = p_k + (x - a_k) p_k' - b_k p_{k-1}' */
+        arb_mul(tmp, xa, dp_k, working_prec);
+        arb_add(tmp, tmp, p + k, working_prec);
+        arb_submul(tmp, b + k, dp_km1, working_prec);
+        arb_swap(dp_km1, dp_k);
+        arb_swap(dp_k, tmp);
+
+        /* p_{k+1} = (x - a_k) p_k - b_k p_{k-1} */
+        arb_mul(p + k + 1, xa, p + k, working_prec);
+        if(k > 0)
+            arb_submul(p + k + 1, b + k, p + k - 1, working_prec);
+    }
+
+    if(dp != NULL)
+        arb_set(dp, dp_k);
+
+    arb_clear(xa);
+    arb_clear(dp_k);
+    arb_clear(dp_km1);
+    arb_clear(tmp);
+}
+
+
+/*! \brief Counts the number of roots of p_n that are greater than x
+ *
+ * This is the number of sign changes in the sequence p_0(x), ..., p_n(x).
+ *
+ * \return The number of roots, or -1 if the sign of one of the
+ *         polynomials could not be determined
+ */
+static int mirp_rys_nabove(const arb_t x, int n, arb_srcptr a, arb_srcptr b,
+                           slong working_prec)
+{
+    arb_ptr p = _arb_vec_init(n+1);
+    mirp_rys_poly_eval(p, NULL, x, n, a, b, working_prec);
+
+    int count = 0;
+    int prev_sign = 1;
+
+    for(int k = 1; k <= n; k++)
+    {
+        int sign;
+        if(arb_is_positive(p + k))
+            sign = 1;
+        else if(arb_is_negative(p + k))
+            sign = -1;
+        else
+        {
+            count = -1;
+            break;
+        }
+
+        if(sign != prev_sign)
+            count++;
+        prev_sign = sign;
+    }
+
+    _arb_vec_clear(p, n+1);
+    return count;
+}
+
+
+/*! \brief Computes the recurrence coefficients from the moments
+ *
+ * This is the Chebyshev algorithm (see W. Gautschi, "Orthogonal
+ * Polynomials: Computation and Approximation", Section 2.1.7).
+ *
+ * \return Nonzero if all the b_k could be shown to be positive
+ */
+static int mirp_rys_chebyshev(arb_ptr a, arb_ptr b, arb_srcptr mu, int n,
+                              slong working_prec)
+{
+    const int nmom = 2*n;
+
+    arb_ptr sigma_km2 = _arb_vec_init(nmom);
+    arb_ptr sigma_km1 = _arb_vec_init(nmom);
+    arb_ptr sigma_k = _arb_vec_init(nmom);
+
+    arb_t tmp;
+    arb_init(tmp);
+
+    int success = arb_is_positive(mu);
+
+    _arb_vec_set(sigma_km1, mu, nmom);
+    arb_div(a, mu + 1, mu, working_prec);
+    arb_set(b, mu);
+
+    for(int k = 1; k < n && success; k++)
+    {
+        for(int l = k; l < nmom - k; l++)
+        {
+            arb_mul(sigma_k + l, a + k - 1, sigma_km1 + l, working_prec);
+            arb_sub(sigma_k + l, sigma_km1 + l + 1, sigma_k + l, working_prec);
+            arb_submul(sigma_k + l, b + k - 1, sigma_km2 + l, working_prec);
+        }
+
+        /* a_k = sigma_{k,k+1}/sigma_{k,k} - sigma_{k-1,k}/sigma_{k-1,k-1}
+         * b_k = sigma_{k,k}/sigma_{k-1,k-1}
+         */
+        arb_div(a + k, sigma_k + k + 1, sigma_k + k, working_prec);
+        arb_div(tmp, sigma_km1 + k, sigma_km1 + k - 1, working_prec);
+        arb_sub(a + k, a + k, tmp, working_prec);
+        arb_div(b + k, sigma_k + k, sigma_km1 + k - 1, working_prec);
+
+        success = arb_is_positive(b + k);
+
+        /* Rotate the rows */
+        arb_ptr sigma_tmp = sigma_km2;
+        sigma_km2 = sigma_km1;
+        sigma_km1 = sigma_k;
+        sigma_k = sigma_tmp;
+    }
+
+    _arb_vec_clear(sigma_km2, nmom);
+    _arb_vec_clear(sigma_km1, nmom);
+    _arb_vec_clear(sigma_k, nmom);
+    arb_clear(tmp);
+
+    return success;
+}
+
+
+/*! \brief Locates and certifies a single root of p_n
+ *
+ * The root is first isolated by bisection (using the number of sign changes
+ * in the sequence of polynomials), then polished with Newton's method
+ * on the midpoint. Finally, an interval Newton step certifies that
+ * the resulting ball contains exactly one root.
+ *
+ * \param [in] idx The index of the root (in ascending order)
+ * \return Nonzero if the root was certified
+ */
+static int mirp_rys_find_root(arb_t root, int idx, int n,
+                              arb_srcptr a, arb_srcptr b, slong working_prec)
+{
+    int success = 0;
+
+    arb_ptr p = _arb_vec_init(n+1);
+    arb_t lo, hi, r, dp, X, N, err;
+    arb_init(lo);
+    arb_init(hi);
+    arb_init(r);
+    arb_init(dp);
+    arb_init(X);
+    arb_init(N);
+    arb_init(err);
+
+    /* All roots lie within (0, 1) */
+    arb_zero(lo);
+    arb_one(hi);
+
+    for(int iter = 0; iter < 64; iter++)
+    {
+        arb_add(r, lo, hi, working_prec);
+        arb_mul_2exp_si(r, r, -1);
+
+        const int nabove = mirp_rys_nabove(r, n, a, b, working_prec);
+        if(nabove < 0)
+            break;
+
+        if(nabove >= n - idx)
+            arb_swap(lo, r);
+        else
+            arb_swap(hi, r);
+    }
+
+    arb_add(r, lo, hi, working_prec);
+    arb_mul_2exp_si(r, r, -1);
+
+    /* Newton's method on the (exact) midpoint */
+    for(slong bits = 16; bits < 2*working_prec; bits *= 2)
+    {
+        mirp_rys_poly_eval(p, dp, r, n, a, b, working_prec);
+        arb_div(err, p + n, dp, working_prec);
+        arb_sub(r, r, err, working_prec);
+        arb_get_mid_arb(r, r);
+    }
+
+    /* Interval Newton step. Start with a ball around r that is
+     * twice the size of the Newton correction, and increase
+     * it if necessary
+     */
+    mirp_rys_poly_eval(p, dp, r, n, a, b, working_prec);
+    arb_div(err, p + n, dp, working_prec);
+    arb_abs(err, err);
+    arb_mul_2exp_si(err, err, 1);
+
+    for(int attempt = 0; attempt < 16 && arb_is_finite(err); attempt++)
+    {
+        arb_set(X, r);
+        arb_add_error(X, err);
+
+        /* N = r - p(r)/p'(X) */
+        mirp_rys_poly_eval(p, dp, X, n, a, b, working_prec);
+        mirp_rys_poly_eval(p, NULL, r, n, a, b, working_prec);
+        arb_div(N, p + n, dp, working_prec);
+        arb_sub(N, r, N, working_prec);
+
+        if(arb_is_finite(N) && arb_contains(X, N))
+        {
+            arb_set(root, N);
+            success = 1;
+            break;
+        }
+
+        arb_mul_2exp_si(err, err, 2);
+    }
+
+    _arb_vec_clear(p, n+1);
+    arb_clear(lo);
+    arb_clear(hi);
+    arb_clear(r);
+    arb_clear(dp);
+    arb_clear(X);
+    arb_clear(N);
+    arb_clear(err);
+
+    return success;
+}
+
+
+int mirp_rys_roots(arb_ptr roots, arb_ptr weights, int nroots,
+                   const arb_t t, slong working_prec)
+{
+    assert(nroots > 0);
+
+    const int n = nroots;
+
+    /* The moments are the Boys function F_0 through F_{2n-1} */
+    arb_ptr mu = _arb_vec_init(2*n);
+    arb_ptr a = _arb_vec_init(n);
+    arb_ptr b = _arb_vec_init(n);
+    arb_ptr p = _arb_vec_init(n+1);
+
+    arb_t sum, h, tmp;
+    arb_init(sum);
+    arb_init(h);
+    arb_init(tmp);
+
+    mirp_boys(mu, 2*n-1, t, working_prec);
+
+    int success = mirp_rys_chebyshev(a, b, mu, n, working_prec);
+
+    for(int i = 0; i < n && success; i++)
+        success = mirp_rys_find_root(roots + i, i, n, a, b, working_prec);
+
+    /* Each ball contains exactly one root. If they are disjoint,
+     * we have all of them */
+    for(int i = 0; i < n && success; i++)
+    for(int j = 0; j < i && success; j++)
+        success = !arb_overlaps(roots + i, roots + j);
+
+    /*
+     * The weights are given by the Christoffel numbers
+     *
+     * 1/w_i = sum_k p_k(x_i)^2 / h_k
+     *
+     * where h_k = b_0 * b_1 * ... * b_k is the norm of p_k
+     */
+    for(int i = 0; i < n && success; i++)
+    {
+        mirp_rys_poly_eval(p, NULL, roots + i, n, a, b, working_prec);
+
+        arb_zero(sum);
+        arb_one(h);
+        for(int k = 0; k < n; k++)
+        {
+            arb_mul(h, h, b + k, working_prec);
+            arb_sqr(tmp, p + k, working_prec);
+            arb_div(tmp, tmp, h, working_prec);
+            arb_add(sum, sum, tmp, working_prec);
+        }
+
+        arb_inv(weights + i, sum, working_prec);
+    }
+
+    if(!success)
+    {
+        for(int i = 0; i < n; i++)
+        {
+            arb_indeterminate(roots + i);
+            arb_indeterminate(weights + i);
+        }
+    }
+
+    _arb_vec_clear(mu, 2*n);
+    _arb_vec_clear(a, n);
+    _arb_vec_clear(b, n);
+    _arb_vec_clear(p, n+1);
+    arb_clear(sum);
+    arb_clear(h);
+    arb_clear(tmp);
+
+    return success;
+}
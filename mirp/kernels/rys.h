@@ -0,0 +1,50 @@
+/*! \file
+ *
+ * \brief Calculation of Rys quadrature roots and weights
+ */
+
+#pragma once
+
+#include <arb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Computes the roots and weights of the Rys quadrature
+ *         using interval arithmetic
+ *
+ * The roots \f$x_i\f$ (in terms of \f$x = u^2\f$, so they lie in (0,1))
+ * and weights \f$w_i\f$ satisfy
+ *
+ * \f[ \sum_{i} w_i x_i^m = F_m(t) \f]
+ *
+ * for m = 0 through 2 * \p nroots - 1, where \f$F_m\f$ is the Boys function.
+ *
+ * The recurrence coefficients of the orthogonal polynomials are obtained from
+ * the Boys function moments. Each root is then located by bisection
+ * and certified by an interval Newton step, so that the resulting balls
+ * are guaranteed to contain the exact roots and weights.
+ *
+ * If the roots could not be certified (usually because \p working_prec
+ * is too small), all roots and weights are set to indeterminate values and
+ * zero is returned.
+ *
+ * \warning \p roots and \p weights must be large enough to hold
+ *          \p nroots values
+ *
+ * \param [out] roots   The computed roots
+ * \param [out] weights The computed weights
+ * \param [in]  nroots  The number of roots to compute
+ * \param [in]  t       The value at which to evaluate
+ * \param [in]  working_prec The working precision (binary digits/bits)
+ *                           to use in the calculation
+ * \return Nonzero if the roots were certified, 0 otherwise
+ */
+int mirp_rys_roots(arb_ptr roots, arb_ptr weights, int nroots,
+                   const arb_t t, slong working_prec);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -33,6 +33,16 @@ void mirp_pow_si(arb_t output, const arb_t b, long e, slong prec)
 }
 
 
+void mirp_pow_vec(arb_ptr output, const arb_t b, int n, slong prec)
+{
+    assert(n >= 0);
+
+    arb_one(output);
+    for(int i = 1; i <= n; i++)
+        arb_mul(output + i, output + (i-1), b, prec);
+}
+
+
 void mirp_factorial(arb_t output, long n)
 {
     assert(n >= 0);
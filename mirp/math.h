@@ -64,6 +64,13 @@ slong mirp_min_accuracy_bits(arb_srcptr v, size_t n);
 void mirp_pow_si(arb_t output, const arb_t b, long e, slong prec);
 
 
+/*! \brief Calculates all integer powers b^0 through b^n
+ *
+ * \warning \p output must be large enough to hold (\p n + 1) values
+ */
+void mirp_pow_vec(arb_ptr output, const arb_t b, int n, slong prec);
+
+
 /*! \brief Calculates a factorial using interval arithmetic */
 void mirp_factorial(arb_t output, long n);
 
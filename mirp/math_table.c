@@ -0,0 +1,119 @@
+/*! \file
+ *
+ * \brief Cached tables of factorials and binomial coefficients
+ *        in interval arithmetic
+ */
+
+#include "mirp/math_table.h"
+#include "mirp/math.h"
+#include <stdlib.h>
+#include <assert.h>
+
+
+/* Cached tables are kept in a singly-linked list. Tables are
+ * never modified after being added, and new tables are only
+ * added to the front of the list.
+ */
+typedef struct mirp_math_table_node
+{
+    mirp_math_table table;
+    struct mirp_math_table_node * next;
+} mirp_math_table_node;
+
+static mirp_math_table_node * mirp_math_table_cache = NULL;
+
+
+static void mirp_math_table_build(mirp_math_table * table, int max_n, slong working_prec)
+{
+    const long nbinomial = ((long)(max_n+1)*(max_n+2))/2;
+
+    table->working_prec = working_prec;
+    table->max_n = max_n;
+    table->fac = _arb_vec_init(max_n+1);
+    table->inv_fac = _arb_vec_init(max_n+1);
+    table->binomial = _arb_vec_init(nbinomial);
+
+    arb_one(table->fac + 0);
+    for(int n = 1; n <= max_n; n++)
+        arb_mul_ui(table->fac + n, table->fac + (n-1), (ulong)n, ARF_PREC_EXACT);
+
+    for(int n = 0; n <= max_n; n++)
+        arb_inv(table->inv_fac + n, table->fac + n, working_prec);
+
+    /* Pascal's triangle. All of these are exact */
+    for(int n = 0; n <= max_n; n++)
+    {
+        arb_one(MIRP_MATH_TABLE_BINOMIAL(table, n, 0));
+        arb_one(MIRP_MATH_TABLE_BINOMIAL(table, n, n));
+
+        for(int k = 1; k < n; k++)
+            arb_add(MIRP_MATH_TABLE_BINOMIAL(table, n, k),
+                    MIRP_MATH_TABLE_BINOMIAL(table, n-1, k-1),
+                    MIRP_MATH_TABLE_BINOMIAL(table, n-1, k),
+                    ARF_PREC_EXACT);
+    }
+}
+
+
+static void mirp_math_table_free(mirp_math_table * table)
+{
+    const long nbinomial = ((long)(table->max_n+1)*(table->max_n+2))/2;
+
+    _arb_vec_clear(table->fac, table->max_n+1);
+    _arb_vec_clear(table->inv_fac, table->max_n+1);
+    _arb_vec_clear(table->binomial, nbinomial);
+}
+
+
+const mirp_math_table * mirp_math_table_get(int max_n, slong working_prec)
+{
+    assert(max_n >= 0);
+    assert(working_prec > 0);
+
+    mirp_math_table * ret = NULL;
+
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_math_table)
+    #endif
+    {
+        for(mirp_math_table_node * node = mirp_math_table_cache; node != NULL; node = node->next)
+        {
+            if(node->table.working_prec == working_prec && node->table.max_n >= max_n)
+            {
+                ret = &node->table;
+                break;
+            }
+        }
+
+        if(ret == NULL)
+        {
+            mirp_math_table_node * node = malloc(sizeof(mirp_math_table_node));
+            mirp_math_table_build(&node->table, MAX(max_n, MIRP_MATH_TABLE_MIN_N), working_prec);
+            node->next = mirp_math_table_cache;
+            mirp_math_table_cache = node;
+            ret = &node->table;
+        }
+    }
+
+    return ret;
+}
+
+
+void mirp_math_table_clear_cache(void)
+{
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_math_table)
+    #endif
+    {
+        mirp_math_table_node * node = mirp_math_table_cache;
+        while(node != NULL)
+        {
+            mirp_math_table_node * next = node->next;
+            mirp_math_table_free(&node->table);
+            free(node);
+            node = next;
+        }
+
+        mirp_math_table_cache = NULL;
+    }
+}
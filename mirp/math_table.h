@@ -0,0 +1,78 @@
+/*! \file
+ *
+ * \brief Cached tables of factorials and binomial coefficients
+ *        in interval arithmetic
+ */
+
+#pragma once
+
+#include <arb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Default (minimum) size of a table
+ *
+ * Tables are always built for at least this many entries, so that
+ * small requests do not result in many small tables
+ */
+#define MIRP_MATH_TABLE_MIN_N 32
+
+
+/*! \brief Tables of commonly-used integer quantities
+ *
+ * Factorials and binomial coefficients are stored exactly. The inverse
+ * factorials are rounded to the working precision the table was built for.
+ *
+ * Tables are obtained via \ref mirp_math_table_get and must not be
+ * modified or freed by the caller.
+ */
+typedef struct
+{
+    slong working_prec;  //!< Working precision used for the inverse factorials
+    int max_n;           //!< Largest n stored in the tables
+    arb_ptr fac;         //!< n! for n = 0..max_n (exact)
+    arb_ptr inv_fac;     //!< 1/n! for n = 0..max_n
+    arb_ptr binomial;    //!< Binomial coefficients (see \ref MIRP_MATH_TABLE_BINOMIAL)
+} mirp_math_table;
+
+
+/*! \brief Obtain a pointer to binomial(n, k) from a table
+ *
+ * The binomial coefficients are stored as a triangle, with row n starting
+ * at index n*(n+1)/2.
+ */
+#define MIRP_MATH_TABLE_BINOMIAL(table, n, k) \
+        ((table)->binomial + (((n)*((n)+1))/2 + (k)))
+
+
+/*! \brief Obtain a table for a given working precision
+ *
+ * Tables are built the first time they are requested and are then cached,
+ * so subsequent calls with the same working precision are cheap. The
+ * returned table holds entries up to at least \p max_n.
+ *
+ * This function is safe to call from multiple OpenMP threads.
+ *
+ * \param [in] max_n        The largest n that will be looked up
+ * \param [in] working_prec The working precision (binary digits/bits)
+ *                          the inverse factorials should be computed with
+ * \return A table valid until \ref mirp_math_table_clear_cache is called
+ */
+const mirp_math_table * mirp_math_table_get(int max_n, slong working_prec);
+
+
+/*! \brief Free all cached tables
+ *
+ * \warning Any tables obtained from \ref mirp_math_table_get are invalid
+ *          after calling this. This must not be called while
+ *          other threads may be using tables.
+ */
+void mirp_math_table_clear_cache(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
@@ -0,0 +1,297 @@
+/*! \file
+ *
+ * \brief Selection of the working precision for the exact wrappers
+ */
+
+/* For clock_gettime */
+#define _POSIX_C_SOURCE 199309L
+
+#include "mirp/precision.h"
+#include "mirp/math.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*! \brief Number of AM values per center with separate escalation statistics */
+#define MIRP_EXACT_STATS_NAM (MIRP_EXACT_STATS_MAX_AM+1)
+
+/*! \brief Number of escalation statistics entries of one kind of exact function */
+#define MIRP_EXACT_STATS_NENTRIES \
+        (MIRP_EXACT_STATS_NAM*MIRP_EXACT_STATS_NAM*MIRP_EXACT_STATS_NAM*MIRP_EXACT_STATS_NAM)
+
+
+/*! \brief Counts of the outcomes of all attempts */
+static mirp_prec_stats mirp_prec_counts = { 0, 0, 0, 0, 0, 0 };
+
+/*! \brief Escalation statistics of all exact functions (NULL if not recording)
+ *
+ * Indexed by kind, then by the (clamped) AM of the four centers
+ */
+static mirp_exact_stats * mirp_exact_table = NULL;
+
+/*! \brief Nonzero if escalation statistics are being recorded
+ *
+ * This is checked on every call of an exact function, so it is read
+ * atomically rather than in a critical section
+ */
+static int mirp_exact_stats_on = 0;
+
+
+/*! \brief Rounds a precision up to a multiple of 64
+ *
+ * arb stores mantissas in full limbs, so any extra bits are free
+ */
+static slong mirp_prec_round(slong prec)
+{
+    return ((prec + 63) / 64) * 64;
+}
+
+
+slong mirp_prec_initial(int L, double alpha_min, double alpha_max,
+                        double T_max, slong target_prec)
+{
+    /* Cancellation in the sums grows with the angular momentum. Very
+     * different exponents and distant charge distributions lead
+     * to large intermediate values */
+    slong lost = 2*L;
+
+    if(alpha_min > 0.0 && alpha_max > alpha_min)
+        lost += (slong)(0.25 * log2(alpha_max / alpha_min));
+
+    if(T_max > 0.0)
+        lost += (slong)(0.25 * log2(1.0 + T_max));
+
+    return mirp_prec_round(target_prec + lost + MIRP_PREC_MARGIN);
+}
+
+
+slong mirp_prec_next(slong working_prec, slong min_bits, slong target_prec)
+{
+    if(min_bits <= 0)
+        return working_prec + target_prec;
+
+    const slong lost = working_prec - min_bits;
+    const slong next = mirp_prec_round(target_prec + lost + MIRP_PREC_MARGIN);
+
+    return MAX(next, working_prec + 64);
+}
+
+
+slong mirp_prec_from_digits(long ndigits)
+{
+    return (slong)((double)(ndigits+5) / MIRP_LOG_10_2);
+}
+
+
+int mirp_prec_target_reached(const arb_t x, slong target_prec, slong * min_bits)
+{
+    const slong bits = arb_rel_accuracy_bits(x);
+
+    if(bits >= target_prec)
+        return 1;
+
+    if(bits > 0)
+    {
+        *min_bits = MIN(*min_bits, bits);
+        return 0;
+    }
+
+    /* Contains zero */
+    mag_t mag;
+    mag_init(mag);
+    arb_get_mag(mag, x);
+    const int zero = (mag_cmp_2exp_si(mag, -2*target_prec) <= 0);
+    mag_clear(mag);
+
+    if(!zero)
+        *min_bits = 0;
+    return zero;
+}
+
+
+void mirp_prec_record(int initial, int suff_acc)
+{
+    if(initial)
+    {
+        #ifdef _OPENMP
+        #pragma omp atomic
+        #endif
+        mirp_prec_counts.ninitial++;
+
+        if(suff_acc)
+        {
+            #ifdef _OPENMP
+            #pragma omp atomic
+            #endif
+            mirp_prec_counts.ninitial_hit++;
+        }
+    }
+    else
+    {
+        #ifdef _OPENMP
+        #pragma omp atomic
+        #endif
+        mirp_prec_counts.npredicted++;
+
+        if(suff_acc)
+        {
+            #ifdef _OPENMP
+            #pragma omp atomic
+            #endif
+            mirp_prec_counts.npredicted_hit++;
+        }
+    }
+}
+
+
+void mirp_prec_record_fixed(int suff_acc)
+{
+    #ifdef _OPENMP
+    #pragma omp atomic
+    #endif
+    mirp_prec_counts.nfixed++;
+
+    if(suff_acc)
+    {
+        #ifdef _OPENMP
+        #pragma omp atomic
+        #endif
+        mirp_prec_counts.nfixed_hit++;
+    }
+}
+
+
+void mirp_prec_stats_get(mirp_prec_stats * stats)
+{
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_prec_stats)
+    #endif
+    *stats = mirp_prec_counts;
+}
+
+
+void mirp_prec_stats_reset(void)
+{
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_prec_stats)
+    #endif
+    {
+        mirp_prec_counts.ninitial = 0;
+        mirp_prec_counts.ninitial_hit = 0;
+        mirp_prec_counts.npredicted = 0;
+        mirp_prec_counts.npredicted_hit = 0;
+        mirp_prec_counts.nfixed = 0;
+        mirp_prec_counts.nfixed_hit = 0;
+    }
+}
+
+
+/*! \brief Index of an AM tuple in the escalation statistics table */
+static size_t mirp_exact_stats_index(mirp_exact_kind kind, const int * am)
+{
+    size_t idx = (size_t)kind;
+    for(int i = 0; i < 4; i++)
+        idx = idx*MIRP_EXACT_STATS_NAM + (size_t)MIN(MAX(am[i], 0), MIRP_EXACT_STATS_MAX_AM);
+    return idx;
+}
+
+
+void mirp_exact_stats_enable(int enable)
+{
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_exact_stats)
+    #endif
+    {
+        if(enable && mirp_exact_table == NULL)
+            mirp_exact_table = calloc(MIRP_EXACT_NKINDS*MIRP_EXACT_STATS_NENTRIES,
+                                      sizeof(mirp_exact_stats));
+        else if(!enable)
+        {
+            free(mirp_exact_table);
+            mirp_exact_table = NULL;
+        }
+
+        #ifdef _OPENMP
+        #pragma omp atomic write
+        #endif
+        mirp_exact_stats_on = (mirp_exact_table != NULL);
+    }
+}
+
+
+int mirp_exact_stats_enabled(void)
+{
+    int enabled;
+
+    #ifdef _OPENMP
+    #pragma omp atomic read
+    #endif
+    enabled = mirp_exact_stats_on;
+
+    return enabled;
+}
+
+
+double mirp_exact_stats_start(void)
+{
+    if(!mirp_exact_stats_enabled())
+        return 0.0;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1.0e-9 * (double)ts.tv_nsec;
+}
+
+
+void mirp_exact_stats_record(mirp_exact_kind kind, const int * am,
+                             slong final_prec, int nrounds,
+                             long nevals, long nresults, double start)
+{
+    if(!mirp_exact_stats_enabled())
+        return;
+
+    /* If recording was enabled during the call, the start time is unknown */
+    const double end = mirp_exact_stats_start();
+    const double elapsed = (start > 0.0) ? end - start : 0.0;
+
+    const slong prec_bin = MIN(MAX((final_prec - 1) / 64, 0), MIRP_EXACT_STATS_NPREC-1);
+    const int rounds_bin = MIN(MAX(nrounds, 0), MIRP_EXACT_STATS_NROUNDS-1);
+
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_exact_stats)
+    #endif
+    if(mirp_exact_table != NULL)
+    {
+        mirp_exact_stats * entry = mirp_exact_table + mirp_exact_stats_index(kind, am);
+        entry->ncalls++;
+        entry->prec_hist[prec_bin]++;
+        entry->rounds_hist[rounds_bin]++;
+        entry->nevals += nevals;
+        entry->nresults += nresults;
+        entry->time += elapsed;
+    }
+}
+
+
+void mirp_exact_stats_get(mirp_exact_stats * stats, mirp_exact_kind kind, const int * am)
+{
+    memset(stats, 0, sizeof(mirp_exact_stats));
+
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_exact_stats)
+    #endif
+    if(mirp_exact_table != NULL)
+        *stats = mirp_exact_table[mirp_exact_stats_index(kind, am)];
+}
+
+
+void mirp_exact_stats_reset(void)
+{
+    #ifdef _OPENMP
+    #pragma omp critical(mirp_exact_stats)
+    #endif
+    if(mirp_exact_table != NULL)
+        memset(mirp_exact_table, 0,
+               MIRP_EXACT_NKINDS*MIRP_EXACT_STATS_NENTRIES*sizeof(mirp_exact_stats));
+}
@@ -0,0 +1,251 @@
+/*! \file
+ *
+ * \brief Selection of the working precision for the exact wrappers
+ */
+
+#pragma once
+
+#include <arb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Extra bits added to predicted precisions for safety */
+#define MIRP_PREC_MARGIN 16
+
+
+/*! \brief Working precision of the first, low-precision attempt of the
+ *         four-center exact functions
+ *
+ * This fits in a single limb, which is the cheapest arb can do.
+ */
+#define MIRP_PREC_FAST 64
+
+
+/*! \brief Largest working precision the target functions will try
+ *
+ * This only guards against results that never become more accurate
+ */
+#define MIRP_PREC_TARGET_MAX 16384
+
+
+/*! \brief Counts of how often the precision predictions were sufficient
+ *
+ * The first attempt of an exact wrapper uses the precision from
+ * \ref mirp_prec_initial. Any further attempt uses the precision from
+ * \ref mirp_prec_next. A prediction is a hit if the attempt
+ * made with it had sufficient accuracy.
+ *
+ * Attempts at a fixed low precision that come before the first prediction
+ * (see \ref mirp_integral4_exact and \ref mirp_boys_exact) are
+ * counted separately.
+ */
+typedef struct
+{
+    long ninitial;        //!< Number of first attempts
+    long ninitial_hit;    //!< Number of first attempts with sufficient accuracy
+    long npredicted;      //!< Number of further attempts
+    long npredicted_hit;  //!< Number of further attempts with sufficient accuracy
+    long nfixed;          //!< Number of attempts at a fixed low precision
+    long nfixed_hit;      //!< Number of attempts at a fixed low precision with sufficient accuracy
+} mirp_prec_stats;
+
+
+/*! \brief Estimates the working precision for the first attempt
+ *         of a four-center integral
+ *
+ * The estimate of the bits lost increases with the total angular momentum,
+ * the spread of the exponents, and the argument of the Boys function.
+ * The result is \p target_prec plus the bits lost plus \ref MIRP_PREC_MARGIN.
+ *
+ * \param [in] L           Total angular momentum of the quartet
+ * \param [in] alpha_min   Smallest exponent of all primitives in the quartet
+ * \param [in] alpha_max   Largest exponent of all primitives in the quartet
+ * \param [in] T_max       Largest argument of the Boys function (PQ^2 * gammapq)
+ *                         of all primitive quartets (0 if not known)
+ * \param [in] target_prec Number of accurate bits needed in the result
+ * \return The working precision to use (a multiple of 64)
+ */
+slong mirp_prec_initial(int L, double alpha_min, double alpha_max,
+                        double T_max, slong target_prec);
+
+
+/*! \brief Predicts the working precision for the next attempt
+ *
+ * The number of bits lost in the previous attempt (\p working_prec - \p min_bits)
+ * is assumed to be the same at higher precision. If nothing is known about
+ * the bits lost (\p min_bits <= 0), the precision is increased by \p target_prec
+ * as before.
+ *
+ * \param [in] working_prec The working precision of the attempt that failed
+ * \param [in] min_bits     Smallest relative accuracy of the results that
+ *                          were not accurate enough
+ * \param [in] target_prec  Number of accurate bits needed in the result
+ * \return The working precision to use (at least \p working_prec + 64)
+ */
+slong mirp_prec_next(slong working_prec, slong min_bits, slong target_prec);
+
+
+/*! \brief Number of bits needed for a number of decimal digits
+ *
+ * This includes five extra digits for safety.
+ */
+slong mirp_prec_from_digits(long ndigits);
+
+
+/*! \brief Determines if a result is accurate to a target precision
+ *
+ * The result needs at least \p target_prec bits of relative accuracy. A result
+ * that contains zero (and so has no relative accuracy) is accepted if its
+ * absolute value is bounded by 2^(-2 * \p target_prec). Integrals that are zero
+ * by symmetry end up here, while anything larger than that gets full relative
+ * accuracy.
+ *
+ * \param [in]    x           The result to check
+ * \param [in]    target_prec Number of accurate bits needed
+ * \param [inout] min_bits    If \p x is not accurate enough, this is lowered
+ *                            to its relative accuracy (see \ref mirp_prec_next)
+ * \return Nonzero if \p x is accurate enough
+ */
+int mirp_prec_target_reached(const arb_t x, slong target_prec, slong * min_bits);
+
+
+/*! \brief Records the outcome of an attempt
+ *
+ * This function is safe to call from multiple OpenMP threads.
+ *
+ * \param [in] initial  Nonzero if this was the first attempt
+ * \param [in] suff_acc Nonzero if the attempt had sufficient accuracy
+ */
+void mirp_prec_record(int initial, int suff_acc);
+
+
+/*! \brief Records the outcome of an attempt at a fixed low precision
+ *
+ * These attempts are not predictions, and so are not counted by \ref mirp_prec_record.
+ * This function is safe to call from multiple OpenMP threads.
+ *
+ * \param [in] suff_acc Nonzero if the attempt had sufficient accuracy
+ */
+void mirp_prec_record_fixed(int suff_acc);
+
+
+/*! \brief Obtains the counts of the precision predictions */
+void mirp_prec_stats_get(mirp_prec_stats * stats);
+
+
+/*! \brief Resets the counts of the precision predictions to zero */
+void mirp_prec_stats_reset(void);
+
+
+/*! \brief Largest angular momentum (of a single shell) with separate
+ *         escalation statistics
+ *
+ * Larger angular momenta are counted together with this one.
+ */
+#define MIRP_EXACT_STATS_MAX_AM 7
+
+/*! \brief Number of bins of the histogram of final working precisions
+ *
+ * Bin i counts precisions in (64*i, 64*(i+1)]. The last bin also
+ * counts all larger precisions.
+ */
+#define MIRP_EXACT_STATS_NPREC 16
+
+/*! \brief Number of bins of the histogram of the number of attempts
+ *
+ * Bin i counts calls that needed i attempts. Bin 0 counts calls whose
+ * results were known without computing anything with interval arithmetic
+ * (for example, from an a-priori bound or from the certified table of the
+ * Boys function). The last bin also counts all calls that needed more.
+ */
+#define MIRP_EXACT_STATS_NROUNDS 8
+
+
+/*! \brief The exact functions that record escalation statistics */
+typedef enum
+{
+    MIRP_EXACT_BOYS = 0,  //!< mirp_boys_exact and mirp_boys_grid_exact (the AM tuple is {m, 0, 0, 0})
+    MIRP_EXACT_SINGLE4,   //!< Single four-center integrals (the AM is the sum of each lmn)
+    MIRP_EXACT_SHELL4,    //!< Contracted four-center shell quartets (also from shell pairs)
+    MIRP_EXACT_NKINDS     //!< Number of kinds of exact functions
+} mirp_exact_kind;
+
+
+/*! \brief Escalation statistics of the exact functions for one AM tuple
+ *
+ * An evaluation is the computation of a single (cartesian, general
+ * contraction) integral with interval arithmetic. Evaluations that are
+ * redone in a later attempt are wasted, so the number of wasted evaluations
+ * is \p nevals - \p nresults.
+ */
+typedef struct
+{
+    long ncalls;                                //!< Number of calls
+    long prec_hist[MIRP_EXACT_STATS_NPREC];     //!< Histogram of the final working precision
+    long rounds_hist[MIRP_EXACT_STATS_NROUNDS]; //!< Histogram of the number of attempts
+    long nevals;                                //!< Number of evaluations
+    long nresults;                              //!< Number of integrals returned
+    double time;                                //!< Total wall time (in seconds)
+} mirp_exact_stats;
+
+
+/*! \brief Enables or disables recording of escalation statistics
+ *
+ * Recording is disabled by default, and has no cost then. Enabling it
+ * allocates the statistics (all zero), disabling frees them.
+ */
+void mirp_exact_stats_enable(int enable);
+
+
+/*! \brief Returns nonzero if escalation statistics are being recorded */
+int mirp_exact_stats_enabled(void);
+
+
+/*! \brief Obtains the start time of a call of an exact function
+ *
+ * \return The current wall time (in seconds), or zero if
+ *         statistics are not being recorded
+ */
+double mirp_exact_stats_start(void);
+
+
+/*! \brief Records a call of an exact function
+ *
+ * Does nothing if statistics are not being recorded. This function
+ * is safe to call from multiple OpenMP threads.
+ *
+ * \param [in] kind       The exact function that was called
+ * \param [in] am         Angular momenta of the four centers
+ * \param [in] final_prec Working precision of the last attempt (0 if none)
+ * \param [in] nrounds    Number of attempts
+ * \param [in] nevals     Number of evaluations in all attempts
+ * \param [in] nresults   Number of integrals returned
+ * \param [in] start      Value returned by \ref mirp_exact_stats_start at
+ *                        the beginning of the call
+ */
+void mirp_exact_stats_record(mirp_exact_kind kind, const int * am,
+                             slong final_prec, int nrounds,
+                             long nevals, long nresults, double start);
+
+
+/*! \brief Obtains the escalation statistics for an AM tuple
+ *
+ * Angular momenta larger than \ref MIRP_EXACT_STATS_MAX_AM
+ * are treated as \ref MIRP_EXACT_STATS_MAX_AM.
+ *
+ * \param [out] stats The statistics (all zero if not recording)
+ * \param [in]  kind  The exact function to obtain the statistics of
+ * \param [in]  am    Angular momenta of the four centers
+ */
+void mirp_exact_stats_get(mirp_exact_stats * stats, mirp_exact_kind kind, const int * am);
+
+
+/*! \brief Resets all escalation statistics to zero */
+void mirp_exact_stats_reset(void);
+
+
+#ifdef __cplusplus
+}
+#endif
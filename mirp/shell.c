@@ -135,3 +135,41 @@ void mirp_normalize_shell(int am, int nprim, int ngeneral,
 }
 #endif
 
+
+void mirp_normalize_shell_double(int am, int nprim, int ngeneral,
+                                 const double * alpha,
+                                 const double * coeff,
+                                 double * coeff_out)
+{
+    const double m = am + 1.5;
+    const double m2 = 0.5 * m;
+
+    /* Normalization factor
+     *
+     * norm_fac = pi^(3/2) * (2l-1)!! / 2^l
+     */
+    double norm_fac = MIRP_PI_32;
+    for(int i = 1; i <= am; i++)
+        norm_fac *= (2*i-1) / 2.0;
+
+    for(int n = 0; n < ngeneral; n++)
+    {
+        double sum = 0.0;
+
+        for(int i = 0; i < nprim; i++)
+        {
+            for(int j = 0; j < nprim; j++)
+            {
+                /* coeff1 * coeff2 * pow(alpha1 * alpha2, m2) / pow(alpha1 + alpha2, m) */
+                sum += coeff[n*nprim+i] * coeff[n*nprim+j]
+                     * pow(alpha[i] * alpha[j], m2)
+                     / pow(alpha[i] + alpha[j], m);
+            }
+        }
+
+        const double fac = 1.0 / sqrt(sum * norm_fac);
+
+        for (int i = 0; i < nprim; ++i)
+            coeff_out[n*nprim+i] = coeff[n*nprim+i] * pow(alpha[i], m2) * fac;
+    }
+}
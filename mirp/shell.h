@@ -65,7 +65,7 @@ int mirp_iterate_gaussian(int * lmn);
 void mirp_gaussian_fill_lmn(int am, int * lmn);
 
 
-/*! \brief Normalize a shell (double precision)
+/*! \brief Normalize a shell (interval arithmetic)
  *
  * This function normalizes the contraction coefficients of the shell.
  *
@@ -87,6 +87,25 @@ void mirp_normalize_shell(int am, int nprim, int ngeneral,
                           slong working_prec);
 
 
+/*! \brief Normalize a shell (double precision)
+ *
+ * This function normalizes the contraction coefficients of the shell.
+ *
+ * \param [in] am         The angular momentum of the shell (0 = s, 1 = p, etc)
+ * \param [in] nprim      Number of primitives in the shell
+ * \param [in] ngeneral   Number of general contractions in the shell
+ * \param [in] alpha      The exponents of the shell (length \p nprim)
+ * \param [in] coeff      The (unnormalized) contraction coefficients
+ *                        (length \p nprim * \p ngeneral)
+ * \param [out] coeff_out Normalized contraction coefficients
+ *                        (length \p nprim * \p ngeneral)
+ */
+void mirp_normalize_shell_double(int am, int nprim, int ngeneral,
+                                 const double * alpha,
+                                 const double * coeff,
+                                 double * coeff_out);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,167 @@
+/*! \file
+ *
+ * \brief Precomputed data for a pair of shells
+ */
+
+#include "mirp/shellpair.h"
+#include "mirp/shell.h"
+#include "mirp/gpt.h"
+#include <assert.h>
+
+
+void mirp_shellpair_init(mirp_shellpair * sp,
+                         int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                         int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                         slong working_prec)
+{
+    assert(am1 >= 0); assert(nprim1 > 0); assert(ngen1 > 0);
+    assert(am2 >= 0); assert(nprim2 > 0); assert(ngen2 > 0);
+
+    const long nprim12 = nprim1 * nprim2;
+
+    sp->am1 = am1;
+    sp->am2 = am2;
+    sp->nprim1 = nprim1;
+    sp->nprim2 = nprim2;
+    sp->ngen1 = ngen1;
+    sp->ngen2 = ngen2;
+    sp->working_prec = working_prec;
+
+    /* Copy the inputs (exactly) */
+    sp->A = _arb_vec_init(3);
+    sp->B = _arb_vec_init(3);
+    sp->alpha1 = _arb_vec_init(nprim1);
+    sp->alpha2 = _arb_vec_init(nprim2);
+    sp->coeff1 = _arb_vec_init(nprim1*ngen1);
+    sp->coeff2 = _arb_vec_init(nprim2*ngen2);
+
+    _arb_vec_set(sp->A, A, 3);
+    _arb_vec_set(sp->B, B, 3);
+    _arb_vec_set(sp->alpha1, alpha1, nprim1);
+    _arb_vec_set(sp->alpha2, alpha2, nprim2);
+    _arb_vec_set(sp->coeff1, coeff1, nprim1*ngen1);
+    _arb_vec_set(sp->coeff2, coeff2, nprim2*ngen2);
+
+    arb_init(sp->AB2);
+    sp->gamma = _arb_vec_init(nprim12);
+    sp->P = _arb_vec_init(3*nprim12);
+    sp->PA = _arb_vec_init(3*nprim12);
+    sp->PB = _arb_vec_init(3*nprim12);
+    sp->K = _arb_vec_init(nprim12);
+    sp->coeff = _arb_vec_init(ngen1*ngen2*nprim12);
+
+    arb_t tmp;
+    arb_init(tmp);
+
+    /* Gaussian Product Theorem for every primitive pair,
+     * and K = exp(-alpha1 * alpha2 * AB2 / gamma)
+     */
+    for(int i = 0; i < nprim1; i++)
+    for(int j = 0; j < nprim2; j++)
+    {
+        const long ij = i*nprim2 + j;
+
+        mirp_gpt(alpha1 + i, alpha2 + j, A, B,
+                 sp->gamma + ij, sp->P + 3*ij, sp->PA + 3*ij, sp->PB + 3*ij, sp->AB2,
+                 working_prec);
+
+        arb_mul(tmp, alpha1 + i, alpha2 + j, working_prec);
+        arb_mul(tmp, tmp, sp->AB2, working_prec);
+        arb_div(tmp, tmp, sp->gamma + ij, working_prec);
+        arb_neg(tmp, tmp);
+        arb_exp(sp->K + ij, tmp, working_prec);
+    }
+
+    /* Products of the normalized coefficients */
+    arb_ptr coeff1_norm = _arb_vec_init(nprim1*ngen1);
+    arb_ptr coeff2_norm = _arb_vec_init(nprim2*ngen2);
+
+    mirp_normalize_shell(am1, nprim1, ngen1, alpha1, coeff1, coeff1_norm, working_prec);
+    mirp_normalize_shell(am2, nprim2, ngen2, alpha2, coeff2, coeff2_norm, working_prec);
+
+    for(int m = 0; m < ngen1; m++)
+    for(int n = 0; n < ngen2; n++)
+    for(int i = 0; i < nprim1; i++)
+    for(int j = 0; j < nprim2; j++)
+    {
+        const long idx = (m*ngen2 + n)*nprim12 + i*nprim2 + j;
+        arb_mul(sp->coeff + idx, coeff1_norm + (m*nprim1 + i), coeff2_norm + (n*nprim2 + j), working_prec);
+    }
+
+    _arb_vec_clear(coeff1_norm, nprim1*ngen1);
+    _arb_vec_clear(coeff2_norm, nprim2*ngen2);
+    arb_clear(tmp);
+}
+
+
+void mirp_shellpair_init_d(mirp_shellpair * sp,
+                           int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                           int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                           slong working_prec)
+{
+    arb_ptr A_mp = _arb_vec_init(3);
+    arb_ptr B_mp = _arb_vec_init(3);
+    arb_ptr alpha1_mp = _arb_vec_init(nprim1);
+    arb_ptr alpha2_mp = _arb_vec_init(nprim2);
+    arb_ptr coeff1_mp = _arb_vec_init(nprim1*ngen1);
+    arb_ptr coeff2_mp = _arb_vec_init(nprim2*ngen2);
+
+    for(int i = 0; i < 3; i++)
+    {
+        arb_set_d(A_mp + i, A[i]);
+        arb_set_d(B_mp + i, B[i]);
+    }
+
+    for(int i = 0; i < nprim1; i++)
+        arb_set_d(alpha1_mp + i, alpha1[i]);
+    for(int i = 0; i < nprim2; i++)
+        arb_set_d(alpha2_mp + i, alpha2[i]);
+
+    for(int i = 0; i < nprim1*ngen1; i++)
+        arb_set_d(coeff1_mp + i, coeff1[i]);
+    for(int i = 0; i < nprim2*ngen2; i++)
+        arb_set_d(coeff2_mp + i, coeff2[i]);
+
+    mirp_shellpair_init(sp,
+                        am1, A_mp, nprim1, ngen1, alpha1_mp, coeff1_mp,
+                        am2, B_mp, nprim2, ngen2, alpha2_mp, coeff2_mp,
+                        working_prec);
+
+    _arb_vec_clear(A_mp, 3);
+    _arb_vec_clear(B_mp, 3);
+    _arb_vec_clear(alpha1_mp, nprim1);
+    _arb_vec_clear(alpha2_mp, nprim2);
+    _arb_vec_clear(coeff1_mp, nprim1*ngen1);
+    _arb_vec_clear(coeff2_mp, nprim2*ngen2);
+}
+
+
+void mirp_shellpair_init_from(mirp_shellpair * sp, const mirp_shellpair * src,
+                              slong working_prec)
+{
+    mirp_shellpair_init(sp,
+                        src->am1, src->A, src->nprim1, src->ngen1, src->alpha1, src->coeff1,
+                        src->am2, src->B, src->nprim2, src->ngen2, src->alpha2, src->coeff2,
+                        working_prec);
+}
+
+
+void mirp_shellpair_clear(mirp_shellpair * sp)
+{
+    const long nprim12 = sp->nprim1 * sp->nprim2;
+
+    _arb_vec_clear(sp->A, 3);
+    _arb_vec_clear(sp->B, 3);
+    _arb_vec_clear(sp->alpha1, sp->nprim1);
+    _arb_vec_clear(sp->alpha2, sp->nprim2);
+    _arb_vec_clear(sp->coeff1, sp->nprim1*sp->ngen1);
+    _arb_vec_clear(sp->coeff2, sp->nprim2*sp->ngen2);
+
+    arb_clear(sp->AB2);
+    _arb_vec_clear(sp->gamma, nprim12);
+    _arb_vec_clear(sp->P, 3*nprim12);
+    _arb_vec_clear(sp->PA, 3*nprim12);
+    _arb_vec_clear(sp->PB, 3*nprim12);
+    _arb_vec_clear(sp->K, nprim12);
+    _arb_vec_clear(sp->coeff, sp->ngen1*sp->ngen2*nprim12);
+}
@@ -0,0 +1,125 @@
+/*! \file
+ *
+ * \brief Precomputed data for a pair of shells
+ */
+
+#pragma once
+
+#include <arb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Data for a pair of contracted shells that does not depend
+ *         on the other pair of a quartet
+ *
+ * This holds the results of the Gaussian Product Theorem for every
+ * primitive pair, as well as the products of the normalized contraction
+ * coefficients. When computing many quartets, each pair only needs
+ * to be built once and can then be used in all the quartets it
+ * appears in.
+ *
+ * The primitive pair index is ij = i * nprim2 + j, where i is the primitive
+ * on the first shell and j is the primitive on the second shell.
+ *
+ * A copy of the shell inputs is kept so that the pair can be rebuilt
+ * at a higher working precision (see \ref mirp_shellpair_init_from).
+ */
+typedef struct
+{
+    int am1, am2;        //!< Angular momentum of the two shells
+    int nprim1, nprim2;  //!< Number of primitives in the two shells
+    int ngen1, ngen2;    //!< Number of general contractions in the two shells
+    slong working_prec;  //!< Precision the data was computed with
+
+    arb_ptr A, B;            //!< Centers of the two shells (each of length 3)
+    arb_ptr alpha1, alpha2;  //!< Exponents of the two shells
+    arb_ptr coeff1, coeff2;  //!< Unnormalized coefficients of the two shells
+
+    arb_t AB2;      //!< Squared distance between the two centers
+    arb_ptr gamma;  //!< alpha1 + alpha2 (length nprim1*nprim2)
+    arb_ptr P;      //!< Center of the product gaussian (length 3*nprim1*nprim2, [ij][xyz])
+    arb_ptr PA;     //!< P - A (length 3*nprim1*nprim2, [ij][xyz])
+    arb_ptr PB;     //!< P - B (length 3*nprim1*nprim2, [ij][xyz])
+    arb_ptr K;      //!< exp(-alpha1 * alpha2 * AB2 / gamma) (length nprim1*nprim2)
+
+    /*! \brief Products of normalized coefficients
+     *
+     * Of length ngen1*ngen2*nprim1*nprim2. The product for general
+     * contractions m and n is at (m*ngen2 + n)*nprim1*nprim2 + ij
+     */
+    arb_ptr coeff;
+} mirp_shellpair;
+
+
+/*! \brief Computes the data for a pair of shells (interval arithmetic)
+ *
+ * The pair must be freed with \ref mirp_shellpair_clear
+ *
+ * \param [out] sp
+ *              The pair to initialize
+ * \param [in]  am1,am2
+ *              Angular momentum of the two shells
+ * \param [in]  A,B
+ *              XYZ coordinates of the two centers (each of length 3)
+ * \param [in]  nprim1,nprim2
+ *              Number of primitive gaussians for each shell
+ * \param [in]  ngen1,ngen2
+ *              Number of general contractions for each shell
+ * \param [in]  alpha1,alpha2
+ *              Exponents of the primitive gaussians of each shell
+ *              (of lengths \p nprim1 and \p nprim2 respectively)
+ * \param [in]  coeff1,coeff2
+ *              Coefficients for all primitives and for all general contractions
+ *              of each shell (of lengths \p nprim1 * \p ngen1 and
+ *              \p nprim2 * \p ngen2 respectively)
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+void mirp_shellpair_init(mirp_shellpair * sp,
+                         int am1, arb_srcptr A, int nprim1, int ngen1, arb_srcptr alpha1, arb_srcptr coeff1,
+                         int am2, arb_srcptr B, int nprim2, int ngen2, arb_srcptr alpha2, arb_srcptr coeff2,
+                         slong working_prec);
+
+
+/*! \brief Computes the data for a pair of shells (double precision input)
+ *
+ * The inputs are converted exactly to interval arithmetic.
+ *
+ * \copydetails mirp_shellpair_init
+ */
+void mirp_shellpair_init_d(mirp_shellpair * sp,
+                           int am1, const double * A, int nprim1, int ngen1, const double * alpha1, const double * coeff1,
+                           int am2, const double * B, int nprim2, int ngen2, const double * alpha2, const double * coeff2,
+                           slong working_prec);
+
+
+/*! \brief Computes the data for a pair of shells from the inputs of
+ *         another pair
+ *
+ * This is used to obtain the data for the same pair of shells at
+ * a different working precision.
+ *
+ * The pair must be freed with \ref mirp_shellpair_clear
+ *
+ * \param [out] sp
+ *              The pair to initialize
+ * \param [in]  src
+ *              The pair whose shells are to be used
+ * \param [in]  working_prec
+ *              The working precision (binary digits/bits) to use
+ *              in the calculation
+ */
+void mirp_shellpair_init_from(mirp_shellpair * sp, const mirp_shellpair * src,
+                              slong working_prec);
+
+
+/*! \brief Frees memory associated with a pair of shells */
+void mirp_shellpair_clear(mirp_shellpair * sp);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <arb.h>
+#include "mirp/shellpair.h"
+#include "mirp/workspace.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,6 +25,17 @@ typedef void (*cb_integral4_single)(arb_t,
                                     slong);
 
 
+/*! \brief Pointer to a function that computes a single cartesian integral
+ *         with temporaries taken from a workspace (four-center, interval arithmetic)
+ */
+typedef void (*cb_integral4_single_ws)(arb_t,
+                                       const int *, arb_srcptr, const arb_t,
+                                       const int *, arb_srcptr, const arb_t,
+                                       const int *, arb_srcptr, const arb_t,
+                                       const int *, arb_srcptr, const arb_t,
+                                       mirp_workspace *, slong);
+
+
 /*! \brief Pointer to a function that computes a single cartesian integral
  *         from string inputs (four-center)
  */
@@ -34,6 +47,19 @@ typedef void (*cb_integral4_single_str)(arb_t,
                                         slong);
 
 
+/*! \brief Pointer to a function that computes a single cartesian integral
+ *         from string inputs to a number of decimal digits (four-center)
+ *
+ * The function returns the working precision of its last attempt.
+ */
+typedef slong (*cb_integral4_single_target)(arb_t,
+                                            const int *, const char **, const char *,
+                                            const int *, const char **, const char *,
+                                            const int *, const char **, const char *,
+                                            const int *, const char **, const char *,
+                                            long);
+
+
 /*! \brief Pointer to a function that computes a single cartesian integral
  *         to exact double precision (four-center)
  */
@@ -44,6 +70,35 @@ typedef void (*cb_integral4_single_exact)(double * integral,
                                           const int * lmn4, const double * D, double alpha4);
 
 
+/*! \brief Pointer to a function that computes all cartesian integrals
+ *         for a primitive shell quartet (four-center, interval arithmetic)
+ */
+typedef void (*cb_integral4_prim)(arb_ptr,
+                                  int, arb_srcptr, const arb_t,
+                                  int, arb_srcptr, const arb_t,
+                                  int, arb_srcptr, const arb_t,
+                                  int, arb_srcptr, const arb_t,
+                                  slong);
+
+
+/*! \brief Pointer to a function that computes some of the cartesian integrals
+ *         for a primitive shell quartet (four-center, interval arithmetic)
+ *
+ * Only the components with the given indices (positions in the output of
+ * a \ref cb_integral4_prim) are computed. If the indices are NULL, all
+ * components are computed.
+ *
+ * Temporaries are taken from one workspace for each thread
+ * (see \ref mirp_workspace_nthreads).
+ */
+typedef void (*cb_integral4_prim_idx)(arb_ptr, const long *, long,
+                                      int, arb_srcptr, const arb_t,
+                                      int, arb_srcptr, const arb_t,
+                                      int, arb_srcptr, const arb_t,
+                                      int, arb_srcptr, const arb_t,
+                                      mirp_workspace *, slong);
+
+
 /*! \brief Pointer to a function that computes all cartesian integrals
  *         for a contracted shell quartet (four-center, interval arithmetic)
  */
@@ -66,6 +121,20 @@ typedef void (*cb_integral4_str)(arb_ptr,
                                  slong);
 
 
+/*! \brief Pointer to a function that computes all cartesian integrals
+ *         for a contracted shell quartet from string inputs to a number
+ *         of decimal digits (four-center)
+ *
+ * The function returns the working precision of its last attempt.
+ */
+typedef slong (*cb_integral4_target)(arb_ptr,
+                                     int, const char **, int, int, const char **, const char **,
+                                     int, const char **, int, int, const char **, const char **,
+                                     int, const char **, int, int, const char **, const char **,
+                                     int, const char **, int, int, const char **, const char **,
+                                     long);
+
+
 /*! \brief Pointer to a function that computes all cartesian integrals
  *         for a contracted shell quartet to exact double precision (four-center)
  */
@@ -75,6 +144,52 @@ typedef void (*cb_integral4_exact)(double *,
                                    int, const double *, int, int, const double *, const double *,
                                    int, const double *, int, int, const double *, const double *);
 
+
+/*! \brief Pointer to a function that bounds all cartesian integrals
+ *         of a primitive shell quartet (four-center)
+ *
+ * The function returns log2 of a rigorous upper bound on the absolute value
+ * of all the (unnormalized) cartesian integrals of the primitive quartet.
+ */
+typedef double (*cb_integral4_bound)(int, const double *, double,
+                                     int, const double *, double,
+                                     int, const double *, double,
+                                     int, const double *, double);
+
+
+/*! \brief Pointer to a function that computes the cartesian integrals
+ *         for a primitive shell quartet from precomputed shell pairs
+ *         (four-center, interval arithmetic)
+ *
+ * The primitive quartet is given by the primitive pair indices into the
+ * bra and ket pairs. Only the components with the given indices are
+ * computed (all of them if the indices are NULL), with temporaries taken
+ * from one workspace for each thread (see \ref cb_integral4_prim_idx).
+ */
+typedef void (*cb_integral4_shellpair_prim)(arb_ptr, const long *, long,
+                                            const mirp_shellpair *, int,
+                                            const mirp_shellpair *, int,
+                                            mirp_workspace *, slong);
+
+
+/*! \brief Pointer to a function that computes all cartesian integrals
+ *         for a contracted shell quartet from precomputed shell pairs
+ *         (four-center, interval arithmetic)
+ */
+typedef void (*cb_integral4_shellpair)(arb_ptr,
+                                       const mirp_shellpair *,
+                                       const mirp_shellpair *,
+                                       slong);
+
+
+/*! \brief Pointer to a function that computes all cartesian integrals
+ *         for a contracted shell quartet from precomputed shell pairs
+ *         to exact double precision (four-center)
+ */
+typedef void (*cb_integral4_shellpair_exact)(double *,
+                                             const mirp_shellpair *,
+                                             const mirp_shellpair *);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,158 @@
+/*! \file
+ *
+ * \brief Reusable storage for temporary variables of the kernels
+ */
+
+#include "mirp/workspace.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+/*! \brief Workspaces owned by the calling thread (see \ref mirp_workspace_local_get) */
+static mirp_workspace * mirp_workspace_local = NULL;
+
+/*! \brief Number of workspaces in \ref mirp_workspace_local */
+static int mirp_workspace_local_n = 0;
+
+/*! \brief Number of nested calls currently using \ref mirp_workspace_local */
+static int mirp_workspace_local_depth = 0;
+
+#ifdef _OPENMP
+#pragma omp threadprivate(mirp_workspace_local, mirp_workspace_local_n, mirp_workspace_local_depth)
+#endif
+
+
+void mirp_workspace_init(mirp_workspace * ws, slong size)
+{
+    assert(size > 0);
+
+    ws->size = size;
+    ws->top = 0;
+    ws->pool = _arb_vec_init(size);
+}
+
+
+void mirp_workspace_clear(mirp_workspace * ws)
+{
+    assert(ws->top == 0);
+
+    _arb_vec_clear(ws->pool, ws->size);
+}
+
+
+arb_ptr mirp_workspace_vec_init(mirp_workspace * ws, slong n)
+{
+    if(ws == NULL || ws->top + n > ws->size)
+        return _arb_vec_init(n);
+
+    arb_ptr v = ws->pool + ws->top;
+    ws->top += n;
+    return v;
+}
+
+
+void mirp_workspace_vec_clear(mirp_workspace * ws, arb_ptr v, slong n)
+{
+    /* Was this allocated separately? (An empty vector at the very
+     * end of the pool still belongs to the pool) */
+    if(ws == NULL || v < ws->pool || v > ws->pool + ws->size)
+    {
+        _arb_vec_clear(v, n);
+        return;
+    }
+
+    /* Must be returned in the opposite order they were obtained */
+    assert(v + n == ws->pool + ws->top);
+    ws->top -= n;
+}
+
+
+int mirp_workspace_nthreads(void)
+{
+    #ifdef _OPENMP
+    /* A parallel region started from here only gets a single
+     * thread if no more levels may be active */
+    if(omp_get_active_level() >= omp_get_max_active_levels())
+        return 1;
+    return omp_get_max_threads();
+    #else
+    return 1;
+    #endif
+}
+
+
+mirp_workspace * mirp_workspace_thread(mirp_workspace * ws)
+{
+    if(ws == NULL)
+        return NULL;
+
+    #ifdef _OPENMP
+    return ws + omp_get_thread_num();
+    #else
+    return ws;
+    #endif
+}
+
+
+mirp_workspace * mirp_workspace_local_get(int n, slong size)
+{
+    assert(n > 0);
+    assert(size > 0);
+
+    if(mirp_workspace_local_depth > 0)
+    {
+        /* In use further up, so nothing may be moved or enlarged */
+        if(n > mirp_workspace_local_n)
+            return NULL;
+    }
+    else
+    {
+        if(n > mirp_workspace_local_n)
+        {
+            mirp_workspace_local = realloc(mirp_workspace_local, n * sizeof(mirp_workspace));
+            for(int i = mirp_workspace_local_n; i < n; i++)
+                mirp_workspace_init(mirp_workspace_local + i, size);
+            mirp_workspace_local_n = n;
+        }
+
+        for(int i = 0; i < n; i++)
+        {
+            if(mirp_workspace_local[i].size < size)
+            {
+                mirp_workspace_clear(mirp_workspace_local + i);
+                mirp_workspace_init(mirp_workspace_local + i, size);
+            }
+        }
+    }
+
+    mirp_workspace_local_depth++;
+    return mirp_workspace_local;
+}
+
+
+void mirp_workspace_local_release(mirp_workspace * ws)
+{
+    if(ws == NULL)
+        return;
+
+    assert(ws == mirp_workspace_local);
+    assert(mirp_workspace_local_depth > 0);
+    mirp_workspace_local_depth--;
+}
+
+
+void mirp_workspace_local_clear(void)
+{
+    assert(mirp_workspace_local_depth == 0);
+
+    for(int i = 0; i < mirp_workspace_local_n; i++)
+        mirp_workspace_clear(mirp_workspace_local + i);
+
+    free(mirp_workspace_local);
+    mirp_workspace_local = NULL;
+    mirp_workspace_local_n = 0;
+}
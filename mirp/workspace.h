@@ -0,0 +1,145 @@
+/*! \file
+ *
+ * \brief Reusable storage for temporary variables of the kernels
+ */
+
+#pragma once
+
+#include <arb.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief Number of temporaries needed by the four-center kernels
+ *         for shells with angular momentum up to \p max_am
+ *
+ * This covers both the single-integral and the primitive-quartet kernels
+ * (the latter also hold the f-arrays for all cartesian components).
+ * The workspace will still work if it is smaller than this, however
+ * some temporaries will then be allocated on each call.
+ */
+#define MIRP_WORKSPACE_SIZE4(max_am) \
+    (20*(4*(max_am)+1) + 6*((max_am)+1)*((max_am)+1)*((max_am)+1) + \
+     2*(((4*(max_am))/6+2)*((4*(max_am))/6+2)*((4*(max_am))/6+2)) + 64)
+
+
+/*! \brief A stack of preinitialized arb_t temporaries
+ *
+ * Kernels that take a workspace (the `_ws` variants) obtain their
+ * temporaries from it rather than calling arb_init/_arb_vec_init. Since the
+ * temporaries are never cleared between uses, the memory they hold
+ * (including the limbs of high-precision values) is reused, and
+ * the kernels do not need to allocate memory once the workspace
+ * is warmed up.
+ *
+ * A workspace must only be used by one thread at a time. Typically,
+ * each thread creates its own, or uses the ones it keeps between calls
+ * (see \ref mirp_workspace_local_get).
+ */
+typedef struct
+{
+    slong size;     //!< Total number of temporaries
+    slong top;      //!< Number of temporaries currently in use
+    arb_ptr pool;   //!< The temporaries themselves
+} mirp_workspace;
+
+
+/*! \brief Initializes a workspace
+ *
+ * The workspace must be freed with \ref mirp_workspace_clear
+ *
+ * \param [out] ws   The workspace to initialize
+ * \param [in]  size Number of temporaries to hold (see \ref MIRP_WORKSPACE_SIZE4)
+ */
+void mirp_workspace_init(mirp_workspace * ws, slong size);
+
+
+/*! \brief Frees memory associated with a workspace */
+void mirp_workspace_clear(mirp_workspace * ws);
+
+
+/*! \brief Obtains a vector of temporaries from a workspace
+ *
+ * Vectors must be returned with \ref mirp_workspace_vec_clear in the opposite
+ * order in which they were obtained.
+ *
+ * Unlike _arb_vec_init, the contents of the vector are not defined.
+ *
+ * If \p ws is NULL or does not have enough space left, the vector
+ * is allocated with _arb_vec_init instead.
+ *
+ * \param [in] ws The workspace to use (may be NULL)
+ * \param [in] n  Length of the vector
+ * \return A vector of \p n temporaries
+ */
+arb_ptr mirp_workspace_vec_init(mirp_workspace * ws, slong n);
+
+
+/*! \brief Returns a vector of temporaries to a workspace
+ *
+ * \param [in] ws The workspace \p v was obtained from (may be NULL)
+ * \param [in] v  The vector to return
+ * \param [in] n  Length of the vector
+ */
+void mirp_workspace_vec_clear(mirp_workspace * ws, arb_ptr v, slong n);
+
+
+/*! \brief Number of workspaces needed to give each thread its own
+ *
+ * Kernels that split their work among OpenMP threads themselves (such as
+ * \ref mirp_gtoeri_prim_ws) take an array of this many workspaces, one
+ * for each thread of their parallel region. The array is created by the
+ * caller and can be reused for any number of calls.
+ *
+ * This is 1 without OpenMP, or inside a parallel region that
+ * cannot be nested further.
+ */
+int mirp_workspace_nthreads(void);
+
+
+/*! \brief Obtains the workspace of the calling thread
+ *
+ * \param [in] ws Array of \ref mirp_workspace_nthreads workspaces (may be NULL)
+ * \return The workspace for the calling thread (NULL if \p ws is NULL)
+ */
+mirp_workspace * mirp_workspace_thread(mirp_workspace * ws);
+
+
+/*! \brief Obtains workspaces owned by the calling thread
+ *
+ * Each thread keeps its own array of workspaces between calls, so that
+ * functions without a workspace argument (such as \ref mirp_gtoeri_single)
+ * do not need to create one every time. The array and the workspaces in it
+ * are enlarged as needed, but only while none of them are in use.
+ *
+ * The workspaces must be returned with \ref mirp_workspace_local_release.
+ * Calls may be nested (on the same thread), as long as the workspaces are
+ * used in a LIFO manner as usual. A nested call may return workspaces smaller
+ * than \p size (see \ref mirp_workspace_vec_init).
+ *
+ * \param [in] n    Number of workspaces (for example, \ref mirp_workspace_nthreads)
+ * \param [in] size Number of temporaries each workspace should hold
+ * \return An array of \p n workspaces, or NULL if a nested call needs more
+ *         workspaces than are available
+ */
+mirp_workspace * mirp_workspace_local_get(int n, slong size);
+
+
+/*! \brief Returns workspaces obtained with \ref mirp_workspace_local_get
+ *
+ * \param [in] ws The workspaces to return (may be NULL)
+ */
+void mirp_workspace_local_release(mirp_workspace * ws);
+
+
+/*! \brief Frees the workspaces owned by the calling thread
+ *
+ * \warning This must not be called while the workspaces are in use.
+ */
+void mirp_workspace_local_clear(void);
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -16,10 +16,12 @@ struct callback_helper<4>
 {
     typedef cb_integral4                cb_type;
     typedef cb_integral4_str            cb_str_type;
+    typedef cb_integral4_target         cb_target_type;
     typedef cb_integral4_exact          cb_exact_type;
 
     typedef cb_integral4_single         cb_single_type;
     typedef cb_integral4_single_str     cb_single_str_type;
+    typedef cb_integral4_single_target  cb_single_target_type;
     typedef cb_integral4_single_exact   cb_single_exact_type;
 
     static void 
@@ -42,6 +44,26 @@ struct callback_helper<4>
     }
 
 
+    static slong
+    call_target(arb_ptr integrals,
+                std::array<int, 4> & am,
+                std::array<std::array<const char *, 3>, 4> & xyz,
+                std::array<int, 4> & nprim,
+                std::array<int, 4> & ngeneral,
+                std::array<std::vector<const char *>, 4> & alpha,
+                std::array<std::vector<const char *>, 4> & coeff,
+                long ndigits,
+                cb_target_type cb)
+    {
+        return cb(integrals,
+                  am[0], xyz[0].data(), nprim[0], ngeneral[0], alpha[0].data(), coeff[0].data(),
+                  am[1], xyz[1].data(), nprim[1], ngeneral[1], alpha[1].data(), coeff[1].data(),
+                  am[2], xyz[2].data(), nprim[2], ngeneral[2], alpha[2].data(), coeff[2].data(),
+                  am[3], xyz[3].data(), nprim[3], ngeneral[3], alpha[3].data(), coeff[3].data(),
+                  ndigits);
+    }
+
+
     static void
     call(arb_ptr integrals,
          std::array<int, 4> & am,
@@ -114,6 +136,23 @@ struct callback_helper<4>
     }
 
 
+    static slong
+    call_single_target(arb_t integral,
+                       std::array<std::array<int, 3>, 4> & lmn,
+                       std::array<std::array<const char *, 3>, 4> & xyz,
+                       std::array<const char *, 4> & alpha,
+                       long ndigits,
+                       cb_single_target_type cb)
+    {
+        return cb(integral,
+                  lmn[0].data(), xyz[0].data(), alpha[0],
+                  lmn[1].data(), xyz[1].data(), alpha[1],
+                  lmn[2].data(), xyz[2].data(), alpha[2],
+                  lmn[3].data(), xyz[3].data(), alpha[3],
+                  ndigits);
+    }
+
+
     static void
     call_single_exact(double * integral,
                       std::array<std::array<int, 3>, 4> & lmn,
@@ -0,0 +1,293 @@
+/*! \file
+ *
+ * \brief mirp_boys_bench main function
+ */
+
+#include "mirp_bin/cmdline.hpp"
+#include "mirp_bin/test_boys.hpp"
+
+#include <mirp/kernels/boys.h>
+
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace mirp;
+
+
+/*! \brief Working precisions the crossover points are measured at */
+static const slong bench_precs[] = { 256, 512, 1024, 2048, 4096 };
+
+/*! \brief Candidates for the smallest m using the incomplete gamma function */
+static const int bench_gamma_min_m[] = { 0, 4, 8, 16, 32, 64, INT_MAX };
+
+/*! \brief Candidates for the start of the incomplete gamma function (relative to m + 3/2) */
+static const double bench_gamma_lo[] = { 0.125, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 4.0 };
+
+/*! \brief Candidates for the start of upward recursion (relative to m + 3/2) */
+static const double bench_upward[] = { 0.25, 0.5, 0.75, 0.8125, 0.875, 0.9375, 1.0, 1.5, 2.0, 4.0 };
+
+/*! \brief Number of bits upward recursion may lose in addition to the series
+ *
+ * Upward recursion is only used where it is at most this much less accurate.
+ * This is well below the margin of the precision predictions.
+ */
+static const slong bench_upward_max_extra = 4;
+
+/*! \brief Entries with t beyond this (relative to m + 3/2) are not measured
+ *
+ * The series converges too slowly there, and these entries always
+ * use upward recursion or the asymptotic form.
+ */
+static const double bench_max_ratio = 4.0;
+
+
+/*! \brief Timings of the engines for a single entry */
+struct bench_timing
+{
+    int m;          //!< Order of the entry
+    double ratio;   //!< t / (m + 3/2)
+    double series;  //!< Time of the series engine (seconds)
+    double gamma;   //!< Time of the incomplete gamma engine (seconds)
+    double upward;  //!< Time of upward recursion (seconds)
+    slong upward_extra; //!< Bits lost by upward recursion in addition to the series
+};
+
+
+static void print_help(void)
+{
+    std::cout << "\n"
+              << "mirp_boys_bench - Measure the crossover points between the engines of the\n"
+              << "                  Boys function\n"
+              << "\n"
+              << "For each working precision, the fastest crossover points between the\n"
+              << "series, the incomplete gamma function, and upward recursion are printed.\n"
+              << "Upward recursion is only used from where it is about as accurate as\n"
+              << "the series. Entries for which mirp_boys_engine_select chooses the\n"
+              << "asymptotic form are skipped.\n"
+              << "\n"
+              << "\n"
+              << "Required arguments:\n"
+              << "    --file         Input file to use (for example, tests/boys_large_range.inp)\n"
+              << "\n"
+              << "\n"
+              << "Other arguments:\n"
+              << "    --repeat       Number of times to time each entry (the fastest is used)\n"
+              << "    -h, --help     Display this help screen\n"
+              << "\n";
+}
+
+
+/*! \brief Times a single engine for a single entry */
+static double bench_engine(arb_ptr F, int m, const arb_t t, mirp_boys_engine engine,
+                           mirp_workspace * ws, slong working_prec, long repeat)
+{
+    double best = 0.0;
+
+    for(long r = 0; r < repeat; r++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        mirp_boys_engine_ws(F, m, t, engine, ws, working_prec);
+        const auto end = std::chrono::steady_clock::now();
+
+        const double elapsed = std::chrono::duration<double>(end - start).count();
+        if(r == 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+}
+
+
+/*! \brief Formats a crossover factor (HUGE_VAL if never) */
+static std::string bench_factor_str(double factor)
+{
+    if(std::isinf(factor))
+        return "HUGE_VAL";
+
+    std::stringstream ss;
+    ss << factor;
+    return ss.str();
+}
+
+
+/*! \brief Number of bits lost in the values computed by an engine */
+static slong bench_lost_bits(arb_srcptr F, int m, slong working_prec)
+{
+    slong min_bits = working_prec;
+    for(int i = 0; i <= m; i++)
+    {
+        const slong bits = arb_rel_accuracy_bits(F + i);
+        if(bits < min_bits)
+            min_bits = bits;
+    }
+    return working_prec - min_bits;
+}
+
+
+/*! \brief Determines if upward recursion is accurate enough from a given start */
+static bool bench_upward_ok(const std::vector<bench_timing> & timings, double upward)
+{
+    for(const auto & tm : timings)
+    {
+        if(tm.ratio >= upward && tm.upward_extra > bench_upward_max_extra)
+            return false;
+    }
+    return true;
+}
+
+
+/*! \brief Total time of all entries if the given crossover points were used */
+static double bench_total(const std::vector<bench_timing> & timings,
+                          int gamma_min_m, double gamma_lo, double upward)
+{
+    double total = 0.0;
+
+    for(const auto & tm : timings)
+    {
+        if(tm.ratio >= upward)
+            total += tm.upward;
+        else if(tm.m >= gamma_min_m && tm.ratio >= gamma_lo)
+            total += tm.gamma;
+        else
+            total += tm.series;
+    }
+
+    return total;
+}
+
+
+/*! \brief Main function */
+int main(int argc, char ** argv)
+{
+    std::string file;
+    long repeat;
+
+    try {
+        auto cmdline = convert_cmdline(argc, argv);
+        if(cmdline.size() == 0 || cmdline_get_switch(cmdline, "-h") || cmdline_get_switch(cmdline, "--help"))
+        {
+            print_help();
+            return 0;
+        }
+
+        file = cmdline_get_arg_str(cmdline, "--file");
+        repeat = cmdline_get_arg_long(cmdline, "--repeat", 3);
+
+        if(repeat <= 0)
+            throw std::runtime_error("Argument to --repeat must be positive");
+
+        if(cmdline.size() != 0)
+        {
+            std::stringstream ss;
+            ss << "Unknown command line arguments:\n";
+            for(const auto & it : cmdline)
+                ss << "  " << it << "\n";
+            throw std::runtime_error(ss.str());
+        }
+    }
+    catch(std::exception & ex)
+    {
+        std::cout << "\nError parsing command line: " << ex.what() << "\n\n";
+        std::cout << "Run \"mirp_boys_bench -h\" for help\n\n";
+        return 1;
+    }
+
+    try
+    {
+        boys_data data = boys_read_file(file, true);
+        const int max_m = boys_max_m(data);
+
+        mirp_workspace ws;
+        mirp_workspace_init(&ws, MIRP_BOYS_WORKSPACE_SIZE);
+
+        arb_t t;
+        arb_init(t);
+        arb_ptr F = _arb_vec_init(max_m+1);
+
+        for(slong working_prec : bench_precs)
+        {
+            std::vector<bench_timing> timings;
+
+            for(const auto & ent : data.entries)
+            {
+                arb_set_str(t, ent.t.c_str(), working_prec);
+
+                bench_timing tm;
+                tm.m = ent.m;
+                tm.ratio = arf_get_d(arb_midref(t), ARF_RND_NEAR) / (ent.m + 1.5);
+
+                if(tm.ratio >= bench_max_ratio)
+                    continue;
+                if(mirp_boys_engine_select(ent.m, t, working_prec) == MIRP_BOYS_ENGINE_ASYMPTOTIC)
+                    continue;
+
+                tm.series = bench_engine(F, ent.m, t, MIRP_BOYS_ENGINE_SERIES, &ws, working_prec, repeat);
+                const slong series_lost = bench_lost_bits(F, ent.m, working_prec);
+                tm.upward = bench_engine(F, ent.m, t, MIRP_BOYS_ENGINE_UPWARD, &ws, working_prec, repeat);
+                tm.upward_extra = bench_lost_bits(F, ent.m, working_prec) - series_lost;
+                tm.gamma = bench_engine(F, ent.m, t, MIRP_BOYS_ENGINE_GAMMA, &ws, working_prec, repeat);
+
+                timings.push_back(tm);
+            }
+
+            /* Find the fastest row. Upward recursion is only
+             * considered where it is accurate enough */
+            int best_min_m = INT_MAX;
+            double best_lo = 1.0, best_upward = HUGE_VAL;
+            double best_total = bench_total(timings, best_min_m, best_lo, best_upward);
+
+            for(int min_m : bench_gamma_min_m)
+            for(double lo : bench_gamma_lo)
+            for(double upward : bench_upward)
+            {
+                if(!bench_upward_ok(timings, upward))
+                    continue;
+
+                const double total = bench_total(timings, min_m, lo, upward);
+                if(total < best_total)
+                {
+                    best_min_m = min_m;
+                    best_lo = lo;
+                    best_upward = upward;
+                    best_total = total;
+                }
+            }
+
+            /* Smallest start of upward recursion that is accurate enough,
+             * regardless of the timings */
+            double upward_min = HUGE_VAL;
+            for(double upward : bench_upward)
+            {
+                if(upward < upward_min && bench_upward_ok(timings, upward))
+                    upward_min = upward;
+            }
+
+            std::cout << "Precision " << working_prec << ": " << timings.size() << " entries, "
+                      << best_total << " s (without the incomplete gamma function and upward recursion: "
+                      << bench_total(timings, INT_MAX, 1.0, HUGE_VAL) << " s)\n"
+                      << "    Upward recursion is accurate enough from "
+                      << bench_factor_str(upward_min) << " * (m + 3/2)\n"
+                      << "    Fastest: incomplete gamma function for m >= "
+                      << (best_min_m == INT_MAX ? std::string("(never)") : std::to_string(best_min_m))
+                      << " and t >= " << best_lo << " * (m + 3/2), upward recursion from "
+                      << bench_factor_str(best_upward) << " * (m + 3/2)\n";
+        }
+
+        arb_clear(t);
+        _arb_vec_clear(F, max_m+1);
+        mirp_workspace_clear(&ws);
+    }
+    catch(std::exception & ex)
+    {
+        std::cout << "Error while running benchmark: " << ex.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -8,6 +8,7 @@
 #include "mirp_bin/ref_integral.hpp"
 
 #include <mirp/kernels/all.h>
+#include <mirp/precision.h>
 
 #include <sstream>
 #include <iostream>
@@ -35,9 +36,16 @@ static void print_help(void)
               << "    --am           Comma-separated list of AM classes to calculate.\n"
               << "                   The AM should be represented by their letters.\n"
               << "                   (for example, for ERI: --am ssss,psps,dddd)\n"
+              << "    --schwarz      Use Schwarz screening. Quartets that are guaranteed to be\n"
+              << "                   zero in double precision are not computed. Quartets\n"
+              << "                   whose bound is below the given threshold are written\n"
+              << "                   as screened (with the bound) rather than computed\n"
+              << "                   (for example, --schwarz 1e-16; use 0 to only skip zeros)\n"
               << "\n"
               << "\n"
               << "Other arguments:\n"
+              << "    --stats        Print escalation statistics of the exact functions\n"
+              << "                   (final precisions, attempts, wasted evaluations, time)\n"
               << "    -h, --help     Display this help screen\n"
               << "\n";
 }
@@ -50,6 +58,8 @@ int main(int argc, char ** argv)
     std::string basfile, xyzfile, outfile;
     std::string integral;
     std::vector<std::vector<int>> amlist;
+    double schwarz_threshold = -1.0;
+    bool stats = false;
 
     try {
         auto cmdline = convert_cmdline(argc, argv);
@@ -63,6 +73,7 @@ int main(int argc, char ** argv)
         xyzfile = cmdline_get_arg_str(cmdline, "--geometry");
         outfile = cmdline_get_arg_str(cmdline, "--outfile");
         integral = cmdline_get_arg_str(cmdline, "--integral");
+        stats = cmdline_get_switch(cmdline, "--stats");
 
         if(cmdline_has_arg(cmdline, "--am"))
         {
@@ -79,6 +90,13 @@ int main(int argc, char ** argv)
 
         }
 
+        if(cmdline_has_arg(cmdline, "--schwarz"))
+        {
+            schwarz_threshold = std::stod(cmdline_get_arg_str(cmdline, "--schwarz"));
+            if(schwarz_threshold < 0.0)
+                throw std::runtime_error("Schwarz threshold must not be negative");
+        }
+
         if(cmdline.size() != 0)
         {
             std::stringstream ss;
@@ -104,18 +122,29 @@ int main(int argc, char ** argv)
         header += " " + std::string(argv[i]);
     header += "\n#\n";
 
+    if(stats)
+    {
+        mirp_exact_stats_enable(1);
+        mirp_prec_stats_reset();
+    }
+
     try
     {
         if(integral == "gtoeri")
         {
             integral4_create_reference(xyzfile, basfile, outfile, header,
-                                       amlist, mirp_gtoeri_exact);
+                                       amlist, schwarz_threshold,
+                                       mirp_gtoeri_shellpair_exact,
+                                       mirp_gtoeri_shellpair);
         }
         else
         {
             std::cout << "Integral \"" << integral << "\" is not valid\n";
             return 3;
         }
+
+        if(stats)
+            print_exact_stats();
     }
     catch(std::exception & ex)
     {
@@ -30,11 +30,21 @@ static void print_help(void)
               << "                       boys\n"
               << "                       gtoeri\n"
               << "                       gtoeri_single\n"
-              << "    --prec         Working precision to use in the calculation\n"
+              << "                       gtoeri_hgp\n"
+              << "                       gtoeri_rys\n"
+              << "                       gtoeri_rys_single\n"
+              << "                       gtoeri_md\n"
+              << "                       gtoeri_md_single\n"
+              << "    --prec         Working precision to use in the calculation. If \"auto\",\n"
+              << "                       the precision is raised separately for each entry,\n"
+              << "                       only as far as needed for --ndigits\n"
               << "    --ndigits      Number of decimal digits to write for each integral\n"
               << "\n"
               << "\n"
               << "Other arguments:\n"
+              << "    --threads      Number of threads to compute entries with (default: 1).\n"
+              << "                       The output file is the same as with a single\n"
+              << "                       thread. Requires OpenMP\n"
               << "    -h, --help     Display this help screen\n"
               << "\n";
 }
@@ -48,6 +58,7 @@ int main(int argc, char ** argv)
     std::string integral;
     long ndigits;
     long working_prec;
+    int nthreads = 1;
 
     try {
         auto cmdline = convert_cmdline(argc, argv);
@@ -61,7 +72,26 @@ int main(int argc, char ** argv)
         outfile = cmdline_get_arg_str(cmdline, "--outfile");
         integral = cmdline_get_arg_str(cmdline, "--integral");
         ndigits = cmdline_get_arg_long(cmdline, "--ndigits");
-        working_prec = cmdline_get_arg_long(cmdline, "--prec");
+        const std::string prec_str = cmdline_get_arg_str(cmdline, "--prec");
+        if(prec_str == "auto")
+            working_prec = 0;
+        else
+        {
+            std::stringstream ss(prec_str);
+            ss >> working_prec;
+
+            if(!ss.eof() || working_prec <= 0)
+                throw std::runtime_error("Argument to --prec is not a positive integer or \"auto\"");
+        }
+
+        nthreads = static_cast<int>(cmdline_get_arg_long(cmdline, "--threads", 1));
+        if(nthreads <= 0)
+            throw std::runtime_error("Argument to --threads must be positive");
+
+        #ifndef _OPENMP
+        if(nthreads > 1)
+            throw std::runtime_error("--threads requires MIRP to be built with OpenMP (MIRP_OPENMP)");
+        #endif
 
         if(cmdline.size() != 0)
         {
@@ -79,30 +109,68 @@ int main(int argc, char ** argv)
         return 1;
     }
 
-    // Create a header from the command line
+    // Create a header from the command line. The number of threads
+    // is left out, since it does not change the output
     std::string header("# Reference values for the ");
     header += integral;
     header += " integral generated with:\n";
     header += "#  ";
     for(int i = 0; i < argc; i++)
+    {
+        if(std::string(argv[i]) == "--threads")
+        {
+            i++;
+            continue;
+        }
         header += " " + std::string(argv[i]);
+    }
     header += "\n#\n";
 
     try
     {
         if(integral == "boys")
-            boys_create_test(infile, outfile, working_prec, ndigits, header);
+            boys_create_test(infile, outfile, working_prec, ndigits, header, nthreads);
         else if(integral == "gtoeri")
         {
             integral_create_test<4>(infile, outfile,
                                     working_prec, ndigits, header,
-                                    mirp_gtoeri_str);
+                                    mirp_gtoeri_str, mirp_gtoeri_target, nthreads);
         }
         else if(integral == "gtoeri_single")
         {
             integral_single_create_test<4>(infile, outfile,
                                            working_prec, ndigits, header,
-                                           mirp_gtoeri_single_str);
+                                           mirp_gtoeri_single_str, mirp_gtoeri_single_target, nthreads);
+        }
+        else if(integral == "gtoeri_hgp")
+        {
+            integral_create_test<4>(infile, outfile,
+                                    working_prec, ndigits, header,
+                                    mirp_gtoeri_hgp_str, mirp_gtoeri_hgp_target, nthreads);
+        }
+        else if(integral == "gtoeri_rys")
+        {
+            integral_create_test<4>(infile, outfile,
+                                    working_prec, ndigits, header,
+                                    mirp_gtoeri_rys_str, mirp_gtoeri_rys_target, nthreads);
+        }
+        else if(integral == "gtoeri_rys_single")
+        {
+            integral_single_create_test<4>(infile, outfile,
+                                           working_prec, ndigits, header,
+                                           mirp_gtoeri_rys_single_str, mirp_gtoeri_rys_single_target, nthreads);
+        }
+        else if(integral == "gtoeri_md")
+        {
+            integral_create_test<4>(infile, outfile,
+                                    working_prec, ndigits, header,
+                                    mirp_gtoeri_md_str, mirp_gtoeri_md_target, nthreads);
+        }
+        else if(integral == "gtoeri_md_single")
+        {
+            integral_single_create_test<4>(infile, outfile,
+                                           working_prec, ndigits, header,
+                                           mirp_gtoeri_md_single_str, mirp_gtoeri_md_single_target, nthreads);
         }
         else
         {
@@ -6,8 +6,10 @@
 #include "mirp_bin/cmdline.hpp"
 #include "mirp_bin/test_boys.hpp"
 #include "mirp_bin/test_integral.hpp"
+#include "mirp_bin/test_common.hpp"
 
 #include <mirp/kernels/all.h>
+#include <mirp/precision.h>
 
 #include <sstream>
 #include <iostream>
@@ -25,11 +27,18 @@ static void print_help(void)
               << "    --file         File to test with\n"
               << "    --integral     The type of integral to compute. Possibilities are:\n"
               << "                       boys\n"
-              << "                       eri\n"
-              << "                       eri_single\n"
+              << "                       gtoeri\n"
+              << "                       gtoeri_single\n"
+              << "                       gtoeri_hgp\n"
+              << "                       gtoeri_rys\n"
+              << "                       gtoeri_rys_single\n"
+              << "                       gtoeri_md\n"
+              << "                       gtoeri_md_single\n"
               << "    --float        Type of floating-point to test with. Possibilities are:\n"
               << "                       interval\n"
               << "                       exact\n"
+              << "                       grid (Boys function only)\n"
+              << "                       simd (Boys function only, reports the max ULP error)\n"
               << "    --prec         Working precision in binary digits (bits) to test (required for --float interval)\n"
               << "\n"
               << "\n"
@@ -40,6 +49,10 @@ static void print_help(void)
               << "\n"
               << "\n"
               << "Other arguments:\n"
+              << "    --stats        Print escalation statistics of the exact functions\n"
+              << "                   (final precisions, attempts, wasted evaluations, time)\n"
+              << "    --threads      Number of threads to test entries with (default: 1). The output\n"
+              << "                   is the same as with a single thread. Requires OpenMP\n"
               << "    -h, --help     Display this help screen\n"
               << "\n";
 }
@@ -52,6 +65,8 @@ int main(int argc, char ** argv)
     std::string floattype;
     long working_prec = 0;
     int extra_m = 0;
+    bool stats = false;
+    int nthreads = 1;
 
     try {
         auto cmdline = convert_cmdline(argc, argv);
@@ -64,8 +79,18 @@ int main(int argc, char ** argv)
         file = cmdline_get_arg_str(cmdline, "--file");
         integral = cmdline_get_arg_str(cmdline, "--integral");
         floattype = cmdline_get_arg_str(cmdline, "--float");
+        stats = cmdline_get_switch(cmdline, "--stats");
+        nthreads = static_cast<int>(cmdline_get_arg_long(cmdline, "--threads", 1));
 
-        if(floattype != "exact")
+        if(nthreads <= 0)
+            throw std::runtime_error("Argument to --threads must be positive");
+
+        #ifndef _OPENMP
+        if(nthreads > 1)
+            throw std::runtime_error("--threads requires MIRP to be built with OpenMP (MIRP_OPENMP)");
+        #endif
+
+        if(floattype != "exact" && floattype != "grid" && floattype != "simd")
             working_prec = cmdline_get_arg_long(cmdline, "--prec");
         else if(cmdline_has_arg(cmdline, "--prec"))
             throw std::runtime_error("--prec is not valid for this floating-point type");
@@ -93,22 +118,28 @@ int main(int argc, char ** argv)
     }
 
 
+    if(stats)
+    {
+        mirp_exact_stats_enable(1);
+        mirp_prec_stats_reset();
+    }
+
     try
     {
         long nfailed = -1;
         if(integral == "boys")
         {
-            nfailed = boys_verify_test_main(file, floattype, extra_m, working_prec);
+            nfailed = boys_verify_test_main(file, floattype, extra_m, working_prec, nthreads);
         }
         else if(integral == "gtoeri_single")
         {
             if(floattype == "interval")
             {
-                nfailed = integral_single_verify_test<4>(file, working_prec, mirp_gtoeri_single_str);
+                nfailed = integral_single_verify_test<4>(file, working_prec, mirp_gtoeri_single_str, nthreads);
             }
             else if(floattype == "exact")
             {
-                nfailed = integral_single_verify_test_exact<4>(file, mirp_gtoeri_single_exact, mirp_gtoeri_single);
+                nfailed = integral_single_verify_test_exact<4>(file, mirp_gtoeri_single_exact, mirp_gtoeri_single, nthreads);
             }
             else
             {
@@ -120,11 +151,91 @@ int main(int argc, char ** argv)
         {
             if(floattype == "interval")
             {
-                nfailed = integral_verify_test<4>(file, working_prec, mirp_gtoeri_str);
+                nfailed = integral_verify_test<4>(file, working_prec, mirp_gtoeri_str, nthreads);
+            }
+            else if(floattype == "exact")
+            {
+                nfailed = integral_verify_test_exact<4>(file, mirp_gtoeri_exact, mirp_gtoeri, nthreads);
+            }
+            else
+            {
+                std::cout << "Float type \"" << floattype << " not valid for integral \"" << integral << "\"\n";
+                return 1;
+            }
+        }
+        else if(integral == "gtoeri_hgp")
+        {
+            if(floattype == "interval")
+            {
+                nfailed = integral_verify_test<4>(file, working_prec, mirp_gtoeri_hgp_str, nthreads);
+            }
+            else if(floattype == "exact")
+            {
+                nfailed = integral_verify_test_exact<4>(file, mirp_gtoeri_hgp_exact, mirp_gtoeri_hgp, nthreads);
+            }
+            else
+            {
+                std::cout << "Float type \"" << floattype << " not valid for integral \"" << integral << "\"\n";
+                return 1;
+            }
+        }
+        else if(integral == "gtoeri_rys_single")
+        {
+            if(floattype == "interval")
+            {
+                nfailed = integral_single_verify_test<4>(file, working_prec, mirp_gtoeri_rys_single_str, nthreads);
+            }
+            else if(floattype == "exact")
+            {
+                nfailed = integral_single_verify_test_exact<4>(file, mirp_gtoeri_rys_single_exact, mirp_gtoeri_rys_single, nthreads);
+            }
+            else
+            {
+                std::cout << "Float type \"" << floattype << " not valid for integral \"" << integral << "\"\n";
+                return 1;
+            }
+        }
+        else if(integral == "gtoeri_rys")
+        {
+            if(floattype == "interval")
+            {
+                nfailed = integral_verify_test<4>(file, working_prec, mirp_gtoeri_rys_str, nthreads);
+            }
+            else if(floattype == "exact")
+            {
+                nfailed = integral_verify_test_exact<4>(file, mirp_gtoeri_rys_exact, mirp_gtoeri_rys, nthreads);
+            }
+            else
+            {
+                std::cout << "Float type \"" << floattype << " not valid for integral \"" << integral << "\"\n";
+                return 1;
+            }
+        }
+        else if(integral == "gtoeri_md_single")
+        {
+            if(floattype == "interval")
+            {
+                nfailed = integral_single_verify_test<4>(file, working_prec, mirp_gtoeri_md_single_str, nthreads);
+            }
+            else if(floattype == "exact")
+            {
+                nfailed = integral_single_verify_test_exact<4>(file, mirp_gtoeri_md_single_exact, mirp_gtoeri_md_single, nthreads);
+            }
+            else
+            {
+                std::cout << "Float type \"" << floattype << " not valid for integral \"" << integral << "\"\n";
+                return 1;
+            }
+        }
+        else if(integral == "gtoeri_md")
+        {
+            if(floattype == "interval")
+            {
+                nfailed = integral_verify_test<4>(file, working_prec, mirp_gtoeri_md_str, nthreads);
             }
             else if(floattype == "exact")
             {
-                nfailed = integral_verify_test_exact<4>(file, mirp_gtoeri_exact, mirp_gtoeri);
+                nfailed = integral_verify_test_exact<4>(file, mirp_gtoeri_md_exact, mirp_gtoeri_md, nthreads);
             }
             else
             {
@@ -138,6 +249,8 @@ int main(int argc, char ** argv)
             return 3;
         }
 
+        if(stats)
+            print_exact_stats();
 
         if(nfailed)
             return 1;
@@ -9,10 +9,12 @@
 #include "mirp_bin/callback_helper.hpp"
 
 #include <mirp/pragma.h>
+#include <mirp/math.h>
 #include <mirp/shell.h>
 
 #include <fstream>
 #include <algorithm>
+#include <cmath>
 
 namespace mirp {
 
@@ -66,12 +68,48 @@ long integral_test_reference(const std::string & ref_filepath,
         std::vector<double> integrals(nintegrals);
         std::vector<double> integrals_file(nintegrals);
 
-        for(size_t i = 0; i < nintegrals; i++)
-            integrals_file[i] = read_hexdouble(fs);
+        // Screened entries only store an upper bound on the
+        // magnitude of all the integrals
+        fs >> std::ws;
+        bool screened = (fs.peek() == 's');
+        double screen_bound = 0.0;
+
+        if(screened)
+        {
+            std::string tmp;
+            fs >> tmp;
+            if(tmp != "screened")
+                throw std::runtime_error("Unknown entry in reference file: " + tmp);
+            screen_bound = read_hexdouble(fs);
+        }
+        else
+        {
+            for(size_t i = 0; i < nintegrals; i++)
+                integrals_file[i] = read_hexdouble(fs);
+        }
 
         callback_helper<N>::call_exact(integrals.data(), am, xyz, nprim, ngeneral, alpha, coeff, cb);
 
-        for(size_t i = 0; i < nintegrals; i++)
+        for(size_t i = 0; i < nintegrals && screened; i++)
+        {
+            if(std::fabs(integrals[i]) > screen_bound)
+            {
+                printf("Failed screened entry: ");
+
+                for(int n = 0; n < N; n++)
+                    printf("%2d ", am[n]);
+
+                printf(") ");
+
+                for(int n = 0; n < N; n++)
+                    printf("%4lu ", idx[n]);
+
+                printf("%7lu  -> %26.18e > %26.18e\n", i, integrals[i], screen_bound);
+                nfailed++;
+            }
+        }
+
+        for(size_t i = 0; i < nintegrals && !screened; i++)
         {
             PRAGMA_WARNING_PUSH
             PRAGMA_WARNING_IGNORE_FP_EQUALITY
@@ -107,7 +145,9 @@ void integral4_create_reference(const std::string & xyz_filepath,
                                 const std::string & output_filepath,
                                 const std::string & header,
                                 const std::vector<std::vector<int>> & amlist,
-                                cb_integral4_exact cb)
+                                double schwarz_threshold,
+                                cb_integral4_shellpair_exact cb,
+                                cb_integral4_shellpair cb_schwarz)
 {
     std::vector<gaussian_shell> shells = read_construct_basis(xyz_filepath, basis_filepath);
 
@@ -120,19 +160,74 @@ void integral4_create_reference(const std::string & xyz_filepath,
     fs << header << "\n";
     reffile_write_basis(shells, fs);
 
-    std::vector<double> integrals;
-
+    // Each pair of shells appears in many quartets, so build them
+    // all once. 128 bits is the first precision tried by the
+    // exact functions, so the pairs can usually be used directly
+    std::vector<mirp_shellpair> pairs(nshell*(nshell+1)/2);
     for(size_t p = 0; p < nshell; p++)
-    for(size_t r = 0; r < nshell; r++)
     for(size_t q = 0; q <= p; q++)
-    for(size_t s = 0; s <= r; s++)
     {
-        const size_t pq = (p*(p+1))/2 + q;
-        const size_t rs = (r*(r+1))/2 + r;
+        const auto & s1 = shells[p];
+        const auto & s2 = shells[q];
 
-        if(pq < rs)
-            continue;
+        mirp_shellpair_init_d(&pairs[p*(p+1)/2+q],
+                              s1.am, s1.xyz.data(), s1.nprim, s1.ngeneral, s1.alpha.data(), s1.coeff.data(),
+                              s2.am, s2.xyz.data(), s2.nprim, s2.ngeneral, s2.alpha.data(), s2.coeff.data(),
+                              128);
+    }
+
+    /*
+     * Schwarz screening
+     *
+     * For every component, |(ab|cd)| <= sqrt((ab|ab)) * sqrt((cd|cd)).
+     * schwarz[pq] is a rigorous upper bound on the largest diagonal
+     * integral of the pair, obtained with interval arithmetic.
+     */
+    const bool do_schwarz = (schwarz_threshold >= 0.0);
+    const slong schwarz_prec = 128;
+
+    arb_ptr schwarz = _arb_vec_init(pairs.size());
+    arb_t bound;
+    arf_t bound_ub, threshold;
+    arb_init(bound);
+    arf_init(bound_ub);
+    arf_init(threshold);
+    arf_set_d(threshold, schwarz_threshold);
+
+    if(do_schwarz)
+    {
+        for(size_t pq = 0; pq < pairs.size(); pq++)
+        {
+            const mirp_shellpair & sp = pairs[pq];
+            const size_t ndiag = MIRP_NCART4(sp.am1, sp.am2, sp.am1, sp.am2)
+                               * sp.ngen1 * sp.ngen2 * sp.ngen1 * sp.ngen2;
+
+            arb_ptr diag = _arb_vec_init(ndiag);
+            cb_schwarz(diag, &sp, &sp, schwarz_prec);
 
+            arf_zero(arb_midref(schwarz + pq));
+            for(size_t i = 0; i < ndiag; i++)
+            {
+                arb_get_abs_ubound_arf(bound_ub, diag + i, schwarz_prec);
+                if(arf_cmp(bound_ub, arb_midref(schwarz + pq)) > 0)
+                    arf_set(arb_midref(schwarz + pq), bound_ub);
+            }
+
+            _arb_vec_clear(diag, ndiag);
+        }
+    }
+
+    long nzero = 0;
+    long nscreened = 0;
+
+    std::vector<double> integrals;
+
+    // Loop over all unique quartets (p >= q, r >= s, pq >= rs)
+    for(size_t p = 0; p < nshell; p++)
+    for(size_t q = 0; q <= p; q++)
+    for(size_t r = 0; r <= p; r++)
+    for(size_t s = 0; s <= (r == p ? q : r); s++)
+    {
         const auto & s1 = shells[p];
         const auto & s2 = shells[q];
         const auto & s3 = shells[r];
@@ -150,13 +245,50 @@ void integral4_create_reference(const std::string & xyz_filepath,
 
         integrals.resize(nintegrals);
 
-        cb(integrals.data(),
-           s1.am, s1.xyz.data(), s1.nprim, s1.ngeneral, s1.alpha.data(), s1.coeff.data(),
-           s2.am, s2.xyz.data(), s2.nprim, s2.ngeneral, s2.alpha.data(), s2.coeff.data(),
-           s3.am, s3.xyz.data(), s3.nprim, s3.ngeneral, s3.alpha.data(), s3.coeff.data(),
-           s4.am, s4.xyz.data(), s4.nprim, s4.ngeneral, s4.alpha.data(), s4.coeff.data());
-
         fs << p << " " << q << " " << r << " " << s;
+
+        if(do_schwarz)
+        {
+            // Upper bound on all integrals of the quartet
+            arb_mul(bound, schwarz + (p*(p+1)/2+q), schwarz + (r*(r+1)/2+s), schwarz_prec);
+            arb_sqrt(bound, bound, schwarz_prec);
+            arb_get_abs_ubound_arf(bound_ub, bound, schwarz_prec);
+
+            // If all integrals are below half of the smallest subnormal,
+            // they are exactly zero when rounded to double precision.
+            // Doubling is exact, so compare against the smallest subnormal
+            arf_mul_2exp_si(bound_ub, bound_ub, 1);
+
+            PRAGMA_WARNING_PUSH
+            PRAGMA_WARNING_IGNORE_FP_UNDERFLOW
+
+            if(arf_cmpabs_d(bound_ub, MIRP_DBL_TRUE_MIN) < 0)
+            {
+                for(size_t i = 0; i < nintegrals; i++)
+                {
+                    fs << " ";
+                    write_hexdouble(0.0, fs);
+                }
+                fs << "\n";
+                nzero++;
+                continue;
+            }
+
+            PRAGMA_WARNING_POP
+
+            arf_mul_2exp_si(bound_ub, bound_ub, -1);
+            if(arf_cmp(bound_ub, threshold) < 0)
+            {
+                fs << " screened ";
+                write_hexdouble(arf_get_d(bound_ub, ARF_RND_UP), fs);
+                fs << "\n";
+                nscreened++;
+                continue;
+            }
+        }
+
+        cb(integrals.data(), &pairs[p*(p+1)/2+q], &pairs[r*(r+1)/2+s]);
+
         for(size_t i = 0; i < nintegrals; i++)
         {
             fs << " ";
@@ -165,6 +297,17 @@ void integral4_create_reference(const std::string & xyz_filepath,
 
         fs << "\n";
     }
+
+    if(do_schwarz)
+        printf("Schwarz screening: %ld quartets are zero, %ld quartets screened\n", nzero, nscreened);
+
+    for(auto & it : pairs)
+        mirp_shellpair_clear(&it);
+
+    _arb_vec_clear(schwarz, pairs.size());
+    arb_clear(bound);
+    arf_clear(bound_ub);
+    arf_clear(threshold);
 }
 
 
@@ -27,16 +27,28 @@ namespace mirp {
  * \param [in] output_filepath The output file to write the computed integrals to
  * \param [in] header          Header information to add to the file
  *                             (appended to the input file header)
+ * If \p schwarz_threshold is not negative, rigorous Cauchy-Schwarz bounds are computed
+ * for all quartets from the diagonal integrals (computed with \p cb_schwarz).
+ * Quartets whose integrals are all guaranteed to round to zero are written as zero
+ * without computing them. Quartets whose bound is below \p schwarz_threshold
+ * are written as "screened" along with the bound.
+ *
  * \param [in] amlist          Vector of AM classes to compute. If empty, all will be computed
+ * \param [in] schwarz_threshold Threshold for Schwarz screening. If negative, no screening is done
  * \param [in] cb              Function that computes contracted integrals
- *                             to exact double precision
+ *                             from shell pairs to exact double precision
+ * \param [in] cb_schwarz      Function that computes contracted integrals
+ *                             from shell pairs with interval arithmetic
+ *                             (used for the Schwarz bounds)
  */
 void integral4_create_reference(const std::string & xyz_filepath,
                                 const std::string & basis_filepath,
                                 const std::string & output_filepath,
                                 const std::string & header,
                                 const std::vector<std::vector<int>> & amlist,
-                                cb_integral4_exact cb);
+                                double schwarz_threshold,
+                                cb_integral4_shellpair_exact cb,
+                                cb_integral4_shellpair cb_schwarz);
 
 
 /*! \brief Tests a reference file for consistency
@@ -7,11 +7,15 @@
 #include "mirp_bin/test_common.hpp"
 
 #include <mirp/kernels/boys.h>
+#include <mirp/kernels/boys_grid.h>
+#include <mirp/kernels/boys_double_vec.h>
 #include <mirp/math.h>
 #include <mirp/pragma.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <fstream>
 #include <stdexcept>
@@ -24,47 +28,79 @@ namespace {
 
 /* Runs a Boys function test using interval arithmetic
  *
- * This just wraps the calculation of Boys function
+ * Entries with the same order are computed together
+ * (see mirp_boys_batch). The results are computed and checked with
+ * nthreads threads (if OpenMP is enabled), and failures are printed in the order
+ * of the file.
  *
  * The number of failing tests is returned
  *
  * \todo This function is not exception safe
  */
-long boys_verify_test(const mirp::boys_data & data, int extra_m, slong working_prec)
+long boys_verify_test(const mirp::boys_data & data, int extra_m, slong working_prec, int nthreads)
 {
-    long nfailed = 0;
+    std::vector<test_entry_result> results(data.entries.size());
 
-    const int max_m = boys_max_m(data) + extra_m;
+    /* Indices of the entries, grouped by order */
+    std::map<int, std::vector<size_t>> by_m;
+    for(size_t i = 0; i < data.entries.size(); i++)
+        by_m[data.entries[i].m].push_back(i);
 
-    arb_t vref_arb;
-    arb_init(vref_arb);
+    for(const auto & group : by_m)
+    {
+        const int m = group.first + extra_m;
+        const long n = static_cast<long>(group.second.size());
 
-    arb_ptr F_arb = _arb_vec_init(max_m+1);
+        arb_ptr t_arb = _arb_vec_init(n);
+        arb_ptr F_arb = _arb_vec_init(n*(m+1));
 
-    for(const auto & ent : data.entries)
-    {
-        mirp_boys_str(F_arb, ent.m + extra_m, ent.t.c_str(), working_prec);
+        for(long i = 0; i < n; i++)
+            arb_set_str(t_arb + i, data.entries[group.second[i]].t.c_str(), working_prec);
 
-        arb_set_str(vref_arb, ent.value.c_str(), working_prec);
+        mirp_boys_batch(F_arb, m, t_arb, n, nthreads, working_prec);
 
-        /* Do the intervals overlap? */
-        if(!arb_overlaps(F_arb + ent.m, vref_arb))
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads)
+        #endif
         {
-            std::cout << "Entry failed test: m = " << ent.m << " t = " << ent.t << "\n";
-            char * s1 = arb_get_str(F_arb + ent.m, data.ndigits+5, ARB_STR_MORE);
-            char * s2 = arb_get_str(vref_arb, data.ndigits+5, ARB_STR_MORE);
-            std::cout << "   Calculated: " << s1 << "\n";
-            std::cout << "    Reference: " << s2 << "\n";
-            free(s1);
-            free(s2);
-            nfailed++;
+            arb_t vref_arb;
+            arb_init(vref_arb);
+
+            #ifdef _OPENMP
+            #pragma omp for
+            #endif
+            for(long i = 0; i < n; i++)
+            {
+                const auto & ent = data.entries[group.second[i]];
+                auto & res = results[group.second[i]];
+                arb_srcptr F = F_arb + i*(m+1) + ent.m;
+
+                arb_set_str(vref_arb, ent.value.c_str(), working_prec);
+
+                /* Do the intervals overlap? */
+                if(!arb_overlaps(F, vref_arb))
+                {
+                    std::ostringstream out;
+                    out << "Entry failed test: m = " << ent.m << " t = " << ent.t << "\n";
+                    char * s1 = arb_get_str(F, data.ndigits+5, ARB_STR_MORE);
+                    char * s2 = arb_get_str(vref_arb, data.ndigits+5, ARB_STR_MORE);
+                    out << "   Calculated: " << s1 << "\n";
+                    out << "    Reference: " << s2 << "\n";
+                    free(s1);
+                    free(s2);
+                    res.output = out.str();
+                    res.nfailed = 1;
+                }
+            }
+
+            arb_clear(vref_arb);
         }
-    }
 
-    arb_clear(vref_arb);
-    _arb_vec_clear(F_arb, max_m+1);
+        _arb_vec_clear(F_arb, n*(m+1));
+        _arb_vec_clear(t_arb, n);
+    }
 
-    return nfailed;
+    return print_entry_results(results);
 }
 
 
@@ -75,17 +111,114 @@ long boys_verify_test(const mirp::boys_data & data, int extra_m, slong working_p
  * with a high working precision.
  *
  * This, therefore, just ensures that the wrappers are written correctly.
+ *
+ * The 'exact' and reference values are computed with nthreads threads (if
+ * OpenMP is enabled), and failures are printed in the order of the file.
  */
-long boys_verify_test_exact(const mirp::boys_data & data, int extra_m)
+long boys_verify_test_exact(const mirp::boys_data & data, int extra_m, int nthreads)
+{
+    std::vector<test_entry_result> results(data.entries.size());
+
+    /* Indices of the entries, grouped by order. The "exact" values
+     * of each group are computed together (see mirp_boys_exact_batch) */
+    std::map<int, std::vector<size_t>> by_m;
+    for(size_t i = 0; i < data.entries.size(); i++)
+        by_m[data.entries[i].m].push_back(i);
+
+    for(const auto & group : by_m)
+    {
+        const int m = group.first + extra_m;
+        const long n = static_cast<long>(group.second.size());
+
+        std::vector<double> t_dbl(n);
+        std::vector<double> F_dbl(n*(m+1));
+
+        for(long i = 0; i < n; i++)
+            t_dbl[i] = std::strtod(data.entries[group.second[i]].t.c_str(), nullptr);
+
+        /* Compute using the "exact" code */
+        mirp_boys_exact_batch(F_dbl.data(), m, t_dbl.data(), n, nthreads);
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads)
+        #endif
+        {
+            /* For comparison */
+            arb_t t_arb;
+            arb_init(t_arb);
+            arb_ptr F_arb = _arb_vec_init(m+1);
+
+            #ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+            #endif
+            for(long i = 0; i < n; i++)
+            {
+                const auto & ent = data.entries[group.second[i]];
+                auto & res = results[group.second[i]];
+                const double F_ent = F_dbl[i*(m+1) + ent.m];
+
+                /* Compute using the interval arithmetic code */
+                /* 256 bits should be enough for testing... */
+                arb_set_d(t_arb, t_dbl[i]);
+                mirp_boys(F_arb, m, t_arb, 256);
+
+                /* Make sure we really didn't lose a whole bunch of precision */
+                if(arb_rel_accuracy_bits(F_arb + ent.m) < 64)
+                {
+                    res.error = "Not enough bits in testing boys exact function. Contact the developer";
+                    continue;
+                }
+
+                double vref_dbl = std::strtod(ent.value.c_str(), nullptr);
+                double vref2_dbl = arf_get_d(arb_midref(F_arb + ent.m), ARF_RND_NEAR);
+
+                PRAGMA_WARNING_PUSH
+                PRAGMA_WARNING_IGNORE_FP_EQUALITY
+
+                if(F_ent != vref_dbl && F_ent != vref2_dbl)
+                {
+                    std::ostringstream out;
+                    out.precision(17);
+                    out << "Entry failed test: m = " << ent.m << " t = " << ent.t << "\n";
+                    out << "     Calculated: " << F_ent << "\n";
+                    out << "      Reference: " << vref2_dbl << "\n";
+                    out << " File Reference: " << vref_dbl << "\n\n";
+                    res.output = out.str();
+                    res.nfailed = 1;
+                }
+
+                PRAGMA_WARNING_POP
+            }
+
+            arb_clear(t_arb);
+            _arb_vec_clear(F_arb, m+1);
+        }
+    }
+
+    return print_entry_results(results);
+}
+
+
+/* Runs a Boys function test using the precomputed table
+ *
+ * Values that can be evaluated from the table are guaranteed to be correctly
+ * rounded. Like for the 'exact' test, they are compared with the reference
+ * value in the file and with the result of the interval version at the
+ * (rounded) value of t, since t in the file may not be exactly representable.
+ * Anything else goes through the 'exact' double precision fallback.
+ */
+long boys_verify_test_grid(const mirp::boys_data & data, int extra_m)
 {
     long nfailed = 0;
+    long ngrid = 0;
 
     const int max_m = boys_max_m(data) + extra_m;
     std::vector<double> F_dbl(max_m+1);
 
     /* For comparison */
-    arb_t t_arb;
+    arb_t t_arb, vref_arb;
     arb_init(t_arb);
+    arb_init(vref_arb);
 
     arb_ptr F_arb = _arb_vec_init(max_m+1);
 
@@ -93,25 +226,32 @@ long boys_verify_test_exact(const mirp::boys_data & data, int extra_m)
     {
         double t_dbl = std::strtod(ent.t.c_str(), nullptr);
 
-        /* Compute using the "exact" code */
-        mirp_boys_exact(F_dbl.data(), ent.m+extra_m, t_dbl);
+        if(mirp_boys_grid(F_dbl.data(), ent.m+extra_m, t_dbl))
+            ngrid++;
+        else
+            mirp_boys_exact(F_dbl.data(), ent.m+extra_m, t_dbl);
+
+        /* The reference values in the file are intervals */
+        arb_set_str(vref_arb, ent.value.c_str(), 256);
+        double vref_dbl = arf_get_d(arb_midref(vref_arb), ARF_RND_NEAR);
+
+        PRAGMA_WARNING_PUSH
+        PRAGMA_WARNING_IGNORE_FP_EQUALITY
+
+        if(F_dbl[ent.m] == vref_dbl)
+            continue;
 
-        /* Compute using the interval arithmetic code */
         /* 256 bits should be enough for testing... */
         arb_set_d(t_arb, t_dbl);
-        mirp_boys(F_arb, ent.m+extra_m, t_arb, 256);
+        mirp_boys(F_arb, ent.m, t_arb, 256);
 
         /* Make sure we really didn't lose a whole bunch of precision */
         if(arb_rel_accuracy_bits(F_arb + ent.m) < 64)
-            throw std::logic_error("Not enough bits in testing boys exact function. Contact the developer");
+            throw std::logic_error("Not enough bits in testing boys grid function. Contact the developer");
 
-        double vref_dbl = std::strtod(ent.value.c_str(), nullptr);
         double vref2_dbl = arf_get_d(arb_midref(F_arb + ent.m), ARF_RND_NEAR);
 
-        PRAGMA_WARNING_PUSH
-        PRAGMA_WARNING_IGNORE_FP_EQUALITY
-
-        if(F_dbl[ent.m] != vref_dbl && F_dbl[ent.m] != vref2_dbl)
+        if(F_dbl[ent.m] != vref2_dbl)
         {
             std::cout << "Entry failed test: m = " << ent.m << " t = " << ent.t << "\n";
             auto old_cout_prec = std::cout.precision(17);
@@ -125,12 +265,151 @@ long boys_verify_test_exact(const mirp::boys_data & data, int extra_m)
         PRAGMA_WARNING_POP
     }
 
+    std::cout << ngrid << " / " << data.entries.size() << " entries evaluated from the table\n";
+
     arb_clear(t_arb);
+    arb_clear(vref_arb);
     _arb_vec_clear(F_arb, max_m+1);
 
     return nfailed;
 }
 
+
+/* Largest error (in units in the last place) accepted from the
+ * vectorized double precision kernel */
+const double boys_simd_max_ulp = 4.0;
+
+
+/* Runs a Boys function test of the vectorized double precision kernel
+ *
+ * Entries with the same order are computed together (see mirp_boys_double_vec).
+ * The results are compared with the correctly-rounded value at the (rounded)
+ * value of t, obtained from the interval version. The largest error in units
+ * in the last place is printed, and entries with errors larger than
+ * boys_simd_max_ulp are counted as failed.
+ *
+ * Orders beyond MIRP_BOYS_DOUBLE_VEC_MAX_M are computed with mirp_boys_double.
+ * Their largest error is printed separately, but they are not checked.
+ *
+ * The reference values are computed with nthreads threads (if OpenMP
+ * is enabled), and failures are printed in the order of the file.
+ */
+long boys_verify_test_simd(const mirp::boys_data & data, int extra_m, int nthreads)
+{
+    std::vector<test_entry_result> results(data.entries.size());
+
+    /* Error of each entry (in units in the last place), and
+     * whether it was computed with the fallback */
+    std::vector<double> errors(data.entries.size());
+    std::vector<int> fallback(data.entries.size());
+
+    /* Indices of the entries, grouped by order */
+    std::map<int, std::vector<size_t>> by_m;
+    for(size_t i = 0; i < data.entries.size(); i++)
+        by_m[data.entries[i].m].push_back(i);
+
+    for(const auto & group : by_m)
+    {
+        const int m = group.first + extra_m;
+        const long n = static_cast<long>(group.second.size());
+
+        std::vector<double> t_dbl(n);
+        std::vector<double> F_dbl(n*(m+1));
+
+        for(long i = 0; i < n; i++)
+            t_dbl[i] = std::strtod(data.entries[group.second[i]].t.c_str(), nullptr);
+
+        mirp_boys_double_vec(F_dbl.data(), m, t_dbl.data(), n);
+
+        #ifdef _OPENMP
+        #pragma omp parallel num_threads(nthreads)
+        #endif
+        {
+            /* For comparison */
+            arb_t t_arb;
+            arb_init(t_arb);
+            arb_ptr F_arb = _arb_vec_init(m+1);
+
+            #ifdef _OPENMP
+            #pragma omp for schedule(dynamic)
+            #endif
+            for(long i = 0; i < n; i++)
+            {
+                const size_t idx = group.second[i];
+                const auto & ent = data.entries[idx];
+                auto & res = results[idx];
+
+                /* Structure of arrays */
+                const double F_ent = F_dbl[ent.m*n + i];
+
+                /* 256 bits should be enough for testing... */
+                arb_set_d(t_arb, t_dbl[i]);
+                mirp_boys(F_arb, m, t_arb, 256);
+
+                /* Make sure we really didn't lose a whole bunch of precision */
+                if(arb_rel_accuracy_bits(F_arb + ent.m) < 64)
+                {
+                    res.error = "Not enough bits in testing boys simd function. Contact the developer";
+                    continue;
+                }
+
+                const double vref_dbl = arf_get_d(arb_midref(F_arb + ent.m), ARF_RND_NEAR);
+
+                /* Distance to the next larger double (in magnitude). This
+                 * is the smallest subnormal for zero */
+                const double ulp = std::nextafter(std::fabs(vref_dbl), INFINITY) - std::fabs(vref_dbl);
+                double err = std::fabs(F_ent - vref_dbl) / ulp;
+                if(!std::isfinite(F_ent))
+                    err = INFINITY;
+
+                errors[idx] = err;
+                fallback[idx] = (m > MIRP_BOYS_DOUBLE_VEC_MAX_M) ? 1 : 0;
+
+                if(!fallback[idx] && err > boys_simd_max_ulp)
+                {
+                    std::ostringstream out;
+                    out.precision(17);
+                    out << "Entry failed test: m = " << ent.m << " t = " << ent.t << "\n";
+                    out << "     Calculated: " << F_ent << "\n";
+                    out << "      Reference: " << vref_dbl << "\n";
+                    out << "      ULP error: " << err << "\n\n";
+                    res.output = out.str();
+                    res.nfailed = 1;
+                }
+            }
+
+            arb_clear(t_arb);
+            _arb_vec_clear(F_arb, m+1);
+        }
+    }
+
+    const long nfailed = print_entry_results(results);
+
+    /* Largest errors of the vectorized kernel [0] and of the fallback [1]
+     * (the first entry in the file, if there are several) */
+    double max_ulp[2] = { 0.0, 0.0 };
+    const mirp::boys_data_entry * max_ent[2] = { nullptr, nullptr };
+
+    for(size_t i = 0; i < data.entries.size(); i++)
+    {
+        const int f = fallback[i];
+        if(max_ent[f] == nullptr || errors[i] > max_ulp[f])
+        {
+            max_ulp[f] = errors[i];
+            max_ent[f] = &data.entries[i];
+        }
+    }
+
+    if(max_ent[0] != nullptr)
+        std::cout << "Max ULP error: " << max_ulp[0] << " (m = " << max_ent[0]->m
+                  << " t = " << max_ent[0]->t << ")\n";
+    if(max_ent[1] != nullptr)
+        std::cout << "Max ULP error of mirp_boys_double (m > " << MIRP_BOYS_DOUBLE_VEC_MAX_M << ", not checked): "
+                  << max_ulp[1] << " (m = " << max_ent[1]->m << " t = " << max_ent[1]->t << ")\n";
+
+    return nfailed;
+}
+
 } // close anonymous namespace
 
 
@@ -249,16 +528,21 @@ void boys_write_file(const std::string & filepath, const boys_data & data)
 long boys_verify_test_main(const std::string & filepath,
                            const std::string & floattype,
                            int extra_m,
-                           slong working_prec)
+                           slong working_prec,
+                           int nthreads)
 {
     boys_data data = boys_read_file(filepath, false);
 
     long nfailed = 0;
 
     if(floattype == "interval")
-        nfailed = boys_verify_test(data, extra_m, working_prec);
+        nfailed = boys_verify_test(data, extra_m, working_prec, nthreads);
     else if(floattype == "exact")
-        nfailed = boys_verify_test_exact(data, extra_m);
+        nfailed = boys_verify_test_exact(data, extra_m, nthreads);
+    else if(floattype == "grid")
+        nfailed = boys_verify_test_grid(data, extra_m);
+    else if(floattype == "simd")
+        nfailed = boys_verify_test_simd(data, extra_m, nthreads);
     else
     {
         std::string err;
@@ -276,7 +560,8 @@ long boys_verify_test_main(const std::string & filepath,
 void boys_create_test(const std::string & input_filepath,
                       const std::string & output_filepath,
                       slong working_prec, long ndigits,
-                      const std::string & header)
+                      const std::string & header,
+                      int nthreads)
 {
     boys_data data = boys_read_file(input_filepath, true);
     data.ndigits = ndigits;
@@ -288,28 +573,66 @@ void boys_create_test(const std::string & input_filepath,
 
     const int max_m = boys_max_m(data);
 
-    arb_t t_arb;
-    arb_init(t_arb);
-
-    arb_ptr F_arb = _arb_vec_init(max_m+1);
+    const long nentries = static_cast<long>(data.entries.size());
+    std::vector<std::string> errors(data.entries.size());
+    std::vector<slong> precs(data.entries.size(), 0);
 
-    for(auto & ent : data.entries)
+    /* The entries are split among nthreads threads (if OpenMP is enabled),
+     * each with its own buffers. The results are stored with their entry,
+     * so the file is the same as when computed serially */
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads)
+    #endif
     {
-        arb_set_str(t_arb, ent.t.c_str(), working_prec);
-        mirp_boys(F_arb, ent.m, t_arb, working_prec);
+        arb_t t_arb;
+        arb_init(t_arb);
+
+        arb_ptr F_arb = _arb_vec_init(max_m+1);
 
-        slong bits = arb_rel_accuracy_bits(F_arb + ent.m);
-        if(bits > 0 && bits < min_prec)
-            throw std::runtime_error("Working precision not large enough for the number of digits");
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for(long e = 0; e < nentries; e++)
+        {
+            auto & ent = data.entries[e];
+
+            try {
+                if(working_prec > 0)
+                {
+                    arb_set_str(t_arb, ent.t.c_str(), working_prec);
+                    mirp_boys(F_arb, ent.m, t_arb, working_prec);
+                }
+                else
+                    precs[e] = mirp_boys_target(F_arb, ent.m, ent.t.c_str(), ndigits);
+
+                slong bits = arb_rel_accuracy_bits(F_arb + ent.m);
+                if(bits > 0 && bits < min_prec)
+                    throw std::runtime_error("Working precision not large enough for the number of digits");
+
+                char * s = arb_get_str(F_arb + ent.m, ndigits, 0);
+                ent.value = s;
+                free(s);
+            }
+            catch(std::exception & ex)
+            {
+                errors[e] = ex.what();
+            }
+        }
 
-        char * s = arb_get_str(F_arb + ent.m, ndigits, 0);
-        ent.value = s;
-        free(s);
+        arb_clear(t_arb);
+        _arb_vec_clear(F_arb, max_m+1);
+    }
+
+    for(long e = 0; e < nentries; e++)
+    {
+        if(!errors[e].empty())
+            throw std::runtime_error(errors[e]);
+
+        /* Record the largest precision that was needed */
+        data.working_prec = std::max(data.working_prec, static_cast<long>(precs[e]));
     }
 
     boys_write_file(output_filepath, data);
-    arb_clear(t_arb);
-    _arb_vec_clear(F_arb, max_m+1);
 }
 
 
@@ -73,11 +73,13 @@ void boys_write_file(const std::string & filepath, const boys_data & data);
  * \param [in] floattype    Type of floating point to test ("double", for example)
  * \param [in] extra_m      Additional `m` entries (used to test recurrence relations)
  * \param [in] working_prec Internal working precision to use
+ * \param [in] nthreads     Number of threads to test entries with (if OpenMP is enabled)
  * \return The number of tests that have failed
  */
 long boys_verify_test_main(const std::string & filepath,
                            const std::string & floattype,
-                           int extra_m, slong working_prec);
+                           int extra_m, slong working_prec,
+                           int nthreads);
 
 
 /*! \brief Create a test file for the Boys function from a given input file
@@ -92,15 +94,20 @@ long boys_verify_test_main(const std::string & filepath,
  *
  * \param [in] input_filepath  Path to the input file
  * \param [in] output_filepath File to write the computed data to
- * \param [in] working_prec    Internal working precision to use
+ * \param [in] working_prec    Internal working precision to use. If zero,
+ *                             the working precision is chosen separately for
+ *                             each entry
  * \param [in] ndigits         Number of decimal digits to compute
  * \param [in] header          Any descriptive header data
  *                             (will be appended to the existing header in the input file)
+ * \param [in] nthreads        Number of threads to compute entries with
+ *                             (if OpenMP is enabled)
  */
 void boys_create_test(const std::string & input_filepath,
                       const std::string & output_filepath,
                       slong working_prec, long ndigits,
-                      const std::string & header);
+                      const std::string & header,
+                      int nthreads);
 
 } // close namespace mirp
 
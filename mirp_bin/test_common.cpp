@@ -6,12 +6,15 @@
 #include "test_common.hpp"
 
 #include <mirp/pragma.h>
+#include <mirp/precision.h>
 
 #include <cmath>
 #include <algorithm>
 #include <locale> // for std::tolower and std::isspace
 #include <map>
 #include <iostream>
+#include <iomanip>
+#include <stdexcept>
 
 
 namespace {
@@ -71,6 +74,98 @@ void print_results(unsigned long nfailed, unsigned long ntests)
 }
 
 
+long print_entry_results(const std::vector<test_entry_result> & results)
+{
+    long nfailed = 0;
+
+    for(const auto & res : results)
+    {
+        std::cout << res.output;
+
+        if(!res.error.empty())
+            throw std::runtime_error(res.error);
+
+        nfailed += res.nfailed;
+    }
+
+    return nfailed;
+}
+
+
+void print_exact_stats(void)
+{
+    const char * kind_names[MIRP_EXACT_NKINDS] = { "Boys function (m)",
+                                                   "Single four-center integrals",
+                                                   "Four-center shell quartets" };
+    const int nam = MIRP_EXACT_STATS_MAX_AM+1;
+
+    std::cout << "\nEscalation statistics of the exact functions\n"
+              << "(AM is capped at " << MIRP_EXACT_STATS_MAX_AM << ", precision bins are "
+              << "upper bounds in bits, the last bin of each histogram also holds all larger values)\n";
+
+    for(int kind = 0; kind < MIRP_EXACT_NKINDS; kind++)
+    {
+        bool header = false;
+
+        for(int i = 0; i < nam*nam*nam*nam; i++)
+        {
+            const int am[4] = { i/(nam*nam*nam), (i/(nam*nam))%nam, (i/nam)%nam, i%nam };
+
+            mirp_exact_stats stats;
+            mirp_exact_stats_get(&stats, static_cast<mirp_exact_kind>(kind), am);
+            if(stats.ncalls == 0)
+                continue;
+
+            if(!header)
+            {
+                std::cout << "\n  " << kind_names[kind] << "\n";
+                std::cout << "    " << std::left << std::setw(8) << "AM" << std::right
+                          << std::setw(12) << "calls" << std::setw(14) << "evaluations"
+                          << std::setw(12) << "wasted" << std::setw(14) << "time (s)" << "\n";
+                header = true;
+            }
+
+            // Boys function: only the first entry is used (m)
+            std::string amstr;
+            if(kind == MIRP_EXACT_BOYS)
+                amstr = std::to_string(am[0]);
+            else
+            {
+                for(int n = 0; n < 4; n++)
+                    for(const auto & it : amchar_map)
+                        if(it.second == am[n])
+                            amstr += it.first;
+            }
+
+            std::cout << "    " << std::left << std::setw(8) << amstr << std::right
+                      << std::setw(12) << stats.ncalls << std::setw(14) << stats.nevals
+                      << std::setw(12) << (stats.nevals - stats.nresults)
+                      << std::setw(14) << std::setprecision(4) << stats.time << "\n";
+
+            std::cout << "        attempts:";
+            for(int n = 0; n < MIRP_EXACT_STATS_NROUNDS; n++)
+                if(stats.rounds_hist[n])
+                    std::cout << "  " << n << ":" << stats.rounds_hist[n];
+            std::cout << "\n";
+
+            std::cout << "        precision:";
+            for(int n = 0; n < MIRP_EXACT_STATS_NPREC; n++)
+                if(stats.prec_hist[n])
+                    std::cout << "  " << 64*(n+1) << ":" << stats.prec_hist[n];
+            std::cout << "\n";
+        }
+    }
+
+    mirp_prec_stats prec_stats;
+    mirp_prec_stats_get(&prec_stats);
+    std::cout << "\n  Precision predictions: "
+              << prec_stats.ninitial_hit << " / " << prec_stats.ninitial << " first attempts, "
+              << prec_stats.npredicted_hit << " / " << prec_stats.npredicted << " further attempts sufficient\n"
+              << "  Fixed low-precision attempts: "
+              << prec_stats.nfixed_hit << " / " << prec_stats.nfixed << " sufficient\n";
+}
+
+
 int amchar_to_int(char am)
 {
     am = static_cast<char>(std::tolower(am));
@@ -24,6 +24,39 @@ static const std::streamsize max_length = std::numeric_limits<std::streamsize>::
 void print_results(unsigned long nfailed, unsigned long ntests);
 
 
+/*! \brief Output and outcome of testing a single entry
+ *
+ * Entries may be tested in parallel. Their output is collected here
+ * and printed in order afterwards (see \ref print_entry_results), so
+ * that it is the same as when testing serially.
+ */
+struct test_entry_result
+{
+    std::string output;   //!< Everything printed while testing the entry
+    std::string error;    //!< Message of an exception thrown while testing the entry (empty if none)
+    long nfailed = 0;     //!< Number of failed tests in the entry
+};
+
+
+/*! \brief Print the output of tested entries in order
+ *
+ * \throw std::runtime_error with the message of the first entry that threw
+ *        an exception (after printing the output of all entries before it)
+ *
+ * \param [in] results The results of all entries, in the order of the file
+ * \return The total number of failed tests
+ */
+long print_entry_results(const std::vector<test_entry_result> & results);
+
+
+/*! \brief Print the escalation statistics of the exact functions
+ *
+ * Only AM tuples that were used are printed. Statistics must have been
+ * enabled with mirp_exact_stats_enable before running the tests.
+ */
+void print_exact_stats(void);
+
+
 /*! \brief Convert a character representing an angular momentum to an integer
  *
  * Converts s,p,d,f,... to 0,1,2,3,...
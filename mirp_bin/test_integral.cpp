@@ -12,9 +12,11 @@
 #include <mirp/math.h>
 #include <mirp/shell.h>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 namespace mirp {
 
@@ -33,7 +35,9 @@ void integral_create_test(const std::string & input_filepath,
                           const std::string & output_filepath,
                           slong working_prec, long ndigits,
                           const std::string & header,
-                          typename callback_helper<N>::cb_str_type cb)
+                          typename callback_helper<N>::cb_str_type cb,
+                          typename callback_helper<N>::cb_target_type cb_target,
+                          int nthreads)
 {
     integral_data data = testfile_read_integral(input_filepath, N, true);
 
@@ -44,49 +48,84 @@ void integral_create_test(const std::string & input_filepath,
     /* What we need for the number of digits (plus some safety) */
     const slong min_prec = static_cast<slong>( static_cast<double>(ndigits+5) / MIRP_LOG_10_2 );
 
-    std::array<std::array<const char *, 3>, N> xyz;
-    std::array<std::vector<const char *>, N> alpha, coeff;
-    std::array<int, N> am, nprim, ngeneral;
+    const long nentries = static_cast<long>(data.entries.size());
+    std::vector<std::string> errors(data.entries.size());
+    std::vector<slong> precs(data.entries.size(), 0);
 
-    for(auto & ent : data.entries)
+    /* The entries are split among nthreads threads (if OpenMP is enabled),
+     * each with its own buffers. The results are stored with their entry,
+     * so the file is the same as when computed serially */
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads)
+    #endif
     {
-        const size_t nint = nintegrals(ent);
-        arb_ptr integrals = _arb_vec_init(nint);
-
-        for(int n = 0; n < N; n++)
+        std::array<std::array<const char *, 3>, N> xyz;
+        std::array<std::vector<const char *>, N> alpha, coeff;
+        std::array<int, N> am, nprim, ngeneral;
+
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for(long e = 0; e < nentries; e++)
         {
-            const auto & g = ent.g[n];
-
-            alpha[n].clear();
-            coeff[n].clear();
-
-            am[n] = g.am;
-            nprim[n] = g.nprim;
-            ngeneral[n] = g.ngeneral;
-
-            /* Unpack xyz, exponents, and coefficients */
-            for(int i = 0; i < 3; i++)
-                xyz[n][i] = g.xyz[i].c_str();
-            for(int i = 0; i < g.nprim; i++)
-                alpha[n].push_back(g.alpha[i].c_str());
-            for(int i = 0; i < g.nprim*g.ngeneral; i++)
-                coeff[n].push_back(g.coeff[i].c_str());
-        }
+            auto & ent = data.entries[e];
 
-        callback_helper<N>::call_str(integrals, am, xyz, nprim, ngeneral, alpha, coeff, working_prec, cb);
+            const size_t nint = nintegrals(ent);
+            arb_ptr integrals = _arb_vec_init(nint);
 
-        for(size_t i = 0; i < nint; i++)
-        {
-            slong bits = arb_rel_accuracy_bits(integrals+i);
-            if(bits > 0 && bits < min_prec)
-                throw std::runtime_error("Working precision not large enough for the number of digits");
+            try {
+                for(int n = 0; n < N; n++)
+                {
+                    const auto & g = ent.g[n];
+
+                    alpha[n].clear();
+                    coeff[n].clear();
+
+                    am[n] = g.am;
+                    nprim[n] = g.nprim;
+                    ngeneral[n] = g.ngeneral;
+
+                    /* Unpack xyz, exponents, and coefficients */
+                    for(int i = 0; i < 3; i++)
+                        xyz[n][i] = g.xyz[i].c_str();
+                    for(int i = 0; i < g.nprim; i++)
+                        alpha[n].push_back(g.alpha[i].c_str());
+                    for(int i = 0; i < g.nprim*g.ngeneral; i++)
+                        coeff[n].push_back(g.coeff[i].c_str());
+                }
+
+                if(working_prec > 0)
+                    callback_helper<N>::call_str(integrals, am, xyz, nprim, ngeneral, alpha, coeff, working_prec, cb);
+                else
+                    precs[e] = callback_helper<N>::call_target(integrals, am, xyz, nprim, ngeneral, alpha, coeff, ndigits, cb_target);
+
+                for(size_t i = 0; i < nint; i++)
+                {
+                    slong bits = arb_rel_accuracy_bits(integrals+i);
+                    if(bits > 0 && bits < min_prec)
+                        throw std::runtime_error("Working precision not large enough for the number of digits");
 
-            char * s = arb_get_str(integrals+i, ndigits, 0);
-            ent.integrals.push_back(s);
-            free(s);
+                    char * s = arb_get_str(integrals+i, ndigits, 0);
+                    ent.integrals.push_back(s);
+                    free(s);
+                }
+            }
+            catch(std::exception & ex)
+            {
+                errors[e] = ex.what();
+            }
+
+            _arb_vec_clear(integrals, nint);
         }
+    }
+
+    for(long e = 0; e < nentries; e++)
+    {
+        if(!errors[e].empty())
+            throw std::runtime_error(errors[e]);
 
-        _arb_vec_clear(integrals, nint);
+        /* Record the largest precision that was needed */
+        data.working_prec = std::max(data.working_prec, static_cast<long>(precs[e]));
     }
 
     testfile_write_integral(output_filepath, data);
@@ -96,69 +135,95 @@ void integral_create_test(const std::string & input_filepath,
 template<int N>
 long integral_verify_test(const std::string & filepath,
                           slong working_prec,
-                          typename callback_helper<N>::cb_str_type cb)
+                          typename callback_helper<N>::cb_str_type cb,
+                          int nthreads)
 {
-    long nfailed = 0;
-
     integral_data data = testfile_read_integral(filepath, N, false);
 
-    arb_t integral_ref;
-    arb_init(integral_ref);
+    const long nentries = static_cast<long>(data.entries.size());
+    std::vector<test_entry_result> results(data.entries.size());
 
-    std::array<std::array<const char *, 3>, N> xyz;
-    std::array<std::vector<const char *>, N> alpha, coeff;
-    std::array<int, N> am, nprim, ngeneral;
-
-    for(auto & ent : data.entries)
+    /* The entries are split among nthreads threads (if OpenMP is enabled),
+     * each with its own buffers. The output is printed in order afterwards */
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads)
+    #endif
     {
-        const size_t nint = nintegrals(ent);
-        arb_ptr integrals = _arb_vec_init(nint);
+        arb_t integral_ref;
+        arb_init(integral_ref);
+
+        std::array<std::array<const char *, 3>, N> xyz;
+        std::array<std::vector<const char *>, N> alpha, coeff;
+        std::array<int, N> am, nprim, ngeneral;
 
-        for(int n = 0; n < N; n++)
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for(long e = 0; e < nentries; e++)
         {
-            const auto & g = ent.g[n];
-
-            alpha[n].clear();
-            coeff[n].clear();
-
-            am[n] = g.am;
-            nprim[n] = g.nprim;
-            ngeneral[n] = g.ngeneral;
-
-            /* Unpack xyz, exponents, and coefficients */
-            for(int i = 0; i < 3; i++)
-                xyz[n][i] = g.xyz[i].c_str();
-            for(int i = 0; i < g.nprim; i++)
-                alpha[n].push_back(g.alpha[i].c_str());
-            for(int i = 0; i < g.nprim*g.ngeneral; i++)
-                coeff[n].push_back(g.coeff[i].c_str());
-        }
+            const auto & ent = data.entries[e];
+            auto & res = results[e];
 
-        callback_helper<N>::call_str(integrals, am, xyz, nprim, ngeneral, alpha, coeff, working_prec, cb);
+            std::ostringstream out;
 
-        for(size_t i = 0; i < nint; i++)
-        {
-            arb_set_str(integral_ref, ent.integrals[i].c_str(), working_prec);
+            try {
+                const size_t nint = nintegrals(ent);
+                arb_ptr integrals = _arb_vec_init(nint);
 
-            /* Do the intervals overlap? */
-            if(!arb_overlaps(integral_ref, integrals+i))
+                for(int n = 0; n < N; n++)
+                {
+                    const auto & g = ent.g[n];
+
+                    alpha[n].clear();
+                    coeff[n].clear();
+
+                    am[n] = g.am;
+                    nprim[n] = g.nprim;
+                    ngeneral[n] = g.ngeneral;
+
+                    /* Unpack xyz, exponents, and coefficients */
+                    for(int i = 0; i < 3; i++)
+                        xyz[n][i] = g.xyz[i].c_str();
+                    for(int i = 0; i < g.nprim; i++)
+                        alpha[n].push_back(g.alpha[i].c_str());
+                    for(int i = 0; i < g.nprim*g.ngeneral; i++)
+                        coeff[n].push_back(g.coeff[i].c_str());
+                }
+
+                callback_helper<N>::call_str(integrals, am, xyz, nprim, ngeneral, alpha, coeff, working_prec, cb);
+
+                for(size_t i = 0; i < nint; i++)
+                {
+                    arb_set_str(integral_ref, ent.integrals[i].c_str(), working_prec);
+
+                    /* Do the intervals overlap? */
+                    if(!arb_overlaps(integral_ref, integrals+i))
+                    {
+                        out << "Entry failed test:\n";
+                        char * s1 = arb_get_str(integrals+i, 2*data.ndigits, 0);
+                        char * s2 = arb_get_str(integral_ref, 2*data.ndigits, 0);
+                        out << "   Calculated: " << s1 << "\n";
+                        out << "    Reference: " << s2 << "\n\n";
+                        free(s1);
+                        free(s2);
+                        res.nfailed++;
+                    }
+                }
+
+                _arb_vec_clear(integrals, nint);
+            }
+            catch(std::exception & ex)
             {
-                std::cout << "Entry failed test:\n";
-                char * s1 = arb_get_str(integrals+i, 2*data.ndigits, 0);
-                char * s2 = arb_get_str(integral_ref, 2*data.ndigits, 0);
-                std::cout << "   Calculated: " << s1 << "\n";
-                std::cout << "    Reference: " << s2 << "\n\n";
-                free(s1);
-                free(s2);
-                nfailed++;
+                res.error = ex.what();
             }
-        }
 
-        _arb_vec_clear(integrals, nint);
+            res.output = out.str();
+        }
 
+        arb_clear(integral_ref);
     }
 
-    arb_clear(integral_ref);
+    const long nfailed = print_entry_results(results);
 
     print_results(nfailed, data.entries.size());
 
@@ -169,123 +234,149 @@ long integral_verify_test(const std::string & filepath,
 template<int N>
 long integral_verify_test_exact(const std::string & filepath,
                                 typename callback_helper<N>::cb_exact_type cb,
-                                typename callback_helper<N>::cb_type cb_arb)
+                                typename callback_helper<N>::cb_type cb_arb,
+                                int nthreads)
 {
-    long nfailed = 0;
-
     integral_data data = testfile_read_integral(filepath, N, false);
 
-    std::array<std::array<double, 3>, N> xyz;
-    std::array<std::vector<double>, N> alpha, coeff;
-    std::vector<double> integrals;
-
-    std::array<arb_ptr, N> xyz_arb;
-    for(auto & it : xyz_arb)
-        it = _arb_vec_init(3);
-
-    std::array<int, N> am, nprim, ngeneral;
+    const long nentries = static_cast<long>(data.entries.size());
+    std::vector<test_entry_result> results(data.entries.size());
 
-    for(const auto & ent : data.entries)
+    /* The entries are split among nthreads threads (if OpenMP is enabled),
+     * each with its own buffers. The output is printed in order afterwards */
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(nthreads)
+    #endif
     {
-        const size_t nint = nintegrals(ent);
-        integrals.resize(nint);
+        std::array<std::array<double, 3>, N> xyz;
+        std::array<std::vector<double>, N> alpha, coeff;
+        std::vector<double> integrals;
 
-        arb_ptr integrals_arb = _arb_vec_init(nint);
+        std::array<arb_ptr, N> xyz_arb;
+        for(auto & it : xyz_arb)
+            it = _arb_vec_init(3);
 
-        std::array<arb_ptr, N> alpha_arb, coeff_arb;
+        std::array<int, N> am, nprim, ngeneral;
 
-        for(int n = 0; n < N; n++)
+        #ifdef _OPENMP
+        #pragma omp for schedule(dynamic)
+        #endif
+        for(long e = 0; e < nentries; e++)
         {
-            const auto & g = ent.g[n];
+            const auto & ent = data.entries[e];
+            auto & res = results[e];
+            std::ostringstream out;
 
-            alpha[n].clear();
-            coeff[n].clear();
+            try {
+                const size_t nint = nintegrals(ent);
+                integrals.resize(nint);
 
-            alpha_arb[n] = _arb_vec_init(g.nprim);
-            coeff_arb[n] = _arb_vec_init(g.nprim*g.ngeneral);
-
-            am[n] = g.am;
-            nprim[n] = g.nprim;
-            ngeneral[n] = g.ngeneral;
-
-            for(int i = 0; i < 3; i++)
-            {
-                xyz[n][i] = std::strtod(ent.g[n].xyz[i].c_str(), nullptr);
-                arb_set_d(xyz_arb[n] + i, xyz[n][i]);
-            }
-
-            for(int i = 0; i < g.nprim; i++)
-            {
-                alpha[n].push_back(std::strtod(g.alpha[i].c_str(), nullptr));
-                arb_set_d(alpha_arb[n]+i, alpha[n][i]);
-            }
-
-            for(int i = 0; i < g.nprim*g.ngeneral; i++)
-            {
-                coeff[n].push_back(std::strtod(g.coeff[i].c_str(), nullptr));
-                arb_set_d(coeff_arb[n]+i, coeff[n][i]);
-            }
-        }
+                arb_ptr integrals_arb = _arb_vec_init(nint);
 
-        callback_helper<N>::call_exact(integrals.data(), am, xyz, nprim, ngeneral, alpha, coeff, cb);
+                std::array<arb_ptr, N> alpha_arb, coeff_arb;
 
-        /* Compute using very high precision */
-        callback_helper<N>::call(integrals_arb, am, xyz_arb, nprim, ngeneral, alpha_arb, coeff_arb, 512, cb_arb);
+                for(int n = 0; n < N; n++)
+                {
+                    const auto & g = ent.g[n];
+
+                    alpha[n].clear();
+                    coeff[n].clear();
+
+                    alpha_arb[n] = _arb_vec_init(g.nprim);
+                    coeff_arb[n] = _arb_vec_init(g.nprim*g.ngeneral);
+
+                    am[n] = g.am;
+                    nprim[n] = g.nprim;
+                    ngeneral[n] = g.ngeneral;
+
+                    for(int i = 0; i < 3; i++)
+                    {
+                        xyz[n][i] = std::strtod(ent.g[n].xyz[i].c_str(), nullptr);
+                        arb_set_d(xyz_arb[n] + i, xyz[n][i]);
+                    }
+
+                    for(int i = 0; i < g.nprim; i++)
+                    {
+                        alpha[n].push_back(std::strtod(g.alpha[i].c_str(), nullptr));
+                        arb_set_d(alpha_arb[n]+i, alpha[n][i]);
+                    }
+
+                    for(int i = 0; i < g.nprim*g.ngeneral; i++)
+                    {
+                        coeff[n].push_back(std::strtod(g.coeff[i].c_str(), nullptr));
+                        arb_set_d(coeff_arb[n]+i, coeff[n][i]);
+                    }
+                }
 
+                callback_helper<N>::call_exact(integrals.data(), am, xyz, nprim, ngeneral, alpha, coeff, cb);
 
-        for(int n = 0; n < N; n++)
-        {
-            const auto & g = ent.g[n];
-            _arb_vec_clear(alpha_arb[n], g.nprim);
-            _arb_vec_clear(coeff_arb[n], g.nprim*g.ngeneral);
-        }
+                /* Compute using very high precision */
+                callback_helper<N>::call(integrals_arb, am, xyz_arb, nprim, ngeneral, alpha_arb, coeff_arb, 512, cb_arb);
 
-        slong acc_bits = mirp_min_accuracy_bits(integrals_arb, nint);
 
-        if(acc_bits > 0 && acc_bits < 64)
-            throw std::logic_error("Not enough bits in testing exact integral function. Contact the developer");
+                for(int n = 0; n < N; n++)
+                {
+                    const auto & g = ent.g[n];
+                    _arb_vec_clear(alpha_arb[n], g.nprim);
+                    _arb_vec_clear(coeff_arb[n], g.nprim*g.ngeneral);
+                }
 
-        bool failed_shell = false;
-        for(size_t i = 0; i < nint; i++)
-        {
-            double vref_dbl = std::strtod(ent.integrals[i].c_str(), nullptr);
-            double vref2_dbl = arf_get_d(arb_midref(integrals_arb+i), ARF_RND_NEAR);
+                slong acc_bits = mirp_min_accuracy_bits(integrals_arb, nint);
 
-            PRAGMA_WARNING_PUSH
-            PRAGMA_WARNING_IGNORE_FP_EQUALITY
+                if(acc_bits > 0 && acc_bits < 64)
+                    throw std::logic_error("Not enough bits in testing exact integral function. Contact the developer");
 
-            if(integrals[i] != vref_dbl && integrals[i] != vref2_dbl)
-            {
-                std::cout << "Entry failed test:\n";
-                for(int j = 0; j < N; j++)
+                bool failed_shell = false;
+                for(size_t i = 0; i < nint; i++)
                 {
-                    std::cout << ent.g[j].am << " "
-                              << ent.g[j].xyz[0] << " "
-                              << ent.g[j].xyz[1] << " "
-                              << ent.g[j].xyz[2] << "\n";
+                    double vref_dbl = std::strtod(ent.integrals[i].c_str(), nullptr);
+                    double vref2_dbl = arf_get_d(arb_midref(integrals_arb+i), ARF_RND_NEAR);
+
+                    PRAGMA_WARNING_PUSH
+                    PRAGMA_WARNING_IGNORE_FP_EQUALITY
+
+                    if(integrals[i] != vref_dbl && integrals[i] != vref2_dbl)
+                    {
+                        out << "Entry failed test:\n";
+                        for(int j = 0; j < N; j++)
+                        {
+                            out << ent.g[j].am << " "
+                                << ent.g[j].xyz[0] << " "
+                                << ent.g[j].xyz[1] << " "
+                                << ent.g[j].xyz[2] << "\n";
+                        }
+
+                        auto old_out_prec = out.precision(17);
+                        out << "     Calculated: " << integrals[i] << "\n";
+                        out << "      Reference: " << vref2_dbl << "\n";
+                        out << " File Reference: " << vref_dbl << "\n\n";
+                        out.precision(old_out_prec);
+                        failed_shell = true;
+                    }
+
+                    PRAGMA_WARNING_POP
                 }
 
-                auto old_cout_prec = std::cout.precision(17);
-                std::cout << "     Calculated: " << integrals[i] << "\n";
-                std::cout << "      Reference: " << vref2_dbl << "\n";
-                std::cout << " File Reference: " << vref_dbl << "\n\n";
-                std::cout.precision(old_cout_prec);
-                failed_shell = true;
+                _arb_vec_clear(integrals_arb, nint);
+
+                if(failed_shell)
+                    res.nfailed = 1;
+            }
+            catch(std::exception & ex)
+            {
+                res.error = ex.what();
             }
 
-            PRAGMA_WARNING_POP
+            res.output = out.str();
         }
 
-        _arb_vec_clear(integrals_arb, nint);
-
-        if(failed_shell)
-            nfailed++;
+        for(auto & it : xyz_arb)
+            _arb_vec_clear(it, 3);
     }
 
-    print_results(nfailed, data.entries.size());
+    const long nfailed = print_entry_results(results);
 
-    for(auto & it : xyz_arb)
-        _arb_vec_clear(it, 3);
+    print_results(nfailed, data.entries.size());
 
     return nfailed;
 }
@@ -299,17 +390,18 @@ integral_create_test<4>(const std::string &,
                         const std::string &,
                         slong, long,
                         const std::string &,
-                        callback_helper<4>::cb_str_type);
+                        callback_helper<4>::cb_str_type,
+                        callback_helper<4>::cb_target_type, int);
 
 template long
 integral_verify_test<4>(const std::string &, slong,
-    callback_helper<4>::cb_str_type);
+    callback_helper<4>::cb_str_type, int);
 
 
 template long
 integral_verify_test_exact<4>(const std::string &,
     callback_helper<4>::cb_exact_type,
-    callback_helper<4>::cb_type);
+    callback_helper<4>::cb_type, int);
 
 } // close namespace mirp
 
@@ -30,25 +30,34 @@ namespace mirp {
  * \tparam N Number of centers the integral needs
  * \param [in] input_filepath  The input file to use for integral parameters
  * \param [in] output_filepath The output file to write the computed integrals to
- * \param [in] working_prec    Internal working precision to use
+ * \param [in] working_prec    Internal working precision to use. If zero,
+ *                             the working precision is chosen separately for
+ *                             each entry (with \p cb_target)
  * \param [in] ndigits         Number of digits to print
  * \param [in] header          Header information to add to the file
  *                             (appended to the input file header)
  * \param [in] cb              Function that computes single cartesian integrals
+ * \param [in] cb_target       Function that computes single cartesian integrals
+ *                             to a number of digits
+ * \param [in] nthreads        Number of threads to compute entries with
+ *                             (if OpenMP is enabled)
  */
 template<int N>
 void integral_single_create_test(const std::string & input_filepath,
                                  const std::string & output_filepath,
                                  slong working_prec, long ndigits,
                                  const std::string & header,
-                                 typename callback_helper<N>::cb_single_str_type cb);
+                                 typename callback_helper<N>::cb_single_str_type cb,
+                                 typename callback_helper<N>::cb_single_target_type cb_target,
+                                 int nthreads);
 
 
 extern template void
 integral_single_create_test<4>(
         const std::string &, const std::string &,
         slong, long, const std::string &,
-        callback_helper<4>::cb_single_str_type);
+        callback_helper<4>::cb_single_str_type,
+        callback_helper<4>::cb_single_target_type, int);
 
 
 /*! \brief Runs a test of single cartesian integrals using interval math
@@ -60,17 +69,19 @@ integral_single_create_test<4>(
  * \param [in] filepath     Path to the file with the reference data
  * \param [in] working_prec Internal working precision to use
  * \param [in] cb           Function that computes single cartesian integrals
+ * \param [in] nthreads     Number of threads to test entries with (if OpenMP is enabled)
  * \return Number of failed tests
  */
 template<int N>
 long integral_single_verify_test(const std::string & filepath,
                                  slong working_prec,
-                                 typename callback_helper<N>::cb_single_str_type cb);
+                                 typename callback_helper<N>::cb_single_str_type cb,
+                                 int nthreads);
 
 extern template long
 integral_single_verify_test<4>(
         const std::string &, slong,
-        callback_helper<4>::cb_single_str_type);
+        callback_helper<4>::cb_single_str_type, int);
 
 
 /*! \brief Test single cartesian integrals in exact double precision
@@ -84,18 +95,20 @@ integral_single_verify_test<4>(
  *                       in exact double precision
  * \param [in] cb_arb     Function that computes single cartesian integrals
  *                       using interval arithmetic
+ * \param [in] nthreads  Number of threads to test entries with (if OpenMP is enabled)
  * \return Number of failed tests
  */
 template<int N>
 long integral_single_verify_test_exact(const std::string & filepath,
                                        typename callback_helper<N>::cb_single_exact_type cb,
-                                       typename callback_helper<N>::cb_single_type cb_arb);
+                                       typename callback_helper<N>::cb_single_type cb_arb,
+                                       int nthreads);
 
 extern template long
 integral_single_verify_test_exact<4>(
         const std::string &,
         callback_helper<4>::cb_single_exact_type,
-        callback_helper<4>::cb_single_type);
+        callback_helper<4>::cb_single_type, int);
 
 
 /************************************************
@@ -115,25 +128,34 @@ integral_single_verify_test_exact<4>(
  * \tparam N Number of centers the integral needs
  * \param [in] input_filepath  The input file to use for integral parameters
  * \param [in] output_filepath The output file to write the computed integrals to
- * \param [in] working_prec    Internal working precision to use
+ * \param [in] working_prec    Internal working precision to use. If zero,
+ *                             the working precision is chosen separately for
+ *                             each entry (with \p cb_target)
  * \param [in] ndigits         Number of digits to print
  * \param [in] header          Header information to add to the file
  *                             (appended to the input file header)
  * \param [in] cb              Function that computes contracted integrals
+ * \param [in] cb_target       Function that computes contracted integrals
+ *                             to a number of digits
+ * \param [in] nthreads        Number of threads to compute entries with
+ *                             (if OpenMP is enabled)
  */
 template<int N>
 void integral_create_test(const std::string & input_filepath,
                           const std::string & output_filepath,
                           slong working_prec, long ndigits,
                           const std::string & header,
-                          typename callback_helper<N>::cb_str_type cb);
+                          typename callback_helper<N>::cb_str_type cb,
+                          typename callback_helper<N>::cb_target_type cb_target,
+                          int nthreads);
 
 extern template void
 integral_create_test<4>(const std::string &,
                         const std::string &,
                         slong, long,
                         const std::string &,
-                        callback_helper<4>::cb_str_type);
+                        callback_helper<4>::cb_str_type,
+                        callback_helper<4>::cb_target_type, int);
 
 /*! \brief Runs a test of single cartesian integrals
  *
@@ -144,16 +166,18 @@ integral_create_test<4>(const std::string &,
  * \param [in] filepath     Path to the file with the reference data
  * \param [in] working_prec Internal working precision to use
  * \param [in] cb           Function that computes contracted integrals
+ * \param [in] nthreads     Number of threads to test entries with (if OpenMP is enabled)
  * \return Number of failed tests
  */
 template<int N>
 long integral_verify_test(const std::string & filepath,
                           slong working_prec,
-                          typename callback_helper<N>::cb_str_type cb);
+                          typename callback_helper<N>::cb_str_type cb,
+                          int nthreads);
 
 extern template long
 integral_verify_test<4>(const std::string &, slong,
-    callback_helper<4>::cb_str_type);
+    callback_helper<4>::cb_str_type, int);
 
 
 /*! \brief Test contracted integrals in exact double precision
@@ -167,17 +191,19 @@ integral_verify_test<4>(const std::string &, slong,
  *                       in exact double precision
  * \param [in] cb_arb     Function that computes contracted integrals
  *                       using interval arithmetic
+ * \param [in] nthreads  Number of threads to test entries with (if OpenMP is enabled)
  * \return Number of failed tests
  */
 template<int N>
 long integral_verify_test_exact(const std::string & filepath,
                                 typename callback_helper<N>::cb_exact_type cb,
-                                typename callback_helper<N>::cb_type cb_arb);
+                                typename callback_helper<N>::cb_type cb_arb,
+                                int nthreads);
 
 extern template long
 integral_verify_test_exact<4>(const std::string &,
                               callback_helper<4>::cb_exact_type,
-                              callback_helper<4>::cb_type);
+                              callback_helper<4>::cb_type, int);
 
 
 } // close namespace mirp
@@ -9,6 +9,10 @@
 
 set -eu
 
+# Number of threads for mirp_create_test (requires OpenMP).
+# This does not change the created files
+NTHREADS=${NTHREADS:-1}
+
 ##################
 # Boys function
 ##################
@@ -21,7 +25,7 @@ generator/generate_boys_random.py \
            --infile boys_large_random.inp \
            --outfile boys_large_random.dat \
            --integral boys \
-           --prec 2048 --ndigits 101
+           --prec 2048 --ndigits 101 --threads ${NTHREADS}
 
 generator/generate_boys_range.py \
            --filename boys_large_range.inp \
@@ -31,7 +35,7 @@ generator/generate_boys_range.py \
            --infile boys_large_range.inp \
            --outfile boys_large_range.dat \
            --integral boys \
-           --prec 2048 --ndigits 101
+           --prec 2048 --ndigits 101 --threads ${NTHREADS}
 
 
 #############################
@@ -70,25 +74,25 @@ generator/generate_integral_frombasis.py \
            --infile 4center_single_random_1.inp \
            --outfile gtoeri_single_random_1.dat \
            --integral gtoeri_single \
-           --prec 2048 --ndigits 101
+           --prec 2048 --ndigits 101 --threads ${NTHREADS}
 
 ../build/mirp_bin/mirp_create_test \
            --infile 4center_single_water_sto-3g.inp \
            --outfile gtoeri_single_water_sto-3g.dat \
            --integral gtoeri_single \
-           --prec 2048 --ndigits 101
+           --prec 2048 --ndigits 101 --threads ${NTHREADS}
 
 ../build/mirp_bin/mirp_create_test \
            --infile 4center_random_1.inp \
            --outfile gtoeri_random_1.dat \
            --integral gtoeri \
-           --prec 2048 --ndigits 101
+           --prec 2048 --ndigits 101 --threads ${NTHREADS}
 
 ../build/mirp_bin/mirp_create_test \
            --infile 4center_water_sto-3g.inp \
            --outfile gtoeri_water_sto-3g.dat \
            --integral gtoeri \
-           --prec 2048 --ndigits 101
+           --prec 2048 --ndigits 101 --threads ${NTHREADS}
 
 ../build/mirp_bin/mirp_create_reference \
            --integral gtoeri \